@@ -0,0 +1,149 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim
+//////////////////////////////////////////////////////////////////
+// -*- C++ -*-
+/** @file BlockingAccumulator.h
+ * @brief Define blocking_accumulator for the online reblocking of block averages
+ *
+ * H. Flyvbjerg and H. G. Petersen, J. Chem. Phys. 91, 461 (1989).
+ */
+#ifndef QMCPLUSPLUS_BLOCKING_ACCUMULATOR_H
+#define QMCPLUSPLUS_BLOCKING_ACCUMULATOR_H
+
+#include <vector>
+#include <cmath>
+
+/** accumulator of a time series at the block sizes 1,2,4,...
+ *
+ * Level l keeps the sums of the averages of 2^l consecutive samples and the
+ * sample waiting for its partner, so that n samples need O(log n) memory. The
+ * error of the mean at the level l assumes that its blocks are independent:
+ * it grows with l and levels off once the blocks are longer than the
+ * correlation time.
+ */
+template<typename T>
+struct blocking_accumulator
+{
+  typedef T value_type;
+
+  ///minimum number of blocks of a level used by error()
+  enum {MIN_BLOCKS=16};
+
+  ///sum of the values at each level
+  std::vector<T> Sum;
+  ///sum of the squared values at each level
+  std::vector<T> Sum2;
+  ///number of the values at each level
+  std::vector<long> Count;
+  ///value waiting for its partner at each level
+  std::vector<T> Pending;
+
+  /** add a sample */
+  inline void operator()(value_type x)
+  {
+    for(int l=0;; ++l)
+    {
+      if(l==Sum.size())
+      {
+        Sum.push_back(T());
+        Sum2.push_back(T());
+        Count.push_back(0);
+        Pending.push_back(T());
+      }
+      Sum[l]+=x;
+      Sum2[l]+=x*x;
+      //odd count: x waits for the next value of the level
+      if((++Count[l])&1)
+      {
+        Pending[l]=x;
+        return;
+      }
+      x=0.5*(Pending[l]+x);
+    }
+  }
+
+  ///return the number of levels
+  inline int levels() const
+  {
+    return Sum.size();
+  }
+
+  ///return the number of samples
+  inline long count() const
+  {
+    return Count.empty()?0:Count[0];
+  }
+
+  ///return the mean
+  inline value_type mean() const
+  {
+    return count()?Sum[0]/static_cast<T>(Count[0]):T();
+  }
+
+  /** return the error of the mean with the blocks of the level l
+   */
+  inline value_type error(int l) const
+  {
+    if(l>=Sum.size() || Count[l]<2)
+      return T();
+    T norm=1.0/static_cast<T>(Count[l]);
+    T avg=Sum[l]*norm;
+    T var=Sum2[l]*norm-avg*avg;
+    return (var>0.0)?std::sqrt(var/static_cast<T>(Count[l]-1)):T();
+  }
+
+  /** return the level of the error of the mean
+   *
+   * The smallest block size B=2^l with B^3 > 2n(err(l)/err(0))^4, the
+   * criterion of Lee, Towler and Needs, PRE 83, 066706 (2011), among the
+   * levels with at least MIN_BLOCKS blocks. The largest of them if none does.
+   */
+  inline int optimalLevel() const
+  {
+    T err0=error(0);
+    if(err0<=0.0)
+      return 0;
+    T n2=2.0*static_cast<T>(count());
+    int l=0;
+    while(l+1<Sum.size() && Count[l+1]>=MIN_BLOCKS)
+    {
+      T r=error(l)/err0;
+      T b=static_cast<T>(1L<<l);
+      if(b*b*b>n2*r*r*r*r)
+        return l;
+      ++l;
+    }
+    return l;
+  }
+
+  ///return the error of the mean
+  inline value_type error() const
+  {
+    return error(optimalLevel());
+  }
+
+  /** return the integrated autocorrelation time in the units of the samples
+   *
+   * 0.5 for uncorrelated samples.
+   */
+  inline value_type tau() const
+  {
+    T err0=error(0);
+    if(err0>0.0)
+    {
+      T r=error()/err0;
+      return 0.5*r*r;
+    }
+    return 0.5;
+  }
+
+  inline void clear()
+  {
+    Sum.clear();
+    Sum2.clear();
+    Count.clear();
+    Pending.clear();
+  }
+};
+
+#endif
@@ -26,10 +26,12 @@
 #include "Estimators/CollectablesEstimator.h"
 #include "QMCDrivers/SimpleFixedNodeBranch.h"
 #include "Utilities/IteratorUtility.h"
+#include "Utilities/NewTimer.h"
 #include "Numerics/HDFNumericAttrib.h"
 #include "OhmmsData/HDFStringAttrib.h"
 #include "HDFVersion.h"
 #include "OhmmsData/AttributeSet.h"
+#include <mpi/collectives.h>
 //#define QMC_ASYNC_COLLECT
 //leave it for serialization debug
 //#define DEBUG_ESTIMATOR_ARCHIVE
@@ -43,7 +45,10 @@ enum {COLLECT=0,
       MANAGE,
       RECORD,
       POSTIRECV,
-      APPEND
+      APPEND,
+      TIMERS,
+      PARALLELIO,
+      REBLOCK
      };
 
 //initialize the name of the primary estimator
@@ -51,7 +56,9 @@ EstimatorManager::EstimatorManager(Communicate* c)
   : RecordCount(0),h_file(-1), FieldWidth(20)
   , MainEstimatorName("LocalEnergy"), Archive(0), DebugArchive(0)
   , myComm(0), MainEstimator(0), Collectables(0)
-  , max4ascii(8), pendingRequests(0)
+  , max4ascii(8), pendingRequests(0), NumAggregators(1), FlushPeriod(0)
+  , ReblockArchive(0), TargetName("LocalEnergy"), TargetIndex(-1), TargetError(0.0)
+  , TargetMinBlocks(64), TargetReached(0), TargetStop(false)
 {
   setCommunicator(c);
 }
@@ -61,9 +68,14 @@ EstimatorManager::EstimatorManager(EstimatorManager& em)
   , MainEstimatorName(em.MainEstimatorName), Options(em.Options), Archive(0), DebugArchive(0)
   , myComm(0), MainEstimator(0), Collectables(0)
   , EstimatorMap(em.EstimatorMap), max4ascii(em.max4ascii), pendingRequests(0)
+  , NumAggregators(em.NumAggregators), FlushPeriod(em.FlushPeriod)
+  , ReblockArchive(0), TargetName(em.TargetName), TargetIndex(-1), TargetError(em.TargetError)
+  , TargetMinBlocks(em.TargetMinBlocks), TargetReached(0), TargetStop(em.TargetStop)
 {
   //inherit communicator
   setCommunicator(em.myComm);
+  //the timers are global: only the main manager writes them
+  Options.set(TIMERS,false);
   for(int i=0; i<em.Estimators.size(); i++)
     Estimators.push_back(em.Estimators[i]->clone());
   MainEstimator=Estimators[EstimatorMap[MainEstimatorName]];
@@ -78,6 +90,8 @@ EstimatorManager::~EstimatorManager()
   delete_iter(h5desc.begin(), h5desc.end());
   if(Collectables)
     delete Collectables;
+  if(ReblockArchive)
+    delete ReblockArchive;
 }
 
 void EstimatorManager::setCommunicator(Communicate* c)
@@ -169,6 +183,25 @@ void EstimatorManager::start(int blocks, bool record)
   AverageCache.resize(BlockAverages.size()+nc);
   SquaredAverageCache.resize(BlockAverages.size()+nc);
   PropertyCache.resize(BlockProperties.size());
+  //reblock only if requested by <estimator name="reblock"/>
+  Reblocks.resize(Options[REBLOCK]? AverageCache.size():0);
+  for(int i=0; i<Reblocks.size(); ++i)
+    Reblocks[i].clear();
+  TargetReached=0;
+  TargetIndex=-1;
+  for(int i=0; i<BlockAverages.size(); ++i)
+    if(BlockAverages.Names[i]==TargetName)
+      TargetIndex=i;
+  if(TargetError>0.0)
+  {
+    if(TargetIndex<0)
+      app_warning() << "  Unknown observable " << TargetName << " for the target error bar. Disable the early stop." << endl;
+    else if(!TargetStop)
+      app_warning() << "  This driver does not stop at a target error bar. Disable the early stop." << endl;
+    else
+      app_log() << "  The run stops once the error bar of " << TargetName << " <= " << TargetError
+                << " after " << TargetMinBlocks << " blocks" << endl;
+  }
   //count the buffer size for message
   BufferSize=2*AverageCache.size()+PropertyCache.size();
 #if defined(QMC_ASYNC_COLLECT)
@@ -194,6 +227,32 @@ void EstimatorManager::start(int blocks, bool record)
 #endif
   //set Options[RECORD] to enable/disable output
   Options.set(RECORD,record&&Options[MANAGE]);
+  H5Owner.clear();
+#if defined(H5_HAVE_PARALLEL) && defined(ENABLE_PHDF5)
+  //every task opens stat.h5 to write it in parallel
+  bool parallel_io=record && Options[PARALLELIO] && Options[COLLECT];
+  if(parallel_io && !Options[RECORD])
+  {
+    if(h5desc.size())
+    {
+      delete_iter(h5desc.begin(),h5desc.end());
+      h5desc.clear();
+    }
+    string fname=myComm->getName()+".stat.h5";
+    hid_t fapl=H5Pcreate(H5P_FILE_ACCESS);
+    H5Pset_fapl_mpio(fapl,myComm->getMPI(),MPI_INFO_NULL);
+    h_file= H5Fcreate(fname.c_str(),H5F_ACC_TRUNC,H5P_DEFAULT,fapl);
+    H5Pclose(fapl);
+    for(int i=0; i<Estimators.size(); i++)
+      Estimators[i]->registerObservables(h5desc,h_file);
+    if(Collectables)
+      Collectables->registerObservables(h5desc,h_file);
+    assignAggregators();
+  }
+#else
+  //stat.h5 is written by the root only
+  const bool parallel_io=false;
+#endif
   if(Options[RECORD])
   {
     if(Archive)
@@ -202,17 +261,45 @@ void EstimatorManager::start(int blocks, bool record)
     fname.append(".scalar.dat");
     Archive = new ofstream(fname.c_str());
     addHeader(*Archive);
+    if(Options[REBLOCK])
+    {
+      if(ReblockArchive)
+        delete ReblockArchive;
+      fname=myComm->getName()+".reblock.dat";
+      ReblockArchive = new ofstream(fname.c_str());
+      ReblockArchive->setf(ios::scientific, ios::floatfield);
+      ReblockArchive->precision(10);
+      *ReblockArchive << "#   index    ";
+      int maxobjs=std::min(BlockAverages.size(),max4ascii);
+      for(int i=0; i<maxobjs; i++)
+        *ReblockArchive << setw(FieldWidth) << BlockAverages.Names[i]
+                        << setw(FieldWidth) << BlockAverages.Names[i]+"_err"
+                        << setw(FieldWidth) << BlockAverages.Names[i]+"_tau";
+      *ReblockArchive << endl;
+    }
     if(h5desc.size())
     {
       delete_iter(h5desc.begin(),h5desc.end());
       h5desc.clear();
     }
     fname=myComm->getName()+".stat.h5";
-    h_file= H5Fcreate(fname.c_str(),H5F_ACC_TRUNC,H5P_DEFAULT,H5P_DEFAULT);
+#if defined(H5_HAVE_PARALLEL) && defined(ENABLE_PHDF5)
+    if(parallel_io)
+    {
+      hid_t fapl=H5Pcreate(H5P_FILE_ACCESS);
+      H5Pset_fapl_mpio(fapl,myComm->getMPI(),MPI_INFO_NULL);
+      h_file= H5Fcreate(fname.c_str(),H5F_ACC_TRUNC,H5P_DEFAULT,fapl);
+      H5Pclose(fapl);
+    }
+    else
+#endif
+      h_file= H5Fcreate(fname.c_str(),H5F_ACC_TRUNC,H5P_DEFAULT,H5P_DEFAULT);
     for(int i=0; i<Estimators.size(); i++)
       Estimators[i]->registerObservables(h5desc,h_file);
     if(Collectables)
       Collectables->registerObservables(h5desc,h_file);
+    if(parallel_io)
+      assignAggregators();
 #if defined(QMC_ASYNC_COLLECT)
     if(Options[COLLECT])
     {
@@ -226,6 +313,37 @@ void EstimatorManager::start(int blocks, bool record)
     }
 #endif
   }
+  //all the nodes take part in the reduction of the timers
+  //the timers are not written to stat.h5 opened by all the tasks
+  if(Options[TIMERS])
+    TimerManager.open_block_output((Options[RECORD] && H5Owner.empty())? h_file:-1,myComm);
+}
+
+/** assign the observables of stat.h5 to the aggregators
+ *
+ * The scalars stay with the root. The collectables, e.g. sk, gofr and density,
+ * are distributed over NumAggregators tasks evenly spread over the communicator,
+ * from the largest to the smallest, to the aggregator with the least data.
+ */
+void EstimatorManager::assignAggregators()
+{
+  const int nscalars=BlockAverages.size();
+  const int na=std::max(1,std::min(NumAggregators,myComm->size()));
+  H5Owner.assign(h5desc.size(),0);
+  vector<std::pair<hsize_t,int> > bysize;
+  for(int o=0; o<h5desc.size(); ++o)
+    if(h5desc[o]->lower_bound>=nscalars)
+      bysize.push_back(std::pair<hsize_t,int>(h5desc[o]->size(),o));
+  std::sort(bysize.rbegin(),bysize.rend());
+  vector<hsize_t> load(na,0);
+  for(int i=0; i<bysize.size(); ++i)
+  {
+    int a=std::min_element(load.begin(),load.end())-load.begin();
+    load[a]+=bysize[i].first;
+    H5Owner[bysize[i].second]=(a*myComm->size())/na;
+  }
+  app_log() << "  stat.h5 is written in parallel: " << bysize.size() << " collectables on "
+            << na << " aggregators" << endl;
 }
 
 void EstimatorManager::stop(const vector<EstimatorManager*> est)
@@ -266,12 +384,31 @@ void EstimatorManager::stop()
     cancel(myRequest);
     pendingRequests=0;
   }
+#if defined(H5_HAVE_PARALLEL) && defined(ENABLE_PHDF5)
+  //stat.h5 opened by all the tasks is closed collectively
+  if(H5Owner.size())
+  {
+    if(h_file>=0)
+      H5Fclose(h_file);
+    h_file=-1;
+    H5Owner.clear();
+  }
+#endif
+  if(Options[TIMERS])
+    TimerManager.close_block_output();
+  if(Options[REBLOCK] && Reblocks.size() && Reblocks[0].count())
+    reportReblocked(app_log());
   //close any open files
   if(Archive)
   {
     delete Archive;
     Archive=0;
   }
+  if(ReblockArchive)
+  {
+    delete ReblockArchive;
+    ReblockArchive=0;
+  }
 }
 
 void EstimatorManager::startBlock(int steps)
@@ -326,6 +463,11 @@ void EstimatorManager::stopBlock(const vector<EstimatorManager*>& est)
 
 void EstimatorManager::collectBlockAverages(int num_threads)
 {
+#if defined(H5_HAVE_PARALLEL) && defined(ENABLE_PHDF5)
+  if(Options[COLLECT] && H5Owner.size())
+    collectAggregated();
+  else
+#endif
   if(Options[COLLECT])
   {
     //copy cached data to RemoteData[0]
@@ -368,6 +510,12 @@ void EstimatorManager::collectBlockAverages(int num_threads)
   //add the block average to summarize
   energyAccumulator(AverageCache[0]);
   varAccumulator(SquaredAverageCache[0]-AverageCache[0]*AverageCache[0]);
+  if(Options[MANAGE] && Options[REBLOCK])
+    reblock();
+  if(TargetStop && TargetError>0.0 && Options[COLLECT])
+    myComm->bcast(TargetReached);
+  if(Options[TIMERS])
+    TimerManager.write_block(myComm);
   if(Archive)
   {
     *Archive << setw(10) << RecordCount;
@@ -377,13 +525,125 @@ void EstimatorManager::collectBlockAverages(int num_threads)
     for(int j=0; j<PropertyCache.size(); j++)
       *Archive << setw(FieldWidth) << PropertyCache[j];
     *Archive << endl;
+    if(H5Owner.empty())
+    {
+      for(int o=0; o<h5desc.size(); ++o)
+        h5desc[o]->write(AverageCache.data(),SquaredAverageCache.data());
+      H5Fflush(h_file,H5F_SCOPE_LOCAL);
+    }
+  }
+#if defined(H5_HAVE_PARALLEL) && defined(ENABLE_PHDF5)
+  if(H5Owner.size())
+  {
+    //collective and synchronous: the datasets are extended by all and written by the owners,
+    //flushed at the end or every FlushPeriod blocks
     for(int o=0; o<h5desc.size(); ++o)
-      h5desc[o]->write(AverageCache.data(),SquaredAverageCache.data());
-    H5Fflush(h_file,H5F_SCOPE_LOCAL);
+      h5desc[o]->write(AverageCache.data(),SquaredAverageCache.data(),H5Owner[o]==myComm->rank());
+    if(FlushPeriod>0 && (RecordCount+1)%FlushPeriod == 0)
+      H5Fflush(h_file,H5F_SCOPE_GLOBAL);
   }
+#endif
   RecordCount++;
 }
 
+/** reduce the block averages for the parallel output of stat.h5
+ *
+ * The scalars and the properties are reduced to the root as in collectBlockAverages.
+ * Each collectable is reduced to its aggregator H5Owner[o] only.
+ */
+void EstimatorManager::collectAggregated()
+{
+  const int nscalars=BlockAverages.size();
+  const int n1=nscalars;
+  const int n2=n1+nscalars;
+  const int n3=n2+PropertyCache.size();
+  const RealType nth=1.0/static_cast<RealType>(myComm->size());
+  BufferType& sbuffer(*RemoteData[0]);
+  sbuffer.resize(n3);
+  std::copy(AverageCache.begin(),AverageCache.begin()+nscalars,sbuffer.begin());
+  std::copy(SquaredAverageCache.begin(),SquaredAverageCache.begin()+nscalars,sbuffer.begin()+n1);
+  std::copy(PropertyCache.begin(),PropertyCache.end(),sbuffer.begin()+n2);
+  myComm->reduce(sbuffer);
+  if(Options[MANAGE])
+  {
+    for(int i=0; i<nscalars; ++i)
+    {
+      AverageCache[i]=sbuffer[i]*nth;
+      SquaredAverageCache[i]=sbuffer[n1+i]*nth;
+    }
+    //do not weight weightInd
+    PropertyCache[0]=sbuffer[n2];
+    for(int i=1; i<PropertyCache.size(); i++)
+      PropertyCache[i]=sbuffer[n2+i]*nth;
+  }
+  BufferType& cbuffer(*RemoteData[1]);
+  for(int o=0; o<h5desc.size(); ++o)
+  {
+    if(h5desc[o]->lower_bound<nscalars)
+      continue;
+    const int first=h5desc[o]->lower_bound;
+    const int n=h5desc[o]->size();
+    sbuffer.resize(2*n);
+    cbuffer.resize(2*n);
+    std::copy(AverageCache.begin()+first,AverageCache.begin()+first+n,sbuffer.begin());
+    std::copy(SquaredAverageCache.begin()+first,SquaredAverageCache.begin()+first+n,sbuffer.begin()+n);
+    mpi::reduce(*myComm,sbuffer,cbuffer,H5Owner[o]);
+    if(myComm->rank()==H5Owner[o])
+      for(int i=0; i<n; ++i)
+      {
+        AverageCache[first+i]=cbuffer[i]*nth;
+        SquaredAverageCache[first+i]=cbuffer[n+i]*nth;
+      }
+  }
+  sbuffer.resize(BufferSize);
+  cbuffer.resize(BufferSize);
+}
+
+/** add the block averages to the reblocking accumulators
+ *
+ * The collectables reduced to the aggregators are not reblocked by the root.
+ * Write the running means, error bars and autocorrelation times to the
+ * reblock.dat and check the target error bar.
+ */
+void EstimatorManager::reblock()
+{
+  int n=H5Owner.empty()? AverageCache.size():BlockAverages.size();
+  for(int i=0; i<n; ++i)
+    Reblocks[i](AverageCache[i]);
+  if(ReblockArchive)
+  {
+    *ReblockArchive << setw(10) << RecordCount;
+    int maxobjs=std::min(BlockAverages.size(),max4ascii);
+    for(int j=0; j<maxobjs; j++)
+      *ReblockArchive << setw(FieldWidth) << Reblocks[j].mean()
+                      << setw(FieldWidth) << Reblocks[j].error()
+                      << setw(FieldWidth) << Reblocks[j].tau();
+    *ReblockArchive << endl;
+  }
+  if(TargetStop && TargetError>0.0 && TargetIndex>=0 && !TargetReached
+      && Reblocks[TargetIndex].count()>=TargetMinBlocks
+      && Reblocks[TargetIndex].error()<=TargetError)
+  {
+    TargetReached=1;
+    app_log() << "  Target error bar is reached after " << Reblocks[TargetIndex].count()
+              << " blocks: " << TargetName << " = " << Reblocks[TargetIndex].mean()
+              << " +/- " << Reblocks[TargetIndex].error() << endl;
+  }
+}
+
+void EstimatorManager::reportReblocked(ostream& o)
+{
+  int maxobjs=std::min(BlockAverages.size(),max4ascii);
+  o << "  Reblocked averages of " << Reblocks[0].count() << " blocks" << endl;
+  o << "  " << setw(FieldWidth) << "name" << setw(FieldWidth) << "mean"
+    << setw(FieldWidth) << "error" << setw(FieldWidth) << "tau" << endl;
+  for(int i=0; i<maxobjs; ++i)
+    o << "  " << setw(FieldWidth) << BlockAverages.Names[i]
+      << setw(FieldWidth) << Reblocks[i].mean()
+      << setw(FieldWidth) << Reblocks[i].error()
+      << setw(FieldWidth) << Reblocks[i].tau() << endl;
+}
+
 /** accumulate Local energies and collectables
  * @param W ensemble
  */
@@ -485,14 +745,45 @@ bool EstimatorManager::put(MCWalkerConfiguration& W, QMCHamiltonian& H, xmlNodeP
         if (est_name=="RMC")
         {
           int nobs(20);
+          string beads("no");
           OhmmsAttributeSet hAttrib;
           hAttrib.add(nobs, "nobs");
+          hAttrib.add(beads, "beads");
           hAttrib.put(cur);
           max4ascii=nobs*H.sizeOfObservables()+3;
-          add(new RMCLocalEnergyEstimator(H,nobs),MainEstimatorName);
+          add(new RMCLocalEnergyEstimator(H,nobs,beads=="yes"),MainEstimatorName);
         }
         else
-          extra.push_back(est_name);
+          if (est_name=="timers")
+          {
+            app_log() << "  Writing the timer increments of each block to stat.h5 " << endl;
+            Options.set(TIMERS,true);
+          }
+          else if (est_name=="reblock")
+          {
+            OhmmsAttributeSet rAttrib;
+            rAttrib.add(TargetName, "target");
+            rAttrib.add(TargetError, "error");
+            rAttrib.add(TargetMinBlocks, "min_blocks");
+            rAttrib.put(cur);
+            app_log() << "  Writing the reblocked averages of each block to reblock.dat " << endl;
+            Options.set(REBLOCK,true);
+          }
+          else if (est_name=="parallel_hdf5")
+          {
+            OhmmsAttributeSet pAttrib;
+            pAttrib.add(NumAggregators, "aggregators");
+            pAttrib.add(FlushPeriod, "flush");
+            pAttrib.put(cur);
+#if defined(H5_HAVE_PARALLEL) && defined(ENABLE_PHDF5)
+            app_log() << "  Writing stat.h5 with parallel hdf5 and " << NumAggregators << " aggregators" << endl;
+            Options.set(PARALLELIO,true);
+#else
+            app_warning() << "  parallel_hdf5 requires ENABLE_PHDF5. stat.h5 is written by the rank 0." << endl;
+#endif
+          }
+          else
+            extra.push_back(est_name);
     }
     cur = cur->next;
   }
@@ -25,6 +25,7 @@
 #include "Utilities/PooledData.h"
 #include "Message/Communicate.h"
 #include "Estimators/ScalarEstimatorBase.h"
+#include "Estimators/BlockingAccumulator.h"
 #include "OhmmsPETE/OhmmsVector.h"
 #include "OhmmsData/HDFAttribIO.h"
 #include <bitset>
@@ -225,6 +226,24 @@ public:
 
   void getCurrentStatistics(MCWalkerConfiguration& W, RealType& eavg, RealType& var);
 
+  /** return true if the error bar of the target observable is reached
+   *
+   * Identical on all the tasks. Drivers stop the run at the end of the block.
+   */
+  inline bool targetReached() const
+  {
+    return TargetReached;
+  }
+
+  /** set if the driver stops at targetReached()
+   *
+   * Reset by QMCDriver::process. A target error bar is ignored by the other drivers.
+   */
+  inline void setTargetStop(bool stop)
+  {
+    TargetStop=stop;
+  }
+
   template<class CT>
   void write(CT& anything, bool doappend)
   {
@@ -300,14 +319,44 @@ private:
   int max4ascii;
   ///number of requests
   int pendingRequests;
+  ///number of the tasks which reduce and write the collectables with parallel hdf5
+  int NumAggregators;
+  ///period in blocks to flush stat.h5 with parallel hdf5, no flush before the end if <=0
+  int FlushPeriod;
+  ///rank which reduces and writes h5desc[i], empty unless stat.h5 is written in parallel
+  vector<int> H5Owner;
+  ///reblocking of the block averages, by the rank 0
+  vector<blocking_accumulator<RealType> > Reblocks;
+  ///file handler to write the reblocked averages
+  ofstream* ReblockArchive;
+  ///name of the observable to stop a run
+  string TargetName;
+  ///index of TargetName in AverageCache
+  int TargetIndex;
+  ///error bar of TargetName to stop a run, no early stop if <=0
+  RealType TargetError;
+  ///minimum number of blocks before a run is stopped
+  int TargetMinBlocks;
+  ///1 once the error bar of TargetName is below TargetError
+  int TargetReached;
+  ///true if the driver stops at targetReached()
+  bool TargetStop;
   //Data for communication
   vector<BufferType*> RemoteData;
   //storage for MPI_Request
   vector<Communicate::request> myRequest;
   ///collect data and write
   void collectBlockAverages(int num_threads);
+  ///assign the observables of stat.h5 to the aggregators
+  void assignAggregators();
+  ///reduce the scalars to the root and the collectables to their aggregators
+  void collectAggregated();
   ///add header to an ostream
   void addHeader(ostream& o);
+  ///add the block averages to Reblocks and check the target error bar
+  void reblock();
+  ///write the reblocked averages, error bars and autocorrelation times
+  void reportReblocked(ostream& o);
   size_t FieldWidth;
 };
 }
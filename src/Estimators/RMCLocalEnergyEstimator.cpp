@@ -19,13 +19,14 @@
 namespace qmcplusplus
 {
 
-RMCLocalEnergyEstimator::RMCLocalEnergyEstimator(QMCHamiltonian& h, int nobs)
-  :refH(h), NObs(nobs)
+RMCLocalEnergyEstimator::RMCLocalEnergyEstimator(QMCHamiltonian& h, int nobs, bool beads)
+  :refH(h), NObs(nobs), BeadEnergy(beads)
 {
   SizeOfHamiltonians = h.sizeOfObservables();
   FirstHamiltonian = h.startIndex();
-  scalars.resize(2*SizeOfHamiltonians+4);
-  scalars_saved.resize(2*SizeOfHamiltonians+4);
+  int n=2*SizeOfHamiltonians+4+(BeadEnergy?1:0);
+  scalars.resize(n);
+  scalars_saved.resize(n);
 }
 
 ScalarEstimatorBase* RMCLocalEnergyEstimator::clone()
@@ -57,6 +58,8 @@ void RMCLocalEnergyEstimator::add2Record(RecordListType& record)
     // app_log()<<"Registering observable "<<ss.str()<<endl;
     record.add(ss.str());
   }
+  if(BeadEnergy)
+    record.add("LocalEnergy_beads");
   LastIndex=record.size();
   clear();
 }
@@ -34,14 +34,18 @@ class RMCLocalEnergyEstimator: public ScalarEstimatorBase
   int FirstHamiltonian;
   int SizeOfHamiltonians;
   int NObs;
+  ///if true, add the LocalEnergy_beads column
+  bool BeadEnergy;
   const QMCHamiltonian& refH;
 
 public:
 
   /** constructor
    * @param h QMCHamiltonian to define the components
+   * @param nobs number of observables
+   * @param beads if true, add the average local energy of the beads
    */
-  RMCLocalEnergyEstimator(QMCHamiltonian& h, int nobs=2);
+  RMCLocalEnergyEstimator(QMCHamiltonian& h, int nobs=2, bool beads=false);
 
   /** accumulation per walker
    * @param awalker current walker
@@ -93,6 +97,9 @@ public:
       const RealType* restrict cPtr = (W.reptile->getCenter()).getPropertyBase();
       scalars[target](cPtr[source],wwght);
     }
+    //average over the beads, kept by the reptile
+    if(BeadEnergy)
+      scalars[4+2*SizeOfHamiltonians](W.reptile->getBeadEnergy(),1.0);
     //     scalars[target](lPtr[source],wwght);
     //    int stride(0);
     //    int bds(last-first);
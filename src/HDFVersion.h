@@ -40,6 +40,8 @@ const char num_walkers[]="number_of_walkers";
 const char energy_history[]="energy_history";
 const char norm_history[]="norm_history";
 const char qmc_status[]="qmc_status";
+const char walker_state[]="walker_state";
+const char walker_state_layout[]="walker_state_layout";
 
 //2nd level for config_group
 const char num_blocks[]="NumOfConfigurations";
@@ -10,7 +10,7 @@ namespace qmcplusplus
 //Constructor - pass arguments to KLists' constructor
 StructFact::StructFact(ParticleSet& ref, RealType kc):
   DoUpdate(false),SuperCellEnum(SUPERCELL_BULK)
-  ,PtclRef(ref), KLists(ref.Lattice)
+  ,PtclRef(ref), KLists(ref.Lattice), TempIsValid(false), TempPtcl(-1)
 {
   //Update Rhok with new "Lattice" information.
   UpdateNewCell(kc);
@@ -74,10 +74,16 @@ void StructFact::resize()
   rhok.resize(tspecies.TotalNum,KLists.numk);
   eikr.resize(PtclRef.getTotalNum(),KLists.numk);
   eikr_temp.resize(KLists.numk);
+  delta_eikr.resize(KLists.numk);
 #endif
+  TempIsValid=false;
   //int maxdim = std::max(KLists.mmax[0],std::max(KLists.mmax[1],KLists.mmax[2]));
   int maxdim=KLists.mmax[DIM];
   C.resize(DIM,2*maxdim+1);
+  KptsSoA.resize(DIM,KLists.numk);
+  for(int ki=0; ki<KLists.numk; ++ki)
+    for(int idim=0; idim<DIM; ++idim)
+      KptsSoA(idim,ki)=KLists.kpts_cart[ki][idim];
 }
 
 //void
@@ -90,6 +96,7 @@ StructFact::UpdateAllPart()
 {
   //if(!DoUpdate) FillRhok();
   FillRhok();
+  TempIsValid=false;
 }
 
 ///** Experimental functions to support real storage for structure factor
@@ -186,15 +193,17 @@ StructFact::FillRhok()
   const int nk=KLists.numk;
   for(int i=0; i<npart; ++i)
   {
-    //defined in this file
-    simd::get_phase(nk,&(KLists.kpts_cart[0][0]), PtclRef.R[i].data(), phiV.data());
-    //get_phase simply encapsulate this
-    //PosType pos(PtclRef.R[i]);
-    //for(int ki=0; ki<KLists.numk; ki++)
-    //  phiV[ki]=dot(KLists.kpts_cart[ki],pos);
+    getPhase(PtclRef.R[i],phiV.data());
     eval_e2iphi(nk, phiV.data(), eikr_r[i], eikr_i[i]);
-    simd::add(nk,eikr_r[i],rhok_r[PtclRef.GroupID[i]]);
-    simd::add(nk,eikr_i[i],rhok_i[PtclRef.GroupID[i]]);
+    const RealType* restrict c=eikr_r[i];
+    const RealType* restrict s=eikr_i[i];
+    RealType* restrict rr=rhok_r[PtclRef.GroupID[i]];
+    RealType* restrict ri=rhok_i[PtclRef.GroupID[i]];
+    for(int ki=0; ki<nk; ++ki)
+    {
+      rr[ki]+=c[ki];
+      ri[ki]+=s[ki];
+    }
   }
   //use dgemm: vtune shows algorithmA is better
   //simd::get_phase(KLists.kpts_cart,PtclRef.R,phiM);
@@ -205,20 +214,16 @@ StructFact::FillRhok()
   //  simd::add(nk,eikr_i[i],rhok_i[PtclRef.GroupID[i]]);
 #else
   rhok=0.0;
+  const int nk=KLists.numk;
   for(int i=0; i<npart; i++)
   {
-    PosType pos(PtclRef.R[i]);
-    RealType s,c;//get sin and cos
-    ComplexType* restrict eikr_ref=eikr[i];
+    //phases over the SoA k-vectors and sincos over the whole array
+    getPhase(PtclRef.R[i],phiV.data());
+    eval_e2iphi(nk,phiV.data(),eikr[i]);
+    const ComplexType* restrict eikr_ref=eikr[i];
     ComplexType* restrict rhok_ref=rhok[PtclRef.GroupID[i]];
-    for(int ki=0; ki<KLists.numk; ki++)
-    {
-      //RealType phi(dot(KLists.kpts_cart[ki],pos));
-      //eikr_ref[ki] = ComplexType(std::cos(phi),std::sin(phi));
-      sincos(dot(KLists.kpts_cart[ki],pos),&s,&c);
-      eikr_ref[ki]=ComplexType(c,s);
+    for(int ki=0; ki<nk; ki++)
       rhok_ref[ki]+= eikr_ref[ki];
-    }
   }
 #endif
 #endif
@@ -292,26 +297,44 @@ StructFact::UpdateRhok(const PosType& rold,const PosType& rnew,int iat,int Group
 #endif
 }
 
-void StructFact::makeMove(int active, const PosType& pos)
+void StructFact::evaluateTemp()
 {
+  //nothing to evaluate without a recorded move
+  if(TempPtcl<0)
+    return;
+  getPhase(TempPos,phiV.data());
 #if defined(USE_REAL_STRUCT_FACTOR)
-  for(int ki=0; ki<KLists.numk; ki++)
-    phiV[ki]=dot(KLists.kpts_cart[ki],pos);
   eval_e2iphi(KLists.numk, phiV.data(), eikr_r_temp.data(), eikr_i_temp.data());
 #else
-  RealType s,c;//get sin and cos
+  eval_e2iphi(KLists.numk, phiV.data(), eikr_temp.data());
+  const ComplexType* restrict eikr_new=eikr_temp.data();
+  const ComplexType* restrict eikr_old=eikr[TempPtcl];
+  ComplexType* restrict d_ptr=delta_eikr.data();
   for(int ki=0; ki<KLists.numk; ++ki)
-  {
-    sincos(dot(KLists.kpts_cart[ki],pos),&s,&c);
-    eikr_temp[ki]=ComplexType(c,s);
-  }
+    d_ptr[ki]=eikr_new[ki]-eikr_old[ki];
 #endif
+  TempIsValid=true;
 }
 
 void StructFact::acceptMove(int active)
 {
+  //the move was not recorded, e.g. DoUpdate was set after makeMove: R[active] is the new position
+  if(TempPtcl != active)
+    makeMove(active,PtclRef.R[active]);
+  if(!TempIsValid)
+    evaluateTemp();
 #if defined(USE_REAL_STRUCT_FACTOR)
-  APP_ABORT("NOT DONE WITH StructFact::acceptMove");
+  RealType* restrict eikr_ptr_r=eikr_r[active];
+  RealType* restrict eikr_ptr_i=eikr_i[active];
+  RealType* restrict rhok_ptr_r=rhok_r[PtclRef.GroupID[active]];
+  RealType* restrict rhok_ptr_i=rhok_i[PtclRef.GroupID[active]];
+  for(int ki=0; ki<KLists.numk; ++ki)
+  {
+    rhok_ptr_r[ki] += (eikr_r_temp[ki]-eikr_ptr_r[ki]);
+    rhok_ptr_i[ki] += (eikr_i_temp[ki]-eikr_ptr_i[ki]);
+    eikr_ptr_r[ki]=eikr_r_temp[ki];
+    eikr_ptr_i[ki]=eikr_i_temp[ki];
+  }
 #else
   //cout << "StructFact::acceptMove " << active << endl;
   //APP_ABORT("StructFact::acceptMove should not be used yet");
@@ -322,15 +345,17 @@ void StructFact::acceptMove(int active)
   {
     //(*rho_ptr++) += (*t)-(*eikr_ptr);
     //*eikr_ptr++ = *t++;
-    rhok_ptr[ki] += (eikr_temp[ki]-eikr_ptr[ki]);
+    rhok_ptr[ki] += delta_eikr[ki];
     eikr_ptr[ki]=eikr_temp[ki];
   }
 #endif
+  TempIsValid=false;
+  TempPtcl=-1;
 }
 
 void StructFact::rejectMove(int active)
 {
-  //APP_ABORT("StructFact::rejectMove should not be used yet");
-  //do nothing
+  TempIsValid=false;
+  TempPtcl=-1;
 }
 }
@@ -53,7 +53,20 @@ public:
   Matrix<ComplexType> eikr;
   ///eikr[K] for a proposed move
   Vector<ComplexType> eikr_temp;
+  ///eikr_temp-eikr[active], the change of rhok by the proposed move
+  Vector<ComplexType> delta_eikr;
 #endif
+  /** true, if eikr_temp and delta_eikr are up to date with the proposed move
+   *
+   * makeMove only records the move. The exponentials are evaluated once by
+   * the first consumer, through getEikrTemp or getDeltaEikr, and are shared
+   * by all the k-space objects of the ParticleSet until acceptMove or rejectMove.
+   */
+  bool TempIsValid;
+  ///index of the particle of the proposed move, -1 if none
+  int TempPtcl;
+  ///position of the proposed move
+  PosType TempPos;
   /** Constructor - copy ParticleSet and init. k-shells
    * @param ref Reference particle set
    * @param kc cutoff for k
@@ -73,19 +86,38 @@ public:
    */
   void UpdateAllPart();
 
-  /** evaluate eikr_temp for eikr for the proposed move
+  /** record the proposed move, eikr_temp is evaluated on demand
    * @param active index of the moved particle
    * @param pos proposed position
    */
-  void makeMove(int active, const PosType& pos);
+  inline void makeMove(int active, const PosType& pos)
+  {
+    TempIsValid=false;
+    TempPtcl=active;
+    TempPos=pos;
+  }
+#if !defined(USE_REAL_STRUCT_FACTOR)
+  ///return eikr for the proposed move
+  inline const Vector<ComplexType>& getEikrTemp()
+  {
+    if(!TempIsValid)
+      evaluateTemp();
+    return eikr_temp;
+  }
+  ///return the change of rhok for the proposed move
+  inline const Vector<ComplexType>& getDeltaEikr()
+  {
+    if(!TempIsValid)
+      evaluateTemp();
+    return delta_eikr;
+  }
+#endif
   /** update eikr and rhok with eikr_temp
    * @param active index of the moved particle
    */
   void acceptMove(int active);
   /** discard any temporary data
    * @param active index of the moved particle
-   *
-   * Do nothing
    */
   void rejectMove(int active);
   /// Update Rhok if 1 particle moved
@@ -149,6 +181,7 @@ public:
    */
   inline void copyFromBuffer(BufferType& buf)
   {
+    TempIsValid=false;
 #if defined(USE_REAL_STRUCT_FACTOR)
     buf.get(rhok_r.first_address(),rhok_r.last_address());
     buf.get(rhok_i.first_address(),rhok_i.last_address());
@@ -163,8 +196,30 @@ public:
 private:
   ///data for recursive evaluation for a given position
   Matrix<ComplexType> C;
+  ///K-vectors in the SoA format, KptsSoA(idim,ki)=KLists.kpts_cart[ki][idim]
+  Matrix<RealType> KptsSoA;
+  /** evaluate the phases \f${\bf k}\cdot{\bf r}\f$ for all the k-vectors
+   * @param pos position
+   * @param phi phases of KLists.numk
+   */
+  inline void getPhase(const PosType& pos, RealType* restrict phi) const
+  {
+    const int nk=KLists.numk;
+    const RealType* restrict kx=KptsSoA[0];
+    for(int ki=0; ki<nk; ++ki)
+      phi[ki]=pos[0]*kx[ki];
+    for(int idim=1; idim<DIM; ++idim)
+    {
+      const RealType x=pos[idim];
+      const RealType* restrict kv=KptsSoA[idim];
+      for(int ki=0; ki<nk; ++ki)
+        phi[ki]+=x*kv[ki];
+    }
+  }
   ///Compute all rhok elements from the start
   void FillRhok();
+  ///evaluate eikr_temp and delta_eikr for the recorded move, nothing is done without one
+  void evaluateTemp();
   ///Smart update of rhok for 1-particle move. Simply supply old+new position
   void UpdateRhok(const PosType& rold,
                   const PosType& rnew,int iat,int GroupID);
@@ -567,6 +567,13 @@ Communicate::bcast(int* restrict x, int n)
   MPI_Bcast(x,n,MPI_INT,0,myMPI);
 }
 
+template<>
+inline void
+Communicate::bcast(short* restrict x, int n)
+{
+  MPI_Bcast(x,n,MPI_SHORT,0,myMPI);
+}
+
 template<>
 inline void
 Communicate::bcast(char* restrict x, int n)
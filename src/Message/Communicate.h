@@ -82,6 +82,16 @@ public:
    */
   Communicate(const Communicate& comm, const std::vector<int>& jobs);
 
+  /** constructor
+   * @param comm a communicator which will be split into groups
+   * @param color group id, the tasks with the same color belong to the same group
+   * @param key order of the task within its group
+   *
+   * Unlike the other constructors, the groups need not be contiguous in comm,
+   * e.g. the tasks of a shared-memory node.
+   */
+  Communicate(const Communicate& comm, int color, int key);
+
   /**destructor
    * Call proper finalization of Communication library
    */
@@ -148,6 +158,10 @@ public:
   {
     d_ncontexts = n;
   }
+  inline void setGroupID(int i)
+  {
+    d_groupid = i;
+  }
 
   void barrier();
 
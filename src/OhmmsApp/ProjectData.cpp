@@ -17,6 +17,7 @@
 #include "OhmmsApp/ProjectData.h"
 #include "Message/Communicate.h"
 #include "Platforms/sysutil.h"
+#include "qmc_common.h"
 
 namespace qmcplusplus
 {
@@ -115,20 +116,35 @@ void ProjectData::rewind()
   reset();
 }
 
+/** return the title of the files of this rank
+ *
+ * With CI shards, the replicas of the other shard indices write the same
+ * data as the first one; their files are named title.ciNNN.
+ */
+string ProjectData::replicaTitle() const
+{
+  if(qmc_common.ci_shard_rank==0)
+    return m_title;
+  char ci[16];
+  sprintf(ci,".ci%03d",qmc_common.ci_shard_rank);
+  return m_title+ci;
+}
+
 /**\fn void ProjectData::reset()
  *\brief Construct the root name with m_title and m_series.
  */
 void ProjectData::reset()
 {
-  int nproc_g = OHMMS::Controller->size();
+  int nproc_g = OHMMS::Controller->size()/qmc_common.ci_shards;
   int nproc = myComm->size();
   int nodeid = myComm->rank();
   int groupid=myComm->getGroupID();
+  string title(replicaTitle());
   char fileroot[256], nextroot[256];
   if(nproc_g == nproc)
-    sprintf(fileroot,"%s.s%03d",m_title.c_str(),m_series);
+    sprintf(fileroot,"%s.s%03d",title.c_str(),m_series);
   else
-    sprintf(fileroot,"%s.g%03d.s%03d",m_title.c_str(),groupid,m_series);
+    sprintf(fileroot,"%s.g%03d.s%03d",title.c_str(),groupid,m_series);
   m_projectmain=fileroot;
   //set the communicator name
   myComm->setName(fileroot);
@@ -158,9 +174,9 @@ void ProjectData::reset()
       sprintf(nextroot,".g%03d.s%03d", groupid,m_series+1);
     }
   }
-  m_projectroot = m_title;
+  m_projectroot = title;
   m_projectroot.append(fileroot);
-  m_nextroot = m_title;
+  m_nextroot = title;
   m_nextroot.append(nextroot);
   std::stringstream s;
   s << m_series+1;
@@ -174,7 +190,7 @@ bool ProjectData::PreviousRoot(string& oldroot) const
   if(m_series)
   {
     char fileroot[128];
-    int nproc_g = OHMMS::Controller->size();
+    int nproc_g = OHMMS::Controller->size()/qmc_common.ci_shards;
     int nproc = myComm->size();
     int nodeid = myComm->rank();
     int groupid=myComm->getGroupID();
@@ -192,7 +208,7 @@ bool ProjectData::PreviousRoot(string& oldroot) const
       else
         sprintf(fileroot,".g%03d.s%03d",groupid,m_series-1);
     }
-    oldroot = m_title;
+    oldroot = replicaTitle();
     oldroot.append(fileroot);
     return true;
   }
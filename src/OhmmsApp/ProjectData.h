@@ -83,6 +83,9 @@ struct ProjectData: public OhmmsElementBase
    */
   bool PreviousRoot(string& oldroot) const;
 
+  ///title of the files of this rank, see reset()
+  string replicaTitle() const;
+
   ///title of the project
   string m_title;
 
@@ -25,6 +25,7 @@
 #include <HDFVersion.h>
 #include <io/hdf_archive.h>
 #include <mpi/collectives.h>
+#include <qmc_common.h>
 
 namespace APPNAMESPACE
 {
@@ -71,8 +72,9 @@ void RandomNumberControl::reset()
 /// reset the generator
 void RandomNumberControl::make_seeds()
 {
-  int pid = OHMMS::Controller->rank();
-  int nprocs = OHMMS::Controller->size();
+  //the ranks of a CI shard group share the streams
+  int pid = OHMMS::Controller->rank()/qmc_common.ci_shards;
+  int nprocs = OHMMS::Controller->size()/qmc_common.ci_shards;
   uint_type iseed=static_cast<uint_type>(std::time(0))%1024;
   mpi::bcast(*OHMMS::Controller,iseed);
   //OHMMS::Controller->bcast(iseed);//broadcast the seed
@@ -93,8 +95,8 @@ void RandomNumberControl::make_children()
     Children.push_back(new RandomGenerator_t);
     n--;
   }
-  int rank=OHMMS::Controller->rank();
-  int nprocs=OHMMS::Controller->size();
+  int rank=OHMMS::Controller->rank()/qmc_common.ci_shards;
+  int nprocs=OHMMS::Controller->size()/qmc_common.ci_shards;
   int baseoffset=Offset+nprocs+nthreads*rank;
   vector<uint_type> myprimes;
   PrimeNumbers.get(baseoffset,nthreads,myprimes);
@@ -102,6 +104,9 @@ void RandomNumberControl::make_children()
   {
     int offset=baseoffset+ip;
     Children[ip]->init(rank,nprocs,myprimes[ip],offset);
+#if defined(QMC_RNG_PHILOX)
+    Children[ip]->setStreamSeed(Offset);
+#endif
   }
   if(nprocs<4)
   {
@@ -189,8 +194,8 @@ bool RandomNumberControl::put(xmlNodePtr cur)
     int pid = 0;
     if(init_mpi)
     {
-      pid = OHMMS::Controller->rank();
-      nprocs = OHMMS::Controller->size();
+      pid = OHMMS::Controller->rank()/qmc_common.ci_shards;
+      nprocs = OHMMS::Controller->size()/qmc_common.ci_shards;
     }
     if(offset_in<0)
     {
@@ -281,9 +286,22 @@ void RandomNumberControl::read(const string& fname, Communicate* comm)
 }
 
 void RandomNumberControl::write(const string& fname, Communicate* comm)
+{
+  vector<uint_type> vt_tot;
+  gather(vt_tot,comm);
+  string h5name(fname);
+  if(fname.find("config.h5")>= fname.size())
+    h5name.append(".config.h5");
+  hdf_archive hout(comm);
+  hout.open(h5name,H5F_ACC_RDWR);
+  write(hout,vt_tot);
+  hout.close();
+}
+
+void RandomNumberControl::gather(vector<uint_type>& vt_tot, Communicate* comm)
 {
   int nthreads=omp_get_max_threads();
-  vector<uint_type> vt, vt_tot;
+  vector<uint_type> vt;
   vt.reserve(nthreads*1024);
   if(nthreads>1)
     for(int ip=0; ip<nthreads; ++ip)
@@ -301,17 +319,17 @@ void RandomNumberControl::write(const string& fname, Communicate* comm)
   }
   else
     vt_tot=vt;
-  string h5name(fname);
-  if(fname.find("config.h5")>= fname.size())
-    h5name.append(".config.h5");
-  hdf_archive hout(comm);
-  hout.open(h5name,H5F_ACC_RDWR);
+}
+
+void RandomNumberControl::write(hdf_archive& hout, vector<uint_type>& vt_tot)
+{
   hout.push(hdf::main_state);
   hout.push("random");
-  TinyVector<hsize_t,2> shape(comm->size()*nthreads,Random.state_size());
+  TinyVector<hsize_t,2> shape(vt_tot.size()/Random.state_size(),Random.state_size());
   hyperslab_proxy<vector<uint_type>,2> slab(vt_tot,shape);
   hout.write(slab,Random.EngineName);
-  hout.close();
+  hout.pop();
+  hout.pop();
 }
 }
 /***************************************************************************
@@ -27,6 +27,8 @@ class Communicate;
 namespace APPNAMESPACE
 {
 
+struct hdf_archive;
+
 /**class RandomNumberControl
  *\brief Encapsulate data to initialize and save the status of the random number generator
  *
@@ -68,6 +70,16 @@ public:
    * @param comm communicator so that everyone writes its own data
    */
   static void write(const string& fname, Communicate* comm);
+  /** collect the random states of all the tasks on the rank 0
+   * @param vt_tot random states, one row per stream
+   * @param comm communicator
+   */
+  static void gather(vector<uint_type>& vt_tot, Communicate* comm);
+  /** write the collected random states to the main_state group of an open file
+   * @param hout file
+   * @param vt_tot random states by gather
+   */
+  static void write(hdf_archive& hout, vector<uint_type>& vt_tot);
 
 private:
 
@@ -38,25 +38,26 @@ public:
   typedef const T*     const_pointer;
   typedef C            Container_t;
   typedef typename C::size_type size_type;
-  typedef typename Container_t::iterator iterator;
+  typedef pointer       iterator;
+  typedef const_pointer const_iterator;
   typedef Matrix<T,C>  This_t;
 
-  Matrix():D1(0),D2(0) { } // Default Constructor initializes to zero.
+  Matrix():D1(0),D2(0),TotSize(0),Ptr(0) { } // Default Constructor initializes to zero.
 
-  Matrix(size_type n)
+  Matrix(size_type n):TotSize(0),Ptr(0)
   {
     resize(n,n);
     //assign(*this, T());
   }
 
-  Matrix(size_type n, size_type m)
+  Matrix(size_type n, size_type m):TotSize(0),Ptr(0)
   {
     resize(n,m);
     //assign(*this, T());
   }
 
-  // Copy Constructor
-  Matrix(const Matrix<T,C> &rhs)
+  // Copy Constructor: the elements are always copied to its own storage
+  Matrix(const Matrix<T,C> &rhs):TotSize(0),Ptr(0)
   {
     copy(rhs);
   }
@@ -66,7 +67,7 @@ public:
 
   inline size_type size() const
   {
-    return X.size();
+    return TotSize;
   }
   inline size_type rows() const
   {
@@ -98,44 +99,83 @@ public:
 //   inline const T* end() const { return X.end();}
 //   inline T* end()   { return X.end();}
 
-  inline typename Container_t::iterator begin()
+  inline iterator begin()
   {
-    return X.begin();
+    return Ptr;
   }
-  inline typename Container_t::iterator end()
+  inline iterator end()
   {
-    return X.end();
+    return Ptr+TotSize;
   }
-  inline typename Container_t::const_iterator begin() const
+  inline const_iterator begin() const
   {
-    return X.begin();
+    return Ptr;
   }
-  inline typename Container_t::const_iterator end() const
+  inline const_iterator end() const
   {
-    return X.end();
+    return Ptr+TotSize;
   }
 
-  inline typename Container_t::iterator begin(int i)
+  inline iterator begin(int i)
   {
-    return X.begin()+i*D2;
+    return Ptr+i*D2;
   }
-  inline typename Container_t::const_iterator begin(int i) const
+  inline const_iterator begin(int i) const
   {
-    return X.begin()+i*D2;
+    return Ptr+i*D2;
   }
 
+  /** resize the matrix
+   *
+   * A matrix attached to a reference stays attached if the size is unchanged.
+   * Otherwise, it is detached and uses its own storage.
+   */
   inline void resize(size_type n, size_type m)
   {
+    if(isReference() && n*m == TotSize)
+    {
+      D1 = n;
+      D2 = m;
+      return;
+    }
     D1 = n;
     D2 = m;
     TotSize=n*m;
     X.resize(n*m);
+    Ptr = TotSize? &(X[0]): 0;
   }
 
   inline void add(size_type n)   // you can add rows: adding columns are forbidden
   {
+    if(isReference())
+      X.assign(Ptr,Ptr+TotSize);
     X.insert(X.end(), n*D2, T());
     D1 += n;
+    TotSize=D1*D2;
+    Ptr = &(X[0]);
+  }
+
+  /** use the memory [ref,ref+size()) for the elements
+   * @param ref address of the external storage
+   *
+   * The dimensions are not changed and the storage is neither copied nor owned.
+   * The matrix is attached to ref until detachReference or resize to another size.
+   */
+  inline void attachReference(pointer ref)
+  {
+    Ptr = ref;
+  }
+
+  ///use its own storage again, the elements are not copied
+  inline void detachReference()
+  {
+    Ptr = X.empty()? 0: &(X[0]);
+  }
+
+  ///return true, if the elements are in an external storage
+  inline bool isReference() const
+  {
+    return Ptr != (X.empty()? 0: &(X[0]));
   }
 
   inline void copy(const Matrix<T,C>& rhs)
@@ -166,70 +206,70 @@ public:
   // returns a pointer of i-th row
   inline pointer data()
   {
-    return &(X[0]);
+    return Ptr;
   }
 
   // returns a pointer of i-th row
   inline const_pointer data() const
   {
-    return &(X[0]);
+    return Ptr;
   }
 
   inline pointer first_address()
   {
-    return &(X[0]);
+    return Ptr;
   }
 
   // returns a pointer of i-th row
   inline const_pointer first_address() const
   {
-    return &(X[0]);
+    return Ptr;
   }
 
   inline pointer last_address()
   {
-    return &(X[0])+TotSize;
+    return Ptr+TotSize;
   }
 
   // returns a pointer of i-th row
   inline const Type_t* last_address() const
   {
-    return &(X[0])+TotSize;
+    return Ptr+TotSize;
   }
 
 
   // returns a const pointer of i-th row
   inline const Type_t* operator[](size_type i) const
   {
-    return &(X[0]) + i*D2;
+    return Ptr + i*D2;
   }
 
   /// returns a pointer of i-th row, g++ iterator problem
   inline Type_t* operator[](size_type i)
   {
-    return &(X[0]) + i*D2;
+    return Ptr + i*D2;
   }
 
   inline Type_t& operator()(size_type i)
   {
-    return X[i];
+    return Ptr[i];
   }
   // returns the i-th value in D1*D2 vector
   inline Type_t operator()(size_type i) const
   {
-    return X[i];
+    return Ptr[i];
   }
 
   // returns val(i,j)
   inline Type_t& operator()(size_type i, size_type j)
   {
-    return X[i*D2+j];
+    return Ptr[i*D2+j];
   }
 
   // returns val(i,j)
   inline Type_t operator()( size_type i, size_type j) const
   {
-    return X[i*D2+j];
+    return Ptr[i*D2+j];
   }
 
   inline void swap_rows (int r1, int r2)
@@ -256,13 +296,13 @@ public:
   template<class IT>
   inline void replaceRow(IT first, size_type i)
   {
-    std::copy(first,first+D2,X.begin()+i*D2);
+    std::copy(first,first+D2,Ptr+i*D2);
   }
 
   template<class IT>
   inline void replaceColumn(IT first,size_type j)
   {
-    typename Container_t::iterator ii(X.begin()+j);
+    pointer ii(Ptr+j);
     for(int i=0; i<D1; i++, ii+=D2)
       *ii=*first++;
   }
@@ -270,7 +310,7 @@ public:
   template<class IT>
   inline void add2Column(IT first,size_type j)
   {
-    typename Container_t::iterator ii(X.begin()+j);
+    pointer ii(Ptr+j);
     for(int i=0; i<D1; i++, ii+=D2)
       *ii+=*first++;
   }
@@ -291,7 +331,7 @@ public:
       int kk = (i0+i)*D2 + j0;
       for(int j=0; j<d2; j++)
       {
-        X[kk++] += sub[ii++];
+        Ptr[kk++] += sub[ii++];
       }
     }
   }
@@ -305,7 +345,7 @@ public:
       int kk = (i0+i)*D2 + j0;
       for(size_type j=0; j<d2; j++)
       {
-        X[kk++] += phi*sub[ii++];
+        Ptr[kk++] += phi*sub[ii++];
       }
     }
   }
@@ -318,7 +358,7 @@ public:
       int kk = (i0+i)*D2 + j0;
       for(size_type j=0; j<sub.cols(); j++)
       {
-        X[kk++] += sub(ii++);
+        Ptr[kk++] += sub(ii++);
       }
     }
   }
@@ -330,7 +370,7 @@ public:
       int kk = (i0+i)*D2 + j0;
       for(size_type j=0; j<sub.cols(); j++)
       {
-        X[kk++] += sub[ii++];
+        Ptr[kk++] += sub[ii++];
       }
     }
   }
@@ -338,14 +378,14 @@ public:
   template<class Msg>
   inline Msg& putMessage(Msg& m)
   {
-    m.Pack(&X[0],D1*D2);
+    m.Pack(Ptr,D1*D2);
     return m;
   }
 
   template<class Msg>
   inline Msg& getMessage(Msg& m)
   {
-    m.Unpack(&X[0],D1*D2);
+    m.Unpack(Ptr,D1*D2);
     return m;
   }
 
@@ -353,6 +393,8 @@ protected:
   size_type D1, D2;
   size_type TotSize;
   Container_t X;
+  ///address of the elements, either &X[0] or an attached reference
+  pointer Ptr;
 };
 
 // I/O
@@ -17,6 +17,7 @@
 #include <Particle/MCWalkerConfiguration.h>
 #include <Particle/HDFWalkerInput_0_4.h>
 #include <mpi/collectives.h>
+#include <Message/CommOperators.h>
 #include <io/hdf_archive.h>
 namespace qmcplusplus
 {
@@ -91,6 +92,118 @@ void HDFWalkerInput_0_4::checkOptions(xmlNodePtr cur)
   }
 }
 
+/** read the rows [first,first+n) of a dataset whose first index is the walker
+ * @param grp group of the dataset
+ * @param aname name of the dataset
+ * @param first first row
+ * @param n number of rows
+ * @param buffer rows, resized to n times the size of a row
+ * @param rowsize size of a row in the file
+ * @return true, if the rows are read
+ *
+ * Each task reads its own hyperslab independently of the others.
+ */
+template<typename T>
+inline bool read_walker_rows(hid_t grp, const char* aname, int first, int n, vector<T>& buffer, int& rowsize)
+{
+  rowsize=0;
+  hid_t dataset = H5Dopen(grp,aname);
+  if(dataset<0)
+    return false;
+  hid_t dataspace = H5Dget_space(dataset);
+  int rank = H5Sget_simple_extent_ndims(dataspace);
+  vector<hsize_t> gcounts(rank), counts(rank), offset(rank,0);
+  H5Sget_simple_extent_dims(dataspace,&gcounts[0],NULL);
+  rowsize=1;
+  for(int i=1; i<rank; ++i)
+    rowsize*=gcounts[i];
+  counts=gcounts;
+  counts[0]=n;
+  offset[0]=first;
+  herr_t status=-1;
+  if(n>0 && first+n<=gcounts[0])
+  {
+    buffer.resize(n*rowsize);
+    T t;
+    hid_t memspace = H5Screate_simple(rank,&counts[0],NULL);
+    status = H5Sselect_hyperslab(dataspace,H5S_SELECT_SET,&offset[0],NULL,&counts[0],NULL);
+    status = H5Dread(dataset,get_h5_datatype(t),memspace,dataspace,H5P_DEFAULT,&buffer[0]);
+    H5Sclose(memspace);
+  }
+  H5Sclose(dataspace);
+  H5Dclose(dataset);
+  return status>=0;
+}
+
+/** read the walker positions of this task from an open file
+ * @param hin file
+ * @param h5name name of the file for the messages
+ * @param first first row of this task
+ * @param nw_loc number of the rows of this task
+ * @param nw_in number of the walkers in the file
+ * @param posin positions of the walkers of this task
+ * @return true, if the rows are read
+ */
+bool HDFWalkerInput_0_4::read_rows(hdf_archive& hin, const string& h5name,
+                                   int& first, int& nw_loc, int& nw_in, vector<QMCTraits::RealType>& posin)
+{
+  //check if hdf and xml versions can work together
+  HDFVersion aversion;
+  hin.read(aversion,hdf::version);
+  if(aversion < i_info.version)
+  {
+    app_error() << " Mismatched version. xml = " << i_info.version << " hdf = " << aversion << endl;
+    return false;
+  }
+  if(!hin.is_group(hdf::main_state))
+    return false;
+  hin.push(hdf::main_state,false);
+  nw_in=0;
+  hin.read(nw_in,hdf::num_walkers);
+  if(nw_in==0)
+  {
+    app_error() << "  HDFWalkerInput_0_4::put empty walkers " << endl;
+    return false;
+  }
+  //rows of this task
+  first=0;
+  nw_loc=nw_in;
+  if(i_info.collected && myComm->size()>1)
+  {
+    if(nw_in<myComm->size())
+    {
+      first=myComm->rank()%nw_in;
+      nw_loc=1;
+    }
+    else
+    {
+      vector<int> woffsets(myComm->size()+1,0);
+      FairDivideLow(nw_in,myComm->size(),woffsets);
+      first=woffsets[myComm->rank()];
+      nw_loc=woffsets[myComm->rank()+1]-first;
+    }
+  }
+  const int nitems=targetW.getTotalNum()*OHMMS_DIM;
+  int rowsize=0;
+  if(!read_walker_rows(hin.top(),hdf::walkers,first,nw_loc,posin,rowsize) || rowsize != nitems)
+  {
+    app_error() << "  HDFWalkerInput_0_4::put failed to read the walkers of " << h5name << endl;
+    return false;
+  }
+  return true;
+}
+
+/** read walkers
+ *
+ * The walkers of a collected file are mapped onto the current tasks independently
+ * of the layout which wrote the file: each task reads a fair share of the stored
+ * walkers, or a copy of one of them when there are fewer walkers than tasks.
+ * A file of a task, e.g. name.p001.config.h5, is read as a whole.
+ *
+ * A file is used only if every task reads its walkers, otherwise all the tasks
+ * skip it and move to the next file of the stack together.
+ * @return true, if the walkers of a file are read
+ */
 bool HDFWalkerInput_0_4::put(xmlNodePtr cur)
 {
   checkOptions(cur);
@@ -99,63 +212,36 @@ bool HDFWalkerInput_0_4::put(xmlNodePtr cur)
     app_error() << "  No valid input hdf5 is found." << endl;
     return false;
   }
-  //use collective I/O  for parallel runs with a file
-  //i_info.parallel = ((myComm->size()>1) && i_info.collected);
+  bool found=false;
   while(FileStack.size())
   {
     FileName=FileStack.top();
     FileStack.pop();
     string h5name(FileName);
     h5name.append(hdf::config_ext);
-    hdf_archive hin(myComm,true);
-    int success=hin.open(h5name,H5F_ACC_RDONLY);
-    mpi::bcast(*myComm,success);
-    if(!success)
+    //every task opens the file to read its own walkers
+    hdf_archive hin(myComm,false);
+    typedef vector<QMCTraits::RealType>  Buffer_t;
+    Buffer_t posin;
+    int first=0, nw_loc=0, nw_in=0;
+    int failed=0;
+    if(!hin.open(h5name,H5F_ACC_RDONLY))
     {
       app_error() << "  HDFWalkerInput_0_4::put Cannot open " << h5name << endl;
-      continue;
+      failed=1;
     }
-    //check if hdf and xml versions can work together
-    HDFVersion aversion;
-#if defined(H5_HAVE_PARALLEL) && defined(ENABLE_PHDF5)
-    hin.read(aversion,hdf::version);
-    int found_group=hin.is_group(hdf::main_state);
-    if(!found_group)
+    else if(!read_rows(hin,h5name,first,nw_loc,nw_in,posin))
+      failed=1;
+    //the tasks use the file or skip it together
+    myComm->allreduce(failed);
+    if(failed)
+    {
+      app_error() << "  HDFWalkerInput_0_4::put " << failed << " tasks cannot read " << h5name
+                  << ". The file is skipped by all the tasks." << endl;
       continue;
-    //start main_state
-    hin.push(hdf::main_state);
-    int nw_in=0;
-    hin.read(nw_in,hdf::num_walkers);
-    vector<int> woffsets(myComm->size()+1,0);
-    FairDivideLow(nw_in,myComm->size(),woffsets);
-    int mynode=myComm->rank();
-    int nw_loc=woffsets[mynode+1]-woffsets[mynode];
-    cout << "node =" << mynode << " nw_loc=" << nw_loc << " nw_in=" << nw_in << endl;
-    //TinyVector<hsize_t,3> gcounts, counts, offset;
-    hsize_t gcounts[3], counts[3], offset[3];
-    gcounts[0]=nw_in;
-    gcounts[1]=targetW.getTotalNum();
-    gcounts[2]=OHMMS_DIM;
-    counts[0]=nw_loc;
-    counts[1]=targetW.getTotalNum();
-    counts[2]=OHMMS_DIM;
-    offset[0]=woffsets[mynode];
-    offset[1]=0;
-    offset[2]=0;
-    int nitems=targetW.getTotalNum()*OHMMS_DIM;
-    typedef vector<QMCTraits::RealType>  Buffer_t;
-    Buffer_t posin(nw_loc*nitems);
-    hid_t dataset = H5Dopen(hin.top(),hdf::walkers);
-    hid_t dataspace = H5Dget_space(dataset);
-    int rank_n = H5Sget_simple_extent_ndims(dataspace);
-    int status_n = H5Sget_simple_extent_dims(dataspace, gcounts, NULL);
-    hid_t type_id=get_h5_datatype(posin[0]);
-    hid_t memspace = H5Screate_simple(3, counts, NULL);
-    herr_t status = H5Sselect_hyperslab(dataspace,H5S_SELECT_SET, offset,NULL,counts,NULL);
-    status = H5Dread(dataset, type_id, memspace, dataspace, hin.xfer_plist, &posin[0]);
-    H5Sclose(dataspace);
-    H5Sclose(memspace);
-    H5Dclose(dataset);
+    }
+    app_log() << "  HDFWalkerInput_0_4::put getting " << nw_loc << " of " << nw_in << " walkers from " << h5name << endl;
+    const int nitems=targetW.getTotalNum()*OHMMS_DIM;
     int curWalker = targetW.getActiveWalkers();
     targetW.createWalkers(nw_loc);
     Buffer_t::iterator it(posin.begin());
@@ -164,70 +250,8 @@ bool HDFWalkerInput_0_4::put(xmlNodePtr cur)
       std::copy(it,it+nitems,get_first_address(targetW[iw]->R));
       it += nitems;
     }
-#else
-    hin.read(aversion,hdf::version);
-    mpi::bcast(*myComm,aversion.version);
-    if(aversion < i_info.version)
-    {
-      app_error() << " Mismatched version. xml = " << i_info.version << " hdf = " << aversion << endl;
-      continue;
-    }
-    int found_group=hin.is_group(hdf::main_state);
-    mpi::bcast(*myComm,found_group);
-    if(!found_group)
-      continue;
-    typedef vector<QMCTraits::RealType>  Buffer_t;
-    Buffer_t posin;
-    hin.push(hdf::main_state);
-    int nw_in=0;
-    hin.read(nw_in,hdf::num_walkers);
-    mpi::bcast(*myComm,nw_in);
-    if(nw_in==0)
-    {
-      app_error() << "  HDFWalkerInput_0_4::put empty walkers " << endl;
-      continue;
-    }
-    TinyVector<size_t,3> dims(nw_in,targetW.getTotalNum(),OHMMS_DIM);
-    if(!myComm->rank())
-    {
-      posin.resize(dims[0]*dims[1]*dims[2]);
-      hyperslab_proxy<Buffer_t,3> slab(posin,dims);
-      hin.read(slab,hdf::walkers);
-    }
-    app_log() << " HDFWalkerInput_0_4::put getting " << dims[0] << " walkers " << posin.size() << endl;
-    int nitems=targetW.getTotalNum()*OHMMS_DIM;
-    int curWalker = targetW.getActiveWalkers();
-    if(myComm->size()==1)
-    {
-      targetW.createWalkers(nw_in);
-      Buffer_t::iterator it(posin.begin());
-      for(int i=0,iw=curWalker; i<nw_in; ++i,++iw)
-      {
-        std::copy(it,it+nitems,get_first_address(targetW[iw]->R));
-        it += nitems;
-      }
-    }
-    else
-    {
-      vector<int> counts(myComm->size()),woffsets(myComm->size()+1,0);
-      FairDivideLow(nw_in,myComm->size(),woffsets);
-      //reset the number of walkers
-      nw_in=woffsets[myComm->rank()+1]-woffsets[myComm->rank()];
-      for(int i=0; i<woffsets.size(); ++i)
-        woffsets[i]*=nitems;
-      for(int i=0; i<counts.size(); ++i)
-        counts[i]=woffsets[i+1]-woffsets[i];
-      Buffer_t posout(nw_in*nitems);
-      mpi::scatterv(*myComm,posin,posout,counts,woffsets);
-      targetW.createWalkers(nw_in);
-      Buffer_t::iterator it(posout.begin());
-      for(int i=0,iw=curWalker; i<nw_in; ++i,++iw)
-      {
-        std::copy(it,it+nitems,get_first_address(targetW[iw]->R));
-        it += nitems;
-      }
-    }
-#endif
+    read_state(hin,first,nw_loc,curWalker);
+    found=true;
   }
   //char fname[128];
   //sprintf(fname,"%s.p%03d.xyz",FileName.c_str(),myComm->rank());
@@ -242,7 +266,33 @@ bool HDFWalkerInput_0_4::put(xmlNodePtr cur)
   //    fout << thisWalker.R[iat] << endl;
   //  ++it; ++iw;
   //}
-  return true;
+  return found;
+}
+
+/** read hdf::walker_state written by HDFWalkerOutput::write_state
+ *
+ * The rows are read as the walker positions. The restored walkers are marked
+ * by Walker::StateRestored and the drivers validate a subset of them.
+ */
+void HDFWalkerInput_0_4::read_state(hdf_archive& hin, int first, int nw_loc, int first_walker)
+{
+  vector<int> layout(4,0);
+  if(!hin.read(layout,hdf::walker_state_layout))
+    return;
+  vector<QMCTraits::RealType> statein;
+  int rowsize=0;
+  if(!read_walker_rows(hin.top(),hdf::walker_state,first,nw_loc,statein,rowsize) || rowsize != layout[3])
+  {
+    app_warning() << "  HDFWalkerInput_0_4::read_state cannot read " << hdf::walker_state << ". The buffers will be recomputed." << endl;
+    return;
+  }
+  const QMCTraits::RealType* restrict p=&statein[0];
+  for(int iw=first_walker; iw<first_walker+nw_loc; ++iw)
+  {
+    targetW[iw]->resizeProperty(layout[0],layout[1]);
+    p=targetW[iw]->getState(p,layout[2]);
+  }
+  app_log() << "  HDFWalkerInput_0_4::read_state restored the buffers of " << nw_loc << " walkers" << endl;
 }
 
 }
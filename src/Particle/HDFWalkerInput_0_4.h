@@ -27,6 +27,7 @@ namespace qmcplusplus
 {
 
 class MCWalkerConfiguration;
+struct hdf_archive;
 
 struct HDFWalkerInput_0_4
 {
@@ -82,6 +83,20 @@ struct HDFWalkerInput_0_4
    */
   bool put(xmlNodePtr cur);
 
+  /** restore the state of the walkers, if the file has one
+   * @param hin file whose main_state group is open
+   * @param first first row of this task in the file
+   * @param nw_loc number of the rows of this task
+   * @param first_walker index of the first walker read from the file
+   */
+  void read_state(hdf_archive& hin, int first, int nw_loc, int first_walker);
+
+  /** read the walker positions of this task from an open file
+   * @return true, if the rows of this task are read
+   */
+  bool read_rows(hdf_archive& hin, const string& h5name,
+                 int& first, int& nw_loc, int& nw_in, vector<QMCTraits::RealType>& posin);
+
   void checkOptions(xmlNodePtr cur);
 };
 
@@ -25,6 +25,7 @@
 #include <iostream>
 #include <sstream>
 #include <Message/Communicate.h>
+#include <Message/CommOperators.h>
 #include <mpi/collectives.h>
 #include <io/hdf_hyperslab.h>
 
@@ -76,10 +77,11 @@ HDFWalkerOutput::~HDFWalkerOutput()
 
 /** Write the set of walker configurations to the HDF5 file.
  * @param W set of walker configurations
+ * @param state if true, write the state records of the walkers
  *
  * Dump is for restart and do not preserve the file
  */
-bool HDFWalkerOutput::dump(MCWalkerConfiguration& W)
+bool HDFWalkerOutput::dump(MCWalkerConfiguration& W, bool state)
 {
   string FileName=myComm->getName()+hdf::config_ext;
   hdf_archive dump_file(myComm,true);
@@ -91,6 +93,8 @@ bool HDFWalkerOutput::dump(MCWalkerConfiguration& W)
   dump_file.push(hdf::main_state);
   //walkers
   write_configuration(W,dump_file);
+  if(state)
+    write_state(W,dump_file);
   dump_file.close();
   return true;
 }
@@ -168,6 +172,148 @@ void HDFWalkerOutput::write_configuration(MCWalkerConfiguration& W, hdf_archive&
   //HDFAttribIO<BufferType> po(*RemoteData[0],inds);
   //po.write(hout.top(),hdf::walkers,hout.xfer_plist);
 }
+
+/** write the state records of the walkers
+ *
+ * Each walker is a row of hdf::walker_state, see Walker::putState, in the order
+ * of hdf::walkers. hdf::walker_state_layout holds the shape of Properties, the size
+ * of DataSet and the size of a record. Nothing is written unless the buffer of
+ * every walker has the same size. The buffers are read through Walker::readBuffer:
+ * a duplicate not synced yet by a driver writes the DataSet of its source.
+ */
+void HDFWalkerOutput::write_state(MCWalkerConfiguration& W, hdf_archive& hout)
+{
+  const int nw=W.getActiveWalkers();
+  vector<int> layout;
+  if(!get_state_layout(W,layout))
+    return;
+  const int rec=layout[3];
+  RemoteData[1]->resize(rec*nw);
+  OHMMS_PRECISION* restrict p=RemoteData[1]->data();
+  for(int iw=0; iw<nw; ++iw)
+    p=W[iw]->putState(p);
+  hout.write(layout,hdf::walker_state_layout);
+#if defined(H5_HAVE_PARALLEL) && defined(ENABLE_PHDF5)
+  hsize_t gcounts[2], counts[2], offset[2];
+  gcounts[0]=W.WalkerOffsets[myComm->size()];
+  gcounts[1]=rec;
+  counts[0]=nw;
+  counts[1]=rec;
+  offset[0]=W.WalkerOffsets[myComm->rank()];
+  offset[1]=0;
+  BufferType::value_type t;
+  const hid_t etype=get_h5_datatype(t);
+  hid_t gid=hout.top();
+  hid_t sid1  = H5Screate_simple(2,gcounts,NULL);
+  hid_t memspace=H5Screate_simple(2,counts,NULL);
+  hid_t dset_id=H5Dcreate(gid,hdf::walker_state,etype,sid1,H5P_DEFAULT);
+  hid_t filespace=H5Dget_space(dset_id);
+  herr_t ret=H5Sselect_hyperslab(filespace,H5S_SELECT_SET,offset,NULL,counts,NULL);
+  ret = H5Dwrite(dset_id,etype,memspace,filespace,hout.xfer_plist,RemoteData[1]->data());
+  H5Sclose(filespace);
+  H5Sclose(memspace);
+  H5Sclose(sid1);
+  H5Dclose(dset_id);
+#else
+  gather_rows(W,*RemoteData[1],*RemoteData[0],rec);
+  //number_of_walkers is set by write_configuration
+  vector<hsize_t> inds(2);
+  inds[0]=number_of_walkers;
+  inds[1]=rec;
+  hyperslab_proxy<BufferType,2> slab(*RemoteData[0],inds);
+  hout.write(slab,hdf::walker_state);
+#endif
+}
+
+/** get the layout of the state records of the root
+ * @return false, if the walker buffers are empty or differ in size
+ *
+ * Collective.
+ */
+bool HDFWalkerOutput::get_state_layout(MCWalkerConfiguration& W, vector<int>& layout)
+{
+  const int nw=W.getActiveWalkers();
+  layout.assign(4,0);
+  if(nw)
+  {
+    layout[0]=W[0]->Properties.rows();
+    layout[1]=W[0]->Properties.cols();
+    layout[2]=W[0]->readBuffer().size();
+    layout[3]=W[0]->stateSize();
+  }
+  mpi::bcast(*myComm,layout);
+  int nbad=(layout[2]==0);
+  for(int iw=0; iw<nw; ++iw)
+    nbad += (W[iw]->readBuffer().size() != layout[2]) || (W[iw]->Properties.size() != layout[0]*layout[1]);
+  myComm->allreduce(nbad);
+  if(nbad)
+    app_warning() << "  HDFWalkerOutput skips the walker state: the walker buffers are empty or differ in size." << endl;
+  return nbad==0;
+}
+
+///gather the rows of the walkers to the root
+void HDFWalkerOutput::gather_rows(MCWalkerConfiguration& W, BufferType& local, BufferType& global, int rowsize)
+{
+  if(myComm->size()==1)
+  {
+    global=local;
+    return;
+  }
+#if defined(HAVE_MPI)
+  vector<int> displ(myComm->size()), counts(myComm->size());
+  for (int i=0; i<myComm->size(); ++i)
+  {
+    counts[i]=rowsize*(W.WalkerOffsets[i+1]-W.WalkerOffsets[i]);
+    displ[i]=rowsize*W.WalkerOffsets[i];
+  }
+  if(!myComm->rank())
+    global.resize(rowsize*W.WalkerOffsets.back());
+  mpi::gatherv(*myComm,local,global,counts,displ);
+#endif
+}
+
+void HDFWalkerOutput::collect(MCWalkerConfiguration& W, bool state)
+{
+  while(RemoteData.size()<3)
+    RemoteData.push_back(new BufferType);
+  const int nw=W.getActiveWalkers();
+  const int wb=OHMMS_DIM*number_of_particles;
+  number_of_walkers=(myComm->size()==1)? nw: W.WalkerOffsets[myComm->size()];
+  RemoteData[1]->resize(wb*nw);
+  W.putConfigurations(RemoteData[1]->begin());
+  gather_rows(W,*RemoteData[1],*RemoteData[0],wb);
+  StateLayout.clear();
+  if(state && get_state_layout(W,StateLayout))
+  {
+    RemoteData[1]->resize(StateLayout[3]*nw);
+    OHMMS_PRECISION* restrict p=RemoteData[1]->data();
+    for(int iw=0; iw<nw; ++iw)
+      p=W[iw]->putState(p);
+    gather_rows(W,*RemoteData[1],*RemoteData[2],StateLayout[3]);
+  }
+  else
+    StateLayout.clear();
+}
+
+void HDFWalkerOutput::write_collected(hdf_archive& hout)
+{
+  vector<hsize_t> inds(3);
+  inds[0]=number_of_walkers;
+  inds[1]=number_of_particles;
+  inds[2]=OHMMS_DIM;
+  hout.write(number_of_walkers,hdf::num_walkers);
+  hyperslab_proxy<BufferType,3> slab(*RemoteData[0],inds);
+  hout.write(slab,hdf::walkers);
+  if(StateLayout.size())
+  {
+    vector<hsize_t> sinds(2);
+    sinds[0]=number_of_walkers;
+    sinds[1]=StateLayout[3];
+    hout.write(StateLayout,hdf::walker_state_layout);
+    hyperslab_proxy<BufferType,2> sslab(*RemoteData[2],sinds);
+    hout.write(sslab,hdf::walker_state);
+  }
+}
 /*
 bool HDFWalkerOutput::dump(ForwardWalkingHistoryObject& FWO)
 {
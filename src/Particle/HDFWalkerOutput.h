@@ -60,8 +60,23 @@ public:
 
   /** dump configurations
    * @param w walkers
+   * @param state if true, dump the full state of the walkers
    */
-  bool dump(MCWalkerConfiguration& w);
+  bool dump(MCWalkerConfiguration& w, bool state=false);
+
+  /** collect the configurations, and the state records, of the walkers on the root
+   * @param w walkers
+   * @param state if true, collect the state records
+   *
+   * Collective. The data are kept until the next collect.
+   */
+  void collect(MCWalkerConfiguration& w, bool state);
+
+  /** write the collected walkers to the current group of hout
+   *
+   * Called by the root only, which can be done by any thread.
+   */
+  void write_collected(hdf_archive& hout);
 //     bool dump(ForwardWalkingHistoryObject& FWO);
 
 private:
@@ -70,6 +85,8 @@ private:
   typedef PooledData<OHMMS_PRECISION> BufferType;
   vector<Communicate::request> myRequest;
   vector<BufferType*> RemoteData;
+  ///layout of the collected state records, empty if none
+  vector<int> StateLayout;
 
 //     //define some types for the FW collection
 //     typedef vector<ForwardWalkingData> FWBufferType;
@@ -77,6 +94,9 @@ private:
 //     vector<vector<int> > FWCountData;
 
   void write_configuration(MCWalkerConfiguration& W, hdf_archive& hout);
+  void write_state(MCWalkerConfiguration& W, hdf_archive& hout);
+  bool get_state_layout(MCWalkerConfiguration& W, vector<int>& layout);
+  void gather_rows(MCWalkerConfiguration& W, BufferType& local, BufferType& global, int rowsize);
 };
 
 }
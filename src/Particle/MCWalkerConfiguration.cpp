@@ -85,7 +85,9 @@ struct MCSample
 MCWalkerConfiguration::MCWalkerConfiguration():
   OwnWalkers(true),ReadyForPbyP(false),UpdateMode(Update_Walker),Polymer(0),
 
-  MaxSamples(10),CurSampleCount(0),GlobalNumWalkers(0),reptile(0)
+  MaxSamples(10),CurSampleCount(0),GlobalNumWalkers(0),reptile(0),
+  DeferBufferCopy(false),NumWalkersAllocated(0),NumWalkersReused(0),
+  NumWalkersShared(0),NumWalkersRecycled(0),NumBufferCopiesSaved(0)
 #ifdef QMC_CUDA
   ,RList_GPU("MCWalkerConfiguration::RList_GPU"),
   GradList_GPU("MCWalkerConfiguration::GradList_GPU"),
@@ -103,7 +105,9 @@ MCWalkerConfiguration::MCWalkerConfiguration():
 MCWalkerConfiguration::MCWalkerConfiguration(const MCWalkerConfiguration& mcw)
   : ParticleSet(mcw), OwnWalkers(true), GlobalNumWalkers(mcw.GlobalNumWalkers),
     UpdateMode(Update_Walker), ReadyForPbyP(false), Polymer(0),
-    MaxSamples(mcw.MaxSamples), CurSampleCount(0)
+    MaxSamples(mcw.MaxSamples), CurSampleCount(0),
+    DeferBufferCopy(false), NumWalkersAllocated(0), NumWalkersReused(0),
+    NumWalkersShared(0), NumWalkersRecycled(0), NumBufferCopiesSaved(0)
 #ifdef QMC_CUDA
     ,RList_GPU("MCWalkerConfiguration::RList_GPU"),
     GradList_GPU("MCWalkerConfiguration::GradList_GPU"),
@@ -125,6 +129,7 @@ MCWalkerConfiguration::~MCWalkerConfiguration()
 {
   if(OwnWalkers)
     destroyWalkers(WalkerList.begin(), WalkerList.end());
+  clearWalkerPool();
 }
 
 
@@ -183,16 +188,7 @@ void MCWalkerConfiguration::resize(int numWalkers, int numPtcls)
   {
     int nw=-dn;
     if(nw<WalkerList.size())
-    {
-      iterator it = WalkerList.begin();
-      while(nw)
-      {
-        delete *it;
-        ++it;
-        --nw;
-      }
-      WalkerList.erase(WalkerList.begin(),WalkerList.begin()-dn);
-    }
+      destroyWalkers(WalkerList.begin(),WalkerList.begin()+nw);
   }
   //iterator it = WalkerList.begin();
   //while(it != WalkerList.end()) {
@@ -210,15 +206,144 @@ MCWalkerConfiguration::destroyWalkers(iterator first, iterator last)
 {
   if(OwnWalkers)
   {
+    syncDependents(first,last);
     iterator it = first;
     while(it != last)
     {
-      delete *it++;
+      recycleWalker(*it++);
     }
   }
   return WalkerList.erase(first,last);
 }
 
+void MCWalkerConfiguration::pop_back()
+{
+  syncDependents(WalkerList.end()-1,WalkerList.end());
+  recycleWalker(WalkerList.back());
+  WalkerList.pop_back();
+}
+
+void MCWalkerConfiguration::syncDependents(iterator first, iterator last)
+{
+  int ndeps=0;
+  for(iterator it=first; it!=last; ++it)
+    ndeps += (*it)->NumDependents;
+  //stop once all the duplicates are found
+  for(iterator it=WalkerList.begin(); ndeps && it!=WalkerList.end(); ++it)
+  {
+    if(it==first)
+      it=last;
+    if(it==WalkerList.end())
+      break;
+    if((*it)->BufferSource && std::find(first,last,(*it)->BufferSource)!=last)
+    {
+      (*it)->syncBuffer();
+      --ndeps;
+    }
+  }
+}
+
+MCWalkerConfiguration::Walker_t*
+MCWalkerConfiguration::newWalker(const Walker_t& a, bool share)
+{
+#ifdef QMC_CUDA
+  //the device data are not handled by makeCopy
+  ++NumWalkersAllocated;
+  Walker_t* awalker=new Walker_t(a);
+  awalker->syncBuffer();
+  return awalker;
+#else
+  Walker_t* awalker;
+  if(FreeWalkers.empty())
+  {
+    awalker=new Walker_t(a.size());
+    ++NumWalkersAllocated;
+  }
+  else
+  {
+    awalker=FreeWalkers.back();
+    FreeWalkers.pop_back();
+    ++NumWalkersReused;
+  }
+  awalker->makeDuplicate(a);
+  if(share)
+    ++NumWalkersShared;
+  else
+    awalker->syncBuffer();
+  return awalker;
+#endif
+}
+
+void MCWalkerConfiguration::takeFreeWalkers(int n, vector<Walker_t*>& pool)
+{
+  pool.assign(n,0);
+  int nreused=std::min(n,static_cast<int>(FreeWalkers.size()));
+  std::copy(FreeWalkers.end()-nreused,FreeWalkers.end(),pool.begin());
+  FreeWalkers.resize(FreeWalkers.size()-nreused);
+  NumWalkersReused += nreused;
+  NumWalkersAllocated += n-nreused;
+  NumWalkersShared += n;
+}
+
+void MCWalkerConfiguration::recycleWalker(Walker_t* awalker)
+{
+  if(awalker->BufferSource)
+  {
+    ++NumBufferCopiesSaved;
+    awalker->releaseSource();
+  }
+  ++NumWalkersRecycled;
+#ifdef QMC_CUDA
+  delete awalker;
+#else
+  FreeWalkers.push_back(awalker);
+#endif
+}
+
+void MCWalkerConfiguration::recycleWalkers(const vector<Walker_t*>& walkers)
+{
+  int ndeps=0;
+  for(int i=0; i<walkers.size(); ++i)
+    ndeps += walkers[i]->NumDependents;
+  for(iterator it=WalkerList.begin(); ndeps && it!=WalkerList.end(); ++it)
+  {
+    const Walker_t* source=(*it)->BufferSource;
+    if(source==0 || std::find(walkers.begin(),walkers.end(),source)==walkers.end())
+      continue;
+    //the duplicates recycled together are released by recycleWalker
+    if(std::find(walkers.begin(),walkers.end(),*it)==walkers.end())
+      (*it)->syncBuffer();
+    --ndeps;
+  }
+  for(int i=0; i<walkers.size(); ++i)
+    recycleWalker(walkers[i]);
+}
+
+void MCWalkerConfiguration::syncBuffers(iterator first, iterator last)
+{
+  for(; first!=last; ++first)
+    (*first)->syncBuffer();
+}
+
+void MCWalkerConfiguration::reportWalkerPool(int block)
+{
+  app_log() << "  WalkerPool block " << block
+            << " allocated = " << NumWalkersAllocated
+            << " reused = " << NumWalkersReused
+            << " shared = " << NumWalkersShared
+            << " recycled = " << NumWalkersRecycled
+            << " copies saved = " << NumBufferCopiesSaved
+            << " free = " << FreeWalkers.size() << endl;
+  NumWalkersAllocated=NumWalkersReused=NumWalkersShared=0;
+  NumWalkersRecycled=NumBufferCopiesSaved=0;
+}
+
+void MCWalkerConfiguration::clearWalkerPool()
+{
+  delete_iter(FreeWalkers.begin(),FreeWalkers.end());
+  FreeWalkers.clear();
+}
+
 void MCWalkerConfiguration::createWalkers(iterator first, iterator last)
 {
   destroyWalkers(WalkerList.begin(),WalkerList.end());
@@ -238,18 +363,7 @@ MCWalkerConfiguration::destroyWalkers(int nw)
     app_warning() << "  Cannot remove walkers. Current Walkers = " << WalkerList.size() << endl;
     return;
   }
-  nw=WalkerList.size()-nw;
-  int iw=nw;
-  while(iw<WalkerList.size())
-  {
-    delete WalkerList[iw++];
-  }
-  //iterator it(WalkerList.begin()+nw),it_end(WalkerList.end());
-  //while(it != it_end)
-  //{
-  //  delete *it++;
-  //}
-  WalkerList.erase(WalkerList.begin()+nw,WalkerList.end());
+  destroyWalkers(WalkerList.end()-nw,WalkerList.end());
 }
 
 void MCWalkerConfiguration::copyWalkers(iterator first, iterator last, iterator it)
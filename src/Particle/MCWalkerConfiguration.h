@@ -149,6 +149,64 @@ public:
    */
   void destroyWalkers(int nw);
 
+  /** return a copy of a walker from the free list
+   * @param a walker to be copied
+   * @param share if true, the copy shares the buffers of a, see Walker::makeDuplicate
+   */
+  Walker_t* newWalker(const Walker_t& a, bool share=false);
+
+  /** take walkers from the free list for the duplicates made by threads
+   * @param n number of walkers
+   * @param pool n walkers, 0 for those to be allocated by the caller
+   *
+   * The walkers of pool are counted as shared duplicates, see newWalker.
+   */
+  void takeFreeWalkers(int n, vector<Walker_t*>& pool);
+
+  /** return a walker to the free list
+   *
+   * The walker cannot be the source of a duplicate, see destroyWalkers.
+   */
+  void recycleWalker(Walker_t* awalker);
+
+  /** return walkers of WalkerList to the free list, keeping them in WalkerList
+   * @param walkers walkers to be recycled, e.g. those killed by branching
+   *
+   * The other walkers of WalkerList which share the buffers of a walker being
+   * recycled copy them first.
+   */
+  void recycleWalkers(const vector<Walker_t*>& walkers);
+
+  /** copy the shared buffers of the duplicates in [first,last)
+   *
+   * The sources are only read and the ranges of the threads can be synchronized
+   * concurrently, as long as no source is advanced in the meantime.
+   */
+  void syncBuffers(iterator first, iterator last);
+
+  /** set the mode of the duplicates made by branching
+   * @param defer if true, a driver calls syncBuffers before advancing the walkers
+   *
+   * Otherwise, the buffers are copied at the end of a branch.
+   */
+  inline void deferBufferCopy(bool defer)
+  {
+    DeferBufferCopy=defer;
+  }
+
+  inline bool bufferCopyDeferred() const
+  {
+    return DeferBufferCopy;
+  }
+
+  /** write the counters of the walker pool since the last report and reset them
+   * @param block index of the block
+   */
+  void reportWalkerPool(int block);
+
+  ///delete the walkers on the free list
+  void clearWalkerPool();
+
   /** copy the pointers to the Walkers to WalkerList
    * @param head pointer to the head walker
    * @param tail pointer to the tail walker
@@ -259,11 +317,7 @@ public:
    *
    * Provide std::vector::pop_back interface
    */
-  inline void pop_back()
-  {
-    delete WalkerList.back();
-    WalkerList.pop_back();
-  }
+  void pop_back();
 
   inline Walker_t* operator[](int i)
   {
@@ -375,6 +429,27 @@ protected:
 
   RealType LocalEnergy;
 
+  ///true if the buffers of the duplicates are copied by a driver
+  bool DeferBufferCopy;
+  ///number of walkers allocated by newWalker
+  int NumWalkersAllocated;
+  ///number of walkers taken from the free list
+  int NumWalkersReused;
+  ///number of duplicates sharing the buffers of their sources
+  int NumWalkersShared;
+  ///number of walkers returned to the free list
+  int NumWalkersRecycled;
+  ///number of duplicates recycled before their buffers are copied
+  int NumBufferCopiesSaved;
+  ///free list of walkers
+  WalkerList_t FreeWalkers;
+
+  /** copy the buffers of the walkers outside [first,last) sharing them with a walker in [first,last)
+   *
+   * Nothing is scanned unless a walker in [first,last) has NumDependents.
+   */
+  void syncDependents(iterator first, iterator last);
+
 public:
   ///a collection of walkers
   WalkerList_t WalkerList;
@@ -664,8 +664,9 @@ void ParticleSet::rejectMove(Index_t iat)
 {
   //restore the position by the saved activePos
   R[iat]=activePos;
-  //Do not change SK: 2007-05-18
-  //if(SK && SK->DoUpdate) SK->rejectMove(iat);
+  //invalidate the eikr of the proposed move
+  if(SK && SK->DoUpdate)
+    SK->rejectMove(iat);
 }
 
 /** resize Sphere by the LocalNum
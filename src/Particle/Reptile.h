@@ -49,6 +49,9 @@ public:
   RealType evar;
   IndexType esamp;
 
+  ///sum of the local energies of the beads
+  RealType eSum;
+
   IndexType direction, headindex, nbeads;
   MCWalkerConfiguration& w;
   Walker_t* prophead;
@@ -68,6 +71,7 @@ public:
     eest=0.0;
     evar=100000;
     esamp=0;
+    eSum=0.0;
     r2samp=0;
     r2accept=1;
     r2prop=1;
@@ -152,11 +156,42 @@ public:
     newhead=overwrite;
   }
 
+  /** return the tail as the new head
+   *
+   * The tail is removed from eSum. Once the properties of the new head are
+   * assigned, addHead() completes the O(1) update of the sum.
+   */
   inline Walker_t&  getNewHead()
   {
     //overwrite last element.
     headindex = getBeadIndex(nbeads-1);  //sets to position of tail.
-    return getWalker(headindex);
+    Walker_t& newhead(getWalker(headindex));
+    eSum -= newhead.Properties(LOCALENERGY);
+    return newhead;
+  }
+
+  ///add the head to eSum
+  inline void addHead()
+  {
+    eSum += getHead().Properties(LOCALENERGY);
+  }
+
+  /** sum the local energies over the beads
+   *
+   * O(nbeads): called when the beads are initialized and once per block
+   * to discard the roundoff of the incremental updates.
+   */
+  inline void resetSums()
+  {
+    eSum=0.0;
+    for(int i=0; i<nbeads; ++i)
+      eSum += getWalker(i).Properties(LOCALENERGY);
+  }
+
+  ///average local energy of the beads
+  inline RealType getBeadEnergy() const
+  {
+    return eSum/static_cast<RealType>(nbeads);
   }
 
   inline void printState()
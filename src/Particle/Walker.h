@@ -51,6 +51,7 @@ enum {LOGPSI=0,       /*!< log(fabs(psi)) instead of square of the many-body wav
  * RealTypehe template (G)radient(A)ttribute is a generic container of gradients types.
  * Data members for each walker
  * - ID : identity for a walker. default is 0.
+ * - StreamCount : number of the random streams started by this walker.
  * - Age : generation after a move is accepted.
  * - Weight : weight to take the ensemble averages
  * - Multiplicity : multiplicity for branching. Probably can be removed.
@@ -80,6 +81,8 @@ struct Walker
   long ID;
   ///id reserved for forward walking
   long ParentID;
+  ///number of the random streams started by this walker
+  long StreamCount;
   ///DMCgeneration
   int Generation;
   ///Age of this walker age is incremented when a walker is not moved after a sweep
@@ -95,6 +98,11 @@ struct Walker
    * When Multiplicity = 0, this walker will be destroyed.
    */
   RealType Multiplicity;
+  /** true, if DataSet, G, L and Properties are restored from a checkpoint
+   *
+   * Set by getState and cleared when a driver initializes the walker.
+   */
+  bool StateRestored;
 
   /**the configuration vector (3N-dimensional vector to store
      the positions of all the particles for a single walker)*/
@@ -120,6 +128,16 @@ struct Walker
   //analytical derivatives during linear optimization, e.g. MultiDeterminants
   Buffer_t DataSetForDerivatives;
 
+  /** walker whose buffers are shared by this duplicate
+   *
+   * Non-zero after makeDuplicate: DataSet and DataSetForDerivatives are those of
+   * BufferSource until syncBuffer is called. Read them through readBuffer.
+   */
+  const Walker* BufferSource;
+
+  ///number of duplicates sharing the buffers of this walker
+  mutable int NumDependents;
+
   /// Data for GPU-vectorized versions
 #ifdef QMC_CUDA
   static int cuda_DataSize;
@@ -164,12 +182,16 @@ struct Walker
   {
     ID=0;
     ParentID=0;
+    StreamCount=0;
     Generation=0;
     Age=0;
     Weight=1.0;
     Multiplicity=1.0;
     ReleasedNodeWeight=1.0;
     ReleasedNodeAge=0;
+    StateRestored=false;
+    BufferSource=0;
+    NumDependents=0;
     Properties.resize(1,NUMPROPERTIES);
     if(nptcl>0)
       resize(nptcl);
@@ -225,6 +247,27 @@ struct Walker
     return mean ;
   }
 
+  /** copy constructor
+   *
+   * The buffers are copied from readBuffer, so a copy of a duplicate owns them.
+   */
+  inline Walker(const Walker& a)
+#ifdef QMC_CUDA
+    :cuda_DataSet("Walker::walker_buffer"), R_GPU("Walker::R_GPU"),
+     Grad_GPU("Walker::Grad_GPU"), Lap_GPU("Walker::Lap_GPU"),
+     Rhok_GPU("Walker::Rhok_GPU")
+#endif
+  {
+    BufferSource=0;
+    NumDependents=0;
+    makeCopy(a);
+    DataSetForDerivatives=a.BufferSource? a.BufferSource->DataSetForDerivatives: a.DataSetForDerivatives;
+#ifdef QMC_CUDA
+    k_species_stride=a.k_species_stride;
+    Rhok_GPU=a.Rhok_GPU;
+#endif
+  }
+
   inline ~Walker() { }
 
   ///assignment operator
@@ -260,12 +303,14 @@ struct Walker
   {
     ID=a.ID;
     ParentID=a.ParentID;
+    StreamCount=a.StreamCount;
     Generation=a.Generation;
     Age=a.Age;
     Weight=a.Weight;
     Multiplicity=a.Multiplicity;
     ReleasedNodeWeight=a.ReleasedNodeWeight;
     ReleasedNodeAge=a.ReleasedNodeAge;
+    StateRestored=a.StateRestored;
     if (R.size()!=a.R.size())
       resize(a.R.size());
     R = a.R;
@@ -273,7 +318,8 @@ struct Walker
     L = a.L;
     //Drift = a.Drift;
     Properties.copy(a.Properties);
-    DataSet=a.DataSet;
+    DataSet=a.readBuffer();
+    releaseSource();
     if (PropertyHistory.size()!=a.PropertyHistory.size())
       PropertyHistory.resize(a.PropertyHistory.size());
     for (int i=0; i<PropertyHistory.size(); i++)
@@ -287,6 +333,74 @@ struct Walker
 #endif
   }
 
+  /** copy the content of a walker but share its buffers
+   *
+   * The buffers are copied by syncBuffer, which has to be called before the
+   * buffers of this walker are used and before the source is modified or destroyed.
+   */
+  inline void makeDuplicate(const Walker& a)
+  {
+    ID=a.ID;
+    ParentID=a.ParentID;
+    StreamCount=a.StreamCount;
+    Generation=a.Generation;
+    Age=a.Age;
+    Weight=a.Weight;
+    Multiplicity=a.Multiplicity;
+    ReleasedNodeWeight=a.ReleasedNodeWeight;
+    ReleasedNodeAge=a.ReleasedNodeAge;
+    StateRestored=a.StateRestored;
+    if (R.size()!=a.R.size())
+      resize(a.R.size());
+    R = a.R;
+    G = a.G;
+    L = a.L;
+    Properties.copy(a.Properties);
+    if (PropertyHistory.size()!=a.PropertyHistory.size())
+      PropertyHistory.resize(a.PropertyHistory.size());
+    for (int i=0; i<PropertyHistory.size(); i++)
+      PropertyHistory[i]=a.PropertyHistory[i];
+    PHindex=a.PHindex;
+#ifdef QMC_CUDA
+    cuda_DataSet = a.cuda_DataSet;
+    R_GPU = a.R_GPU;
+    Grad_GPU = a.Grad_GPU;
+    Lap_GPU = a.Lap_GPU;
+#endif
+    releaseSource();
+    BufferSource=a.BufferSource? a.BufferSource: &a;
+    #pragma omp atomic
+    BufferSource->NumDependents++;
+  }
+
+  ///stop sharing the buffers of BufferSource without copying them
+  inline void releaseSource()
+  {
+    if(BufferSource)
+    {
+      #pragma omp atomic
+      BufferSource->NumDependents--;
+      BufferSource=0;
+    }
+  }
+
+  ///copy the shared buffers of a duplicate
+  inline void syncBuffer()
+  {
+    if(BufferSource)
+    {
+      DataSet=BufferSource->DataSet;
+      DataSetForDerivatives=BufferSource->DataSetForDerivatives;
+      releaseSource();
+    }
+  }
+
+  ///return DataSet, which is the source's for a duplicate
+  inline const Buffer_t& readBuffer() const
+  {
+    return BufferSource? BufferSource->DataSet: DataSet;
+  }
+
   //return the address of the values of Hamiltonian terms
   inline RealType* restrict getPropertyBase()
   {
@@ -382,9 +496,72 @@ struct Walker
 
   inline void resizeProperty(int n, int m)
   {
+    //a restored state is only valid for the same properties
+    if(n!=Properties.rows() || m!=Properties.cols())
+      StateRestored=false;
     Properties.resize(n,m);
   }
 
+  /** size of the state record for a checkpoint
+   *
+   * Age, ReleasedNodeAge, Weight, ReleasedNodeWeight, Multiplicity, Properties, G, L and DataSet
+   */
+  inline int stateSize() const
+  {
+    return 5+Properties.size()+R.size()*(DIM+1)*sizeof(ValueType)/sizeof(RealType)+readBuffer().size();
+  }
+
+  /** copy the state record to a buffer
+   * @param p starting address of stateSize() elements
+   * @return the end of the record
+   */
+  inline RealType* putState(RealType* restrict p)
+  {
+    const int ng=R.size()*DIM*sizeof(ValueType)/sizeof(RealType);
+    const int nl=R.size()*sizeof(ValueType)/sizeof(RealType);
+    *p++=Age;
+    *p++=ReleasedNodeAge;
+    *p++=Weight;
+    *p++=ReleasedNodeWeight;
+    *p++=Multiplicity;
+    p=std::copy(Properties.begin(),Properties.end(),p);
+    const RealType* restrict g=reinterpret_cast<const RealType*>(&(G[0][0]));
+    p=std::copy(g,g+ng,p);
+    const RealType* restrict l=reinterpret_cast<const RealType*>(L.first_address());
+    p=std::copy(l,l+nl,p);
+    const Buffer_t& buf(readBuffer());
+    return std::copy(buf.begin(),buf.end(),p);
+  }
+
+  /** restore the state from a record written by putState
+   * @param p starting address of the record
+   * @param ndata size of DataSet
+   *
+   * Properties have to be resized to the shape of the record.
+   */
+  inline const RealType* getState(const RealType* restrict p, int ndata)
+  {
+    const int ng=R.size()*DIM*sizeof(ValueType)/sizeof(RealType);
+    const int nl=R.size()*sizeof(ValueType)/sizeof(RealType);
+    Age=static_cast<int>(*p++);
+    ReleasedNodeAge=static_cast<int>(*p++);
+    Weight=*p++;
+    ReleasedNodeWeight=*p++;
+    Multiplicity=*p++;
+    std::copy(p,p+Properties.size(),Properties.begin());
+    p+=Properties.size();
+    std::copy(p,p+ng,reinterpret_cast<RealType*>(&(G[0][0])));
+    p+=ng;
+    std::copy(p,p+nl,reinterpret_cast<RealType*>(L.first_address()));
+    p+=nl;
+    releaseSource();
+    DataSet.resize(ndata);
+    std::copy(p,p+ndata,DataSet.begin());
+    DataSet.rewind();
+    StateRestored=true;
+    return p+ndata;
+  }
+
 
   /** byte size for a packed message
    *
@@ -396,8 +573,8 @@ struct Walker
     for (int iat=0; iat<PropertyHistory.size(); iat++)
       numPH += PropertyHistory[iat].size();
     int bsize =
-      2*sizeof(long)+3*sizeof(int)+ PHindex.size()*sizeof(int)
-      +(Properties.size()+DataSet.size()+ numPH + 1)*sizeof(RealType)
+      3*sizeof(long)+3*sizeof(int)+ PHindex.size()*sizeof(int)
+      +(Properties.size()+readBuffer().size()+ numPH + 1)*sizeof(RealType)
       +R.size()*(DIM*sizeof(RealType)+(DIM+1)*sizeof(ValueType));//R+G+L
     //+R.size()*(DIM*2*sizeof(RealType)+(DIM+1)*sizeof(ValueType));//R+Drift+G+L
 #ifdef QMC_CUDA
@@ -415,7 +592,7 @@ struct Walker
   inline Msg& putMessage(Msg& m)
   {
     const int nat=R.size();
-    m << ID << ParentID << Generation << Age << ReleasedNodeAge << ReleasedNodeWeight;
+    m << ID << ParentID << StreamCount << Generation << Age << ReleasedNodeAge << ReleasedNodeWeight;
     m.Pack(&(R[0][0]),nat*OHMMS_DIM);
 #if defined(QMC_COMPLEX)
     m.Pack(reinterpret_cast<RealType*>(&(G[0][0])),nat*OHMMS_DIM*2);
@@ -425,7 +602,8 @@ struct Walker
     m.Pack(L.first_address(),nat);
 #endif
     m.Pack(Properties.data(),Properties.size());
-    m.Pack(DataSet.data(),DataSet.size());
+    const Buffer_t& buf(readBuffer());
+    m.Pack(const_cast<RealType*>(buf.data()),buf.size());
     //Properties.putMessage(m);
     //DataSet.putMessage(m);
     for (int iat=0; iat<PropertyHistory.size(); iat++)
@@ -460,7 +638,7 @@ struct Walker
   inline Msg& getMessage(Msg& m)
   {
     const int nat=R.size();
-    m>>ID >> ParentID >> Generation >> Age >> ReleasedNodeAge >> ReleasedNodeWeight;
+    m>>ID >> ParentID >> StreamCount >> Generation >> Age >> ReleasedNodeAge >> ReleasedNodeWeight;
     m.Unpack(&(R[0][0]),nat*OHMMS_DIM);
 #if defined(QMC_COMPLEX)
     m.Unpack(reinterpret_cast<RealType*>(&(G[0][0])),nat*OHMMS_DIM*2);
@@ -470,6 +648,13 @@ struct Walker
     m.Unpack(L.first_address(),nat);
 #endif
     m.Unpack(Properties.data(),Properties.size());
+    if(BufferSource)
+    {
+      //only the size of the source's DataSet is needed
+      DataSet.resize(BufferSource->DataSet.size());
+      DataSetForDerivatives=BufferSource->DataSetForDerivatives;
+      releaseSource();
+    }
     m.Unpack(DataSet.data(),DataSet.size());
     //Properties.getMessage(m);
     //DataSet.getMessage(m);
@@ -7,6 +7,7 @@
 #include "OhmmsPETE/OhmmsMatrix.h"
 #include "ParticleBase/ParticleAttrib.h"
 #include "Utilities/RandomGenerator.h"
+#include "Numerics/e2iphi.h"
 
 /*!\fn template<class T> void assignGaussRand(T* restrict a, unsigned n)
   *\param a the starting pointer
@@ -29,6 +30,45 @@
 namespace qmcplusplus
 {
 
+#if defined(QMC_RNG_PHILOX)
+/** Box-Muller on blocks of pairs
+ *
+ * The uniform pairs of a block are drawn first in the order of the scalar
+ * loop, then log, sqrt and sincos are applied to the arrays, which are
+ * vectorized by the compiler or by eval_e2iphi. The Philox streams are new,
+ * so the results may depend on the vendor math library.
+ */
+template<class T, class RG>
+inline void assignGaussRand(T* restrict a, unsigned n, RG& rng)
+{
+  const unsigned block=64;
+  T r[block], phi[block], c[block], s[block];
+  const unsigned npairs=(n+1)/2;
+  for (unsigned first=0; first<npairs; first+=block)
+  {
+    const int m=std::min(block,npairs-first);
+    for (int j=0; j<m; ++j)
+    {
+      r[j]=1-0.9999999999*rng();
+      phi[j]=6.283185306*rng();
+    }
+    for (int j=0; j<m; ++j)
+      r[j]=std::sqrt(-2.0*std::log(r[j]));
+    eval_e2iphi(m,phi,c,s);
+    T* restrict out=a+2*first;
+    //the last pair of an odd n only has the cos part
+    const int mfull=(2*(first+m)>n)?m-1:m;
+    for (int j=0; j<mfull; ++j)
+    {
+      out[2*j]  =r[j]*c[j];
+      out[2*j+1]=r[j]*s[j];
+    }
+    if (mfull<m)
+      out[2*mfull]=r[mfull]*c[mfull];
+  }
+}
+#else
+///Box-Muller with std::cos and std::sin, the sequence does not depend on the vendor math library
 template<class T, class RG>
 inline void assignGaussRand(T* restrict a, unsigned n, RG& rng)
 {
@@ -44,6 +84,7 @@ inline void assignGaussRand(T* restrict a, unsigned n, RG& rng)
     a[n-1]=std::sqrt(-2.0*std::log(temp1))*std::cos(6.283185306*temp2);
   }
 }
+#endif
 /*!\fn template<class T> void assignUniformRand(T* restrict a, unsigned n)
   *\param a the starting pointer
   *\param n the number of type T to be assigned
@@ -22,6 +22,7 @@
  */
 #include "QMCApp/WaveFunctionPool.h"
 #include "QMCApp/ParticleSetPool.h"
+#include "QMCWaveFunctions/Fermion/SlaterDetBuilder.h"
 using namespace std;
 #include "OhmmsData/AttributeSet.h"
 #include "Utilities/OhmmsInfo.h"
@@ -40,6 +41,8 @@ WaveFunctionPool::WaveFunctionPool(Communicate* c, const char* aname)
 WaveFunctionPool::~WaveFunctionPool()
 {
   DEBUG_MEMORY("WaveFunctionPool::~WaveFunctionPool");
+  //the shared SPO sets are owned by the wavefunctions of the pool
+  SlaterDetBuilder::clearSharedSPOSets();
   PoolType::iterator it(myPool.begin());
   while(it != myPool.end())
   {
@@ -24,6 +24,7 @@
 #include "OhmmsApp/ProjectData.h"
 #include "QMCApp/QMCMain.h"
 #include "qmc_common.h"
+#include "Message/OpenMP.h"
 //#include "tau/profiler.h"
 
 
@@ -120,6 +121,26 @@ int main(int argc, char **argv)
   myinput = myinput.substr(0,myinput.size()-4);
   logname << myinput;
   OhmmsInfo Welcome(logname.str(),qmcComm->rank(),qmcComm->getGroupID(),inputs.size());
+  //the CI expansion is split over groups of ci_shards consecutive ranks;
+  //the ranks with the same shard index run a replica of the whole simulation
+  //so that a group always moves the same walker
+  Communicate* runComm=qmcComm;
+  if(qmc_common.ci_shards>1)
+  {
+    int nshards=qmc_common.ci_shards;
+    if(qmcComm->size()%nshards)
+    {
+      APP_ABORT("qmcapp: the number of MPI tasks of an input is not a multiple of ci_shards");
+    }
+    if(omp_get_max_threads()>1)
+    {
+      APP_ABORT("qmcapp: --ci_shards requires OMP_NUM_THREADS=1. The ranks of a CI shard group must move the same walker in lock-step, which the threaded drivers do not guarantee.");
+    }
+    qmc_common.ci_comm=new Communicate(*qmcComm,qmcComm->size()/nshards);
+    qmc_common.ci_shard_rank=qmc_common.ci_comm->rank();
+    runComm=new Communicate(*qmcComm,qmc_common.ci_shard_rank,qmcComm->rank());
+    runComm->setGroupID(qmcComm->getGroupID());
+  }
 //#if defined(MPIRUN_EXTRA_ARGUMENTS)
 //  //broadcast the input file name to other nodes
 //  MPI_Bcast(fname.c_str(),fname.size(),MPI_CHAR,0,OHMMS::Controller->getID());
@@ -130,7 +151,7 @@ int main(int argc, char **argv)
   for(int k=0; k<inputs.size(); ++k)
     app_log() << inputs[k] << " ";
   app_log() << endl;
-  qmc = new QMCMain(qmcComm);
+  qmc = new QMCMain(runComm);
   if(inputs.size()>1)
     validInput=qmc->parse(inputs[qmcComm->getGroupID()]);
   else
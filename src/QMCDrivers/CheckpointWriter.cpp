@@ -0,0 +1,119 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim
+//////////////////////////////////////////////////////////////////
+// -*- C++ -*-
+/** @file CheckpointWriter.cpp
+ * @brief Definition of CheckpointWriter
+ */
+#include "QMCDrivers/CheckpointWriter.h"
+#include "QMCDrivers/BranchIO.h"
+#include "HDFVersion.h"
+#include <cstdio>
+#include <sstream>
+#include <unistd.h>
+
+namespace qmcplusplus
+{
+
+CheckpointWriter::CheckpointWriter(MCWalkerConfiguration& w, const string& aroot, Communicate* c, int keep)
+  : myComm(c), RootName(aroot), KeepGenerations(std::max(keep,1)), Busy(false)
+  , Walkers(w,aroot,c), Branch(0)
+{
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+  wait();
+  delete Branch;
+}
+
+void CheckpointWriter::write(MCWalkerConfiguration& w, bool state, SimpleFixedNodeBranch& branch)
+{
+  wait();
+  Walkers.collect(w,state);
+  RandomNumberControl::gather(RandomStates,myComm);
+  if(myComm->rank())
+    return;
+  //BranchIO writes the histograms and the parameters as SimpleFixedNodeBranch::write
+  delete Branch;
+  Branch=new SimpleFixedNodeBranch(branch);
+  Branch->EnergyHist=branch.EnergyHist;
+  Branch->VarianceHist=branch.VarianceHist;
+  Branch->R2Accepted=branch.R2Accepted;
+  Branch->R2Proposed=branch.R2Proposed;
+  Branch->vParam[SimpleFixedNodeBranch::B_ACC_ENERGY]=branch.EnergyHist.result();
+  Branch->vParam[SimpleFixedNodeBranch::B_ACC_SAMPLES]=branch.EnergyHist.count();
+#if defined(HAVE_PTHREAD) && defined(H5_HAVE_THREADSAFE)
+  Busy=(pthread_create(&Worker,0,CheckpointWriter::run,this)==0);
+  if(Busy)
+    return;
+#endif
+  write_files();
+  report_error();
+}
+
+void CheckpointWriter::wait()
+{
+#if defined(HAVE_PTHREAD)
+  if(Busy)
+    pthread_join(Worker,0);
+#endif
+  Busy=false;
+  report_error();
+}
+
+void CheckpointWriter::report_error()
+{
+  if(ErrorMessage.empty())
+    return;
+  app_error() << "  CheckpointWriter " << ErrorMessage << endl;
+  ErrorMessage.clear();
+}
+
+void* CheckpointWriter::run(void* arg)
+{
+  static_cast<CheckpointWriter*>(arg)->write_files();
+  return 0;
+}
+
+void CheckpointWriter::write_files()
+{
+  string fname=RootName+hdf::config_ext;
+  string tmpname=fname+".tmp";
+  {
+    hdf_archive hout;
+    if(!hout.create(tmpname))
+    {
+      ErrorMessage="cannot create "+tmpname;
+      return;
+    }
+    HDFVersion cur_version;
+    hout.write(cur_version.version,hdf::version);
+    hout.push(hdf::main_state);
+    Walkers.write_collected(hout);
+    hout.pop();
+    RandomNumberControl::write(hout,RandomStates);
+  }
+  BranchIO hh(*Branch,0);
+  hh.write(tmpname);
+  //shift the old checkpoints and keep the current one by a link until it is replaced
+  for(int g=KeepGenerations-1; g>0; --g)
+  {
+    std::ostringstream older, newer;
+    older << fname << "." << g;
+    if(g>1)
+    {
+      newer << fname << "." << g-1;
+      rename(newer.str().c_str(),older.str().c_str());
+    }
+    else
+    {
+      unlink(older.str().c_str());
+      link(fname.c_str(),older.str().c_str());
+    }
+  }
+  if(rename(tmpname.c_str(),fname.c_str()))
+    ErrorMessage="cannot rename "+tmpname+" to "+fname;
+}
+
+}
@@ -0,0 +1,94 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim
+//////////////////////////////////////////////////////////////////
+// -*- C++ -*-
+/** @file CheckpointWriter.h
+ * @brief Declaration of CheckpointWriter
+ */
+#ifndef QMCPLUSPLUS_CHECKPOINTWRITER_H
+#define QMCPLUSPLUS_CHECKPOINTWRITER_H
+
+#include "Particle/HDFWalkerOutput.h"
+#include "QMCDrivers/SimpleFixedNodeBranch.h"
+#include "OhmmsApp/RandomNumberControl.h"
+#if defined(HAVE_PTHREAD)
+#include <pthread.h>
+#endif
+
+namespace qmcplusplus
+{
+
+/** checkpoint of a run written in the background
+ *
+ * write collects the walkers, the random states and the branch engine on the
+ * root and returns. The root writes them to RootName.config.h5.tmp, which
+ * replaces RootName.config.h5 when it is complete. The previous checkpoints are
+ * kept as RootName.config.h5.1, .2, ... up to KeepGenerations-1.
+ *
+ * The file is written by a thread when the hdf5 library is thread-safe, since
+ * the estimators keep writing their hdf5 files. Otherwise, it is written by the
+ * caller.
+ */
+class CheckpointWriter
+{
+public:
+
+  /** constructor
+   * @param w walkers
+   * @param aroot root name of the checkpoint
+   * @param c communicator
+   * @param keep number of the checkpoints to keep
+   */
+  CheckpointWriter(MCWalkerConfiguration& w, const string& aroot, Communicate* c, int keep);
+  ///destructor waits for the checkpoint being written
+  ~CheckpointWriter();
+
+  /** write a checkpoint
+   * @param w walkers
+   * @param state if true, write the state records of the walkers
+   * @param branch branch engine
+   *
+   * Collective. The previous checkpoint is completed first.
+   */
+  void write(MCWalkerConfiguration& w, bool state, SimpleFixedNodeBranch& branch);
+
+  /** wait for the checkpoint being written
+   *
+   * Reports the errors of the writer, on the calling thread.
+   */
+  void wait();
+
+private:
+  ///communicator
+  Communicate* myComm;
+  ///root name of the checkpoint
+  string RootName;
+  ///number of the checkpoints to keep
+  int KeepGenerations;
+  ///true, while a thread is writing
+  bool Busy;
+  ///collected walkers
+  HDFWalkerOutput Walkers;
+  ///copy of the branch engine
+  SimpleFixedNodeBranch* Branch;
+  ///collected random states
+  vector<RandomNumberControl::uint_type> RandomStates;
+  ///error of the last write, reported by wait
+  string ErrorMessage;
+#if defined(HAVE_PTHREAD)
+  pthread_t Worker;
+#endif
+
+  /** write the collected data and replace the checkpoint, on the root
+   *
+   * May run on the writer thread: an error is kept in ErrorMessage and is
+   * not written to the log streams.
+   */
+  void write_files();
+  ///report and clear ErrorMessage
+  void report_error();
+  ///entry of the thread
+  static void* run(void* arg);
+};
+}
+#endif
@@ -36,9 +36,13 @@ vector<TrialWaveFunction*> CloneManager::guideClones;
 vector<MCWalkerConfiguration*> CloneManager::wgClones;
 //initialization of the static hClones
 vector<QMCHamiltonian*> CloneManager::hClones;
+//initialization of the static clones of the crowds
+vector<vector<MCWalkerConfiguration*> > CloneManager::wCrowdClones;
+vector<vector<TrialWaveFunction*> > CloneManager::psiCrowdClones;
+vector<vector<QMCHamiltonian*> > CloneManager::hCrowdClones;
 
 /// Constructor.
-CloneManager::CloneManager(HamiltonianPool& hpool): cloneEngine(hpool)
+CloneManager::CloneManager(HamiltonianPool& hpool): cloneEngine(hpool), CrowdSize(1)
 {
   NumThreads=omp_get_max_threads();
   wPerNode.resize(NumThreads+1,0);
@@ -84,6 +88,71 @@ void CloneManager::makeClones(MCWalkerConfiguration& w,
   OhmmsInfo::Warn->reset();
 }
 
+void CloneManager::makeCrowdClones(int crowd)
+{
+  wCrowdClones.resize(NumThreads);
+  psiCrowdClones.resize(NumThreads);
+  hCrowdClones.resize(NumThreads);
+  if(wCrowdClones[0].size()>=crowd)
+  {
+    resetCrowdClones();
+    return;
+  }
+  app_log() << "  CloneManager::makeCrowdClones makes " << crowd << " clones for W/Psi/H per thread." <<endl;
+  OhmmsInfo::Log->turnoff();
+  OhmmsInfo::Warn->turnoff();
+  for(int ip=0; ip<NumThreads; ++ip)
+  {
+    if(wCrowdClones[ip].empty())
+    {
+      wCrowdClones[ip].push_back(wClones[ip]);
+      psiCrowdClones[ip].push_back(psiClones[ip]);
+      hCrowdClones[ip].push_back(hClones[ip]);
+    }
+    while(wCrowdClones[ip].size()<crowd)
+    {
+      MCWalkerConfiguration* w=new MCWalkerConfiguration(*wClones[0]);
+      TrialWaveFunction* psi=psiClones[0]->makeClone(*w);
+      wCrowdClones[ip].push_back(w);
+      psiCrowdClones[ip].push_back(psi);
+      hCrowdClones[ip].push_back(hClones[0]->makeClone(*w,*psi));
+    }
+  }
+  OhmmsInfo::Log->reset();
+  OhmmsInfo::Warn->reset();
+  resetCrowdClones();
+}
+
+void CloneManager::resetCrowdClones()
+{
+  if(psiClones.empty())
+    return;
+  //the set is only read: psiClones keep the indices of their optimizer
+  opt_variables_type vars;
+  psiClones[0]->checkInVariables(vars);
+  vars.resetIndex();
+  resetCrowdClones(vars);
+}
+
+void CloneManager::releaseWalkerBuffers()
+{
+  for(int ip=0; ip<psiClones.size(); ++ip)
+    psiClones[ip]->setBufferResident(false);
+  for(int ip=0; ip<psiCrowdClones.size(); ++ip)
+    for(int k=1; k<psiCrowdClones[ip].size(); ++k)
+      psiCrowdClones[ip][k]->setBufferResident(false);
+}
+
+void CloneManager::resetCrowdClones(const opt_variables_type& active)
+{
+  for(int ip=0; ip<psiCrowdClones.size(); ++ip)
+    for(int k=1; k<psiCrowdClones[ip].size(); ++k)
+    {
+      psiCrowdClones[ip][k]->checkOutVariables(active);
+      psiCrowdClones[ip][k]->resetParameters(active);
+    }
+}
+
 void CloneManager::makeClones_new(MCWalkerConfiguration& w,
                                   TrialWaveFunction& psi, QMCHamiltonian& ham)
 {
@@ -45,6 +45,30 @@ public:
   void makeClones_new(MCWalkerConfiguration& w, TrialWaveFunction& psi, QMCHamiltonian& ham);
   void makeClones(MCWalkerConfiguration& wg, TrialWaveFunction& guide);
   void makeClones(TrialWaveFunction& guide);
+  /** make the clones for the crowds of crowd walkers
+   * @param crowd number of walkers advanced together by a thread
+   *
+   * The slot 0 of a crowd is the clone of the thread. The other slots are
+   * cloned from wClones[0], psiClones[0] and hClones[0] and kept for later
+   * drivers, as the clones of the threads.
+   */
+  void makeCrowdClones(int crowd);
+  /** copy the current variational parameters of psiClones[0] to the crowd slots
+   *
+   * The slots are made once and kept, so they are reset every time a driver
+   * starts to pick up the parameters changed by an optimizer.
+   */
+  void resetCrowdClones();
+  /** reset the crowd slots to the parameters of an active set
+   * @param active the set shared with psiClones, e.g. OptVariablesForPsi of a cost function
+   */
+  void resetCrowdClones(const opt_variables_type& active);
+  /** detach the determinants of all the clones from the walker buffers
+   *
+   * Called when a driver ends, before the walkers are branched, resized or
+   * used by another driver.
+   */
+  static void releaseWalkerBuffers();
 
   inline RealType acceptRatio() const
   {
@@ -63,6 +87,8 @@ protected:
   HamiltonianPool& cloneEngine;
   ///number of threads
   IndexType NumThreads;
+  ///number of walkers advanced together by a thread, 1 to advance them one by one
+  int CrowdSize;
   ///walkers
   static vector<MCWalkerConfiguration*> wClones;
   static vector<MCWalkerConfiguration*> wgClones;
@@ -72,6 +98,12 @@ protected:
   static vector<TrialWaveFunction*> guideClones;
   ///Hamiltonians
   static vector<QMCHamiltonian*> hClones;
+  ///walkers of the crowds, [thread][slot]
+  static vector<vector<MCWalkerConfiguration*> > wCrowdClones;
+  ///trial wavefunctions of the crowds, [thread][slot]
+  static vector<vector<TrialWaveFunction*> > psiCrowdClones;
+  ///Hamiltonians of the crowds, [thread][slot]
+  static vector<vector<QMCHamiltonian*> > hCrowdClones;
   ///update engines
   vector<QMCUpdateBase*> Movers;
 //     ///update engines
@@ -124,14 +124,11 @@ void CSUpdateBase::initCSWalkers(WalkerIter_t it, WalkerIter_t it_end,
       thisWalker.Properties(ipsi,UMBRELLAWEIGHT)
       = invsumratio[ipsi] =1.0/sumratio[ipsi];
     }
-    //DON't forget DRIFT!!!
-    thisWalker.Drift=0.0;
+    //the gradient of the drift is weighted by the umbrella weights
+    thisWalker.G=0.0;
     if(useDrift)
-    {
       for(int ipsi=0; ipsi< nPsi; ipsi++)
-        PAOps<RealType,DIM>::axpy(invsumratio[ipsi],Psi1[ipsi]->G,thisWalker.Drift);
-      setScaledDrift(Tau,thisWalker.Drift);
-    }
+        PAOps<RealType,DIM>::axpy(invsumratio[ipsi],Psi1[ipsi]->G,thisWalker.G);
     ++it;
     ++iw;
   }
@@ -159,12 +156,13 @@ void CSUpdateBase::initCSWalkersForPbyP(WalkerIter_t it, WalkerIter_t it_end,
     Walker_t& thisWalker(**it);
     thisWalker.DataSet.clear();
     thisWalker.DataSet.rewind();
-    W.registerData(thisWalker,(*it)->DataSet);
+    W.R=thisWalker.R;
+    W.update();
     //evalaute the wavefunction and hamiltonian
     for(int ipsi=0; ipsi< nPsi; ipsi++)
     {
-      //Need to modify the return value of OrbitalBase::registerData
-      logpsi[ipsi]=Psi1[ipsi]->registerData(W,(*it)->DataSet);
+      //the trial wavefunctions are stored one after the other in DataSet
+      logpsi[ipsi]=Psi1[ipsi]->registerData(W,thisWalker.DataSet);
       Psi1[ipsi]->G=W.G;
       thisWalker.Properties(ipsi,LOGPSI)=logpsi[ipsi];
       thisWalker.Properties(ipsi,LOCALENERGY)=H1[ipsi]->evaluate(W);
@@ -193,14 +191,11 @@ void CSUpdateBase::initCSWalkersForPbyP(WalkerIter_t it, WalkerIter_t it_end,
       thisWalker.Properties(ipsi,UMBRELLAWEIGHT)
       = invsumratio[ipsi] =1.0/sumratio[ipsi];
     }
-    //DON't forget DRIFT!!!
-    thisWalker.Drift=0.0;
+    //the gradient of the drift is weighted by the umbrella weights
+    thisWalker.G=0.0;
     if(useDrift)
-    {
       for(int ipsi=0; ipsi< nPsi; ipsi++)
-        PAOps<RealType,DIM>::axpy(invsumratio[ipsi],Psi1[ipsi]->G,thisWalker.Drift);
-      setScaledDrift(Tau,thisWalker.Drift);
-    }
+        PAOps<RealType,DIM>::axpy(invsumratio[ipsi],Psi1[ipsi]->G,thisWalker.G);
     ++it;
     ++iw;
   }
@@ -212,14 +207,12 @@ void CSUpdateBase::updateCSWalkers(WalkerIter_t it, WalkerIter_t it_end)
   while(it != it_end)
   {
     Walker_t& thisWalker(**it);
-    Walker_t::Buffer_t& w_buffer((*it)->DataSet);
-    w_buffer.rewind();
-    W.updateBuffer(**it,w_buffer);
+    Walker_t::Buffer_t& w_buffer(thisWalker.DataSet);
+    W.loadWalker(thisWalker,true);
     //evalaute the wavefunction and hamiltonian
     for(int ipsi=0; ipsi< nPsi; ipsi++)
     {
-      //Need to modify the return value of OrbitalBase::registerData
-      logpsi[ipsi]=Psi1[ipsi]->updateBuffer(W,(*it)->DataSet);
+      logpsi[ipsi]=Psi1[ipsi]->updateBuffer(W,w_buffer,true);
       Psi1[ipsi]->G=W.G;
       thisWalker.Properties(ipsi,LOGPSI)=logpsi[ipsi];
       thisWalker.Properties(ipsi,LOCALENERGY)=H1[ipsi]->evaluate(W);
@@ -245,14 +238,11 @@ void CSUpdateBase::updateCSWalkers(WalkerIter_t it, WalkerIter_t it_end)
       thisWalker.Properties(ipsi,UMBRELLAWEIGHT)
       = invsumratio[ipsi] =1.0/sumratio[ipsi];
     }
-    //DON't forget DRIFT!!!
-    thisWalker.Drift=0.0;
+    //the gradient of the drift is weighted by the umbrella weights
+    thisWalker.G=0.0;
     if(useDrift)
-    {
       for(int ipsi=0; ipsi< nPsi; ipsi++)
-        PAOps<RealType,DIM>::axpy(invsumratio[ipsi],Psi1[ipsi]->G,thisWalker.Drift);
-      setScaledDrift(Tau,thisWalker.Drift);
-    }
+        PAOps<RealType,DIM>::axpy(invsumratio[ipsi],Psi1[ipsi]->G,thisWalker.G);
     ++it;
     ++iw;
   }
@@ -49,7 +49,10 @@ void CSVMCUpdateAll::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool m
     //create a 3N-Dimensional Gaussian with variance=1
     makeGaussRandomWithEngine(deltaR,RandomGen);
     if(useDrift)
-      W.R = m_sqrttau*deltaR + thisWalker.R + thisWalker.Drift;
+    {
+      setScaledDrift(Tau,thisWalker.G,drift);
+      W.R = m_sqrttau*deltaR + thisWalker.R + drift;
+    }
     else
       W.R = m_sqrttau*deltaR + thisWalker.R;
     //update the distance table associated with W
@@ -82,12 +85,12 @@ void CSVMCUpdateAll::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool m
     {
       //forward green function
       RealType logGf = -0.5*Dot(deltaR,deltaR);
-      PAOps<RealType,DIM>::scale(invsumratio[0],Psi1[0]->G,drift);
+      PAOps<RealType,DIM>::scale(invsumratio[0],Psi1[0]->G,dG);
       for(int ipsi=1; ipsi< nPsi ; ipsi++)
       {
-        PAOps<RealType,DIM>::axpy(invsumratio[ipsi],Psi1[ipsi]->G,drift);
+        PAOps<RealType,DIM>::axpy(invsumratio[ipsi],Psi1[ipsi]->G,dG);
       }
-      setScaledDrift(Tau,drift);
+      setScaledDrift(Tau,dG,drift);
       //backward green function
       deltaR = thisWalker.R - W.R - drift;
       RealType logGb = -m_oneover2tau*Dot(deltaR,deltaR);
@@ -100,7 +103,7 @@ void CSVMCUpdateAll::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool m
     //This is broken up into two pieces
     //RealType g = sumratio[0]/thisWalker.Multiplicity*
     // 	std::exp(logGb-logGf+2.0*(logpsi[0]-thisWalker.Properties(LOGPSI)));
-    if(Random() > g)
+    if(RandomGen() > g)
     {
       thisWalker.Age++;
       ++nReject;
@@ -110,7 +113,8 @@ void CSVMCUpdateAll::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool m
       thisWalker.Age=0;
       thisWalker.Multiplicity=sumratio[0];
       thisWalker.R = W.R;
-      thisWalker.Drift = drift;
+      if(useDrift)
+        thisWalker.G = dG;
       for(int ipsi=0; ipsi<nPsi; ipsi++)
       {
         W.L=Psi1[ipsi]->L;
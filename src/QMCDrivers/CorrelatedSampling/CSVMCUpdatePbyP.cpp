@@ -47,10 +47,7 @@ void CSVMCUpdatePbyP::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool
     //Walkers loop
     Walker_t& thisWalker(**it);
     Walker_t::Buffer_t& w_buffer(thisWalker.DataSet);
-    W.R = thisWalker.R;
-    w_buffer.rewind();
-    // Copy walker info in W
-    W.copyFromBuffer(w_buffer);
+    W.loadWalker(thisWalker,true);
     for(int ipsi=0; ipsi<nPsi; ipsi++)
     {
       // Copy wave function info in W and Psi1
@@ -103,7 +100,7 @@ void CSVMCUpdatePbyP::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool
         for(int ipsi=0; ipsi< nPsi ; ipsi++)
           invsumratio[ipsi]=1.0/sumratio[ipsi];
         RealType td=ratio[0]*ratio[0]*sumratio[0]/(*it)->Multiplicity;
-        accept_move=Random()<std::min(1.0,td);
+        accept_move=RandomGen()<std::min(1.0,td);
       }
       //RealType prob = std::min(1.0,td);
       //if(Random() < prob)
@@ -152,15 +149,10 @@ void CSVMCUpdatePbyP::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool
          -buffered info for each Psi1[i]
          Physical properties are updated */
       (*it)->Age=0;
-      (*it)->R = W.R;
-      w_buffer.rewind();
-      W.copyToBuffer(w_buffer);
+      W.saveWalker(thisWalker);
       for(int ipsi=0; ipsi< nPsi; ipsi++)
       {
-        W.G=Psi1[ipsi]->G;
-        W.L=Psi1[ipsi]->L;
-        //ValueType psi = Psi1[ipsi]->evaluate(W,w_buffer);
-        ValueType logpsi = Psi1[ipsi]->evaluateLog(W,w_buffer);
+        thisWalker.Properties(ipsi,LOGPSI)=Psi1[ipsi]->updateBuffer(W,w_buffer,false);
         RealType et = H1[ipsi]->evaluate(W);
         //multiEstimator->updateSample(iwalker,ipsi,et,UmbrellaWeight[ipsi]);
         //Properties is used for UmbrellaWeight and UmbrellaEnergy
@@ -0,0 +1,383 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim
+//////////////////////////////////////////////////////////////////
+// -*- C++ -*-
+/** @file CrowdUpdatePbyP.cpp
+ * @brief Definition of CrowdUpdatePbyP
+ */
+#include "QMCDrivers/CrowdUpdatePbyP.h"
+#include "ParticleBase/ParticleUtility.h"
+#include "ParticleBase/RandomSeqGenerator.h"
+#include "QMCDrivers/DriftOperators.h"
+
+namespace qmcplusplus
+{
+
+CrowdUpdatePbyP::CrowdUpdatePbyP(const vector<MCWalkerConfiguration*>& w, const vector<TrialWaveFunction*>& psi,
+                                 const vector<QMCHamiltonian*>& h, RandomGenerator_t& rg, int crowd, bool dmc)
+  : QMCUpdateBase(*w[0],*psi[0],*h[0],rg), DMCMode(dmc)
+  , wSlots(w.begin(),w.begin()+crowd), pSlots(w.begin(),w.begin()+crowd)
+  , psiSlots(psi.begin(),psi.begin()+crowd), hSlots(h.begin(),h.begin()+crowd)
+  , deltaRSlots(crowd), rngSlots(crowd,&rg), CrowdCheck("no"), maxGradDiff(0.0), maxRatioDiff(0.0)
+{
+  myParams.add(CrowdCheck,"crowdcheck","string");
+#if defined(QMC_RNG_PHILOX)
+  //each slot draws from the stream of its walker
+  for(int k=1; k<crowd; ++k)
+    rngSlots[k]=new RandomGenerator_t(rg);
+#endif
+  for(int k=1; k<crowd; ++k)
+    hSlots[k]->setRandomGenerator(rngSlots[k]);
+  myTimers.push_back(new NewTimer("CrowdUpdatePbyP::advance")); //timer for the walker loop
+  myTimers.push_back(new NewTimer("CrowdUpdatePbyP::movePbyP")); //timer for MC, ratio etc
+  myTimers.push_back(new NewTimer("CrowdUpdatePbyP::updateMBO")); //timer for measurements
+  myTimers.push_back(new NewTimer("CrowdUpdatePbyP::energy")); //timer for measurements
+  for (int i=0; i<myTimers.size(); ++i)
+    TimerManager.addTimer(myTimers[i]);
+}
+
+CrowdUpdatePbyP::~CrowdUpdatePbyP()
+{
+  if(CrowdCheck == "yes")
+    app_log() << "  CrowdUpdatePbyP check: largest relative differences from the single-walker functions, gradients = "
+              << maxGradDiff << " ratios = " << maxRatioDiff << endl;
+#if defined(QMC_RNG_PHILOX)
+  for(int k=1; k<rngSlots.size(); ++k)
+    delete rngSlots[k];
+#endif
+}
+
+/** initialize the walkers and the wavefunctions of the slots
+ *
+ * The wavefunctions of the slots are evaluated once with a scratch buffer to
+ * allocate their work space.
+ */
+void CrowdUpdatePbyP::initWalkersForPbyP(WalkerIter_t it, WalkerIter_t it_end)
+{
+  QMCUpdateBase::initWalkersForPbyP(it,it_end);
+  for(int k=1; k<wSlots.size(); ++k)
+  {
+    psiSlots[k]->setBufferResident(UseResident=="yes");
+    wSlots[k]->R=W.R;
+    wSlots[k]->update();
+    Walker_t::Buffer_t scratch;
+    psiSlots[k]->registerData(*wSlots[k],scratch);
+  }
+}
+
+void CrowdUpdatePbyP::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool measure)
+{
+  myTimers[0]->start();
+  nextRandomStep();
+  for(int k=0; k<deltaRSlots.size(); ++k)
+    deltaRSlots[k].resize(NumPtcl);
+  for(int k=1; k<wSlots.size(); ++k)
+    wSlots[k]->resetCollectables();
+  while(it != it_end)
+  {
+    int nw=std::min(static_cast<int>(wSlots.size()),static_cast<int>(it_end-it));
+    loadCrowd(it,nw);
+    if(DMCMode)
+      advanceDMC(it,nw);
+    else
+      advanceVMC(it,nw);
+    it+=nw;
+  }
+  if(W.Collectables.size())
+    for(int k=1; k<wSlots.size(); ++k)
+      W.Collectables += wSlots[k]->Collectables;
+  myTimers[0]->stop();
+}
+
+void CrowdUpdatePbyP::loadCrowd(WalkerIter_t it, int nw)
+{
+  for(int iw=0; iw<nw; ++iw, ++it)
+  {
+    Walker_t& thisWalker(**it);
+    setRandomStream(*rngSlots[iw],thisWalker);
+    wSlots[iw]->loadWalker(thisWalker,true);
+    psiSlots[iw]->copyFromBuffer(*wSlots[iw],thisWalker.DataSet);
+  }
+}
+
+void CrowdUpdatePbyP::advanceVMC(WalkerIter_t it, int nw)
+{
+  vector<ParticleSet*> P(pSlots.begin(),pSlots.begin()+nw);
+  vector<TrialWaveFunction*> psi(psiSlots.begin(),psiSlots.begin()+nw);
+  vector<GradType> grad_now(nw), grad_new(nw);
+  vector<RealType> ratios(nw);
+  vector<bool> moved(nw,false), accepted;
+  //walkers whose moves are proposed
+  vector<int> active;
+  vector<ParticleSet*> activeP;
+  vector<TrialWaveFunction*> activePsi;
+  myTimers[1]->start();
+  for (int iter=0; iter<nSubSteps; ++iter)
+  {
+    for(int iw=0; iw<nw; ++iw)
+    {
+      makeGaussRandomWithEngine(deltaRSlots[iw],*rngSlots[iw]);
+      moved[iw]=false;
+    }
+    for (int iat=0; iat<NumPtcl; ++iat)
+    {
+      TrialWaveFunction::evalGrad(psi,P,iat,grad_now);
+      if(CrowdCheck == "yes")
+        checkCrowd(psi,P,iat,0,grad_now);
+      active.clear();
+      activeP.clear();
+      activePsi.clear();
+      for(int iw=0; iw<nw; ++iw)
+      {
+        PosType dr;
+        getScaledDrift(m_tauovermass,grad_now[iw],dr);
+        dr += m_sqrttau*deltaRSlots[iw][iat];
+        if (!P[iw]->makeMoveAndCheck(iat,dr))
+        {
+          ++nReject;
+          continue;
+        }
+        active.push_back(iw);
+        activeP.push_back(P[iw]);
+        activePsi.push_back(psi[iw]);
+      }
+      if(active.empty())
+        continue;
+      TrialWaveFunction::ratioGrad(activePsi,activeP,iat,ratios,grad_new);
+      if(CrowdCheck == "yes")
+        checkCrowd(activePsi,activeP,iat,&ratios,grad_new);
+      accepted.assign(active.size(),false);
+      for(int ia=0; ia<active.size(); ++ia)
+      {
+        int iw=active[ia];
+        RealType prob = ratios[ia]*ratios[ia];
+        //zero is always rejected
+        if (prob>=numeric_limits<RealType>::epsilon())
+        {
+          RealType logGf = -0.5e0*dot(deltaRSlots[iw][iat],deltaRSlots[iw][iat]);
+          PosType dr;
+          getScaledDrift(m_tauovermass,grad_new[ia],dr);
+          dr = (*it[iw]).R[iat]-P[iw]->R[iat]-dr;
+          RealType logGb = -m_oneover2tau*dot(dr,dr);
+          accepted[ia] = ((*rngSlots[iw])() < prob*std::exp(logGb-logGf));
+        }
+        if(accepted[ia])
+        {
+          moved[iw] = true;
+          ++nAccept;
+          P[iw]->acceptMove(iat);
+        }
+        else
+        {
+          ++nReject;
+          P[iw]->rejectMove(iat);
+        }
+      }
+      TrialWaveFunction::acceptMove(activePsi,activeP,iat,accepted);
+    }
+    //for subSteps must update the walkers
+    for(int iw=0; iw<nw; ++iw)
+    {
+      Walker_t& thisWalker(*it[iw]);
+      thisWalker.R=P[iw]->R;
+      thisWalker.G=P[iw]->G;
+      thisWalker.L=P[iw]->L;
+    }
+  }
+  myTimers[1]->stop();
+  for(int iw=0; iw<nw; ++iw)
+  {
+    Walker_t& thisWalker(*it[iw]);
+    MCWalkerConfiguration& w(*wSlots[iw]);
+    TrialWaveFunction& psi_w(*psiSlots[iw]);
+    QMCHamiltonian& h(*hSlots[iw]);
+    myTimers[2]->start();
+    RealType logpsi = psi_w.updateBuffer(w,thisWalker.DataSet,false);
+    w.saveWalker(thisWalker);
+    myTimers[2]->stop();
+    myTimers[3]->start();
+    RealType eloc=h.evaluate(w);
+    myTimers[3]->stop();
+    thisWalker.resetProperty(logpsi,psi_w.getPhase(),eloc);
+    h.auxHevaluate(w,thisWalker);
+    h.saveProperty(thisWalker.getPropertyBase());
+    if(!moved[iw])
+      ++nAllRejected;
+  }
+}
+
+void CrowdUpdatePbyP::advanceDMC(WalkerIter_t it, int nw)
+{
+  vector<ParticleSet*> P(pSlots.begin(),pSlots.begin()+nw);
+  vector<TrialWaveFunction*> psi(psiSlots.begin(),psiSlots.begin()+nw);
+  vector<GradType> grad_now(nw), grad_new(nw);
+  vector<RealType> ratios(nw), rr(nw), rr_proposed(nw,0.0), rr_accepted(nw,0.0);
+  vector<int> nAcceptTemp(nw,0), nRejectTemp(nw,0);
+  vector<bool> accepted;
+  //walkers whose moves are proposed
+  vector<int> active;
+  vector<ParticleSet*> activeP;
+  vector<TrialWaveFunction*> activePsi;
+  for(int iw=0; iw<nw; ++iw)
+    makeGaussRandomWithEngine(deltaRSlots[iw],*rngSlots[iw]);
+  myTimers[1]->start();
+  for(int iat=0; iat<NumPtcl; ++iat)
+  {
+    TrialWaveFunction::evalGrad(psi,P,iat,grad_now);
+    if(CrowdCheck == "yes")
+      checkCrowd(psi,P,iat,0,grad_now);
+    active.clear();
+    activeP.clear();
+    activePsi.clear();
+    for(int iw=0; iw<nw; ++iw)
+    {
+      PosType dr;
+      getScaledDrift(m_tauovermass,grad_now[iw],dr);
+      dr += m_sqrttau*deltaRSlots[iw][iat];
+      rr[iw]=m_tauovermass*dot(deltaRSlots[iw][iat],deltaRSlots[iw][iat]);
+      rr_proposed[iw]+=rr[iw];
+      if(rr[iw]>m_r2max)
+      {
+        ++nRejectTemp[iw];
+        continue;
+      }
+      if(!P[iw]->makeMoveAndCheck(iat,dr))
+        continue;
+      active.push_back(iw);
+      activeP.push_back(P[iw]);
+      activePsi.push_back(psi[iw]);
+    }
+    if(active.empty())
+      continue;
+    TrialWaveFunction::ratioGrad(activePsi,activeP,iat,ratios,grad_new);
+    if(CrowdCheck == "yes")
+      checkCrowd(activePsi,activeP,iat,&ratios,grad_new);
+    accepted.assign(active.size(),false);
+    for(int ia=0; ia<active.size(); ++ia)
+    {
+      int iw=active[ia];
+      //node is crossed reject the move
+      if (branchEngine->phaseChanged(psi[iw]->getPhaseDiff()))
+        ++nNodeCrossing;
+      else
+      {
+        RealType logGf = -0.5*dot(deltaRSlots[iw][iat],deltaRSlots[iw][iat]);
+        PosType dr;
+        getScaledDrift(m_tauovermass,grad_new[ia],dr);
+        dr = (*it[iw]).R[iat] - P[iw]->R[iat] - dr;
+        RealType logGb = -m_oneover2tau*dot(dr,dr);
+        RealType prob = ratios[ia]*ratios[ia]*std::exp(logGb-logGf);
+        accepted[ia] = ((*rngSlots[iw])() < prob);
+      }
+      if(accepted[ia])
+      {
+        ++nAcceptTemp[iw];
+        P[iw]->acceptMove(iat);
+        rr_accepted[iw]+=rr[iw];
+      }
+      else
+      {
+        ++nRejectTemp[iw];
+        P[iw]->rejectMove(iat);
+      }
+    }
+    TrialWaveFunction::acceptMove(activePsi,activeP,iat,accepted);
+  }
+  myTimers[1]->stop();
+  for(int iw=0; iw<nw; ++iw)
+  {
+    Walker_t& thisWalker(*it[iw]);
+    MCWalkerConfiguration& w(*wSlots[iw]);
+    TrialWaveFunction& psi_w(*psiSlots[iw]);
+    QMCHamiltonian& h(*hSlots[iw]);
+    Walker_t::Buffer_t& w_buffer(thisWalker.DataSet);
+    RealType eold(thisWalker.Properties(LOCALENERGY));
+    RealType enew(eold);
+    if(UseTMove)
+      nonLocalOps.reset();
+    if(nAcceptTemp[iw]>0)
+    {
+      //need to overwrite the walker properties
+      myTimers[2]->start();
+      thisWalker.Age=0;
+      thisWalker.R = w.R;
+      RealType logpsi = psi_w.updateBuffer(w,w_buffer,false);
+      w.saveWalker(thisWalker);
+      myTimers[2]->stop();
+      myTimers[3]->start();
+      if(UseTMove)
+        enew= h.evaluate(w,nonLocalOps.Txy);
+      else
+        enew= h.evaluate(w);
+      myTimers[3]->stop();
+      thisWalker.resetProperty(logpsi,psi_w.getPhase(),enew,rr_accepted[iw],rr_proposed[iw],1.0 );
+      thisWalker.Weight *= branchEngine->branchWeight(enew,eold);
+      h.auxHevaluate(w,thisWalker);
+      h.saveProperty(thisWalker.getPropertyBase());
+    }
+    else
+    {
+      //all moves are rejected: does not happen normally with reasonable wavefunctions
+      thisWalker.Age++;
+      thisWalker.Properties(R2ACCEPTED)=0.0;
+      h.rejectedMove(w,thisWalker);
+      ++nAllRejected;
+      thisWalker.Weight *= branchEngine->branchWeight(enew,eold);
+    }
+    if(UseTMove)
+    {
+      int ibar = nonLocalOps.selectMove((*rngSlots[iw])());
+      //make a non-local move
+      if(ibar)
+      {
+        int iat=nonLocalOps.id(ibar);
+        if(w.makeMoveAndCheck(iat,nonLocalOps.delta(ibar)))
+        {
+          myTimers[2]->start();
+          psi_w.ratio(w,iat,dG,dL);
+          w.acceptMove(iat);
+          psi_w.acceptMove(w,iat);
+          w.G += dG;
+          w.L += dL;
+          psi_w.evaluateLog(w,w_buffer);
+          w.saveWalker(thisWalker);
+          ++NonLocalMoveAccepted;
+          myTimers[2]->stop();
+        }
+      }
+    }
+    nAccept += nAcceptTemp[iw];
+    nReject += nRejectTemp[iw];
+  }
+}
+
+/** the single-walker functions recompute the state of the proposed move,
+ * which is left as the crowd functions set it.
+ */
+void CrowdUpdatePbyP::checkCrowd(const vector<TrialWaveFunction*>& psi, const vector<ParticleSet*>& P, int iat,
+                                 const vector<RealType>* ratios, const vector<GradType>& grads)
+{
+  const RealType tol=1e-6;
+  const RealType eps=numeric_limits<RealType>::epsilon();
+  for(int iw=0; iw<psi.size(); ++iw)
+  {
+    GradType g;
+    if(ratios)
+    {
+      RealType r=psi[iw]->ratioGrad(*P[iw],iat,g);
+      RealType dr=std::abs((*ratios)[iw]-r)/std::max(std::abs(r),eps);
+      if(dr>tol && maxRatioDiff<=tol)
+        app_warning() << "  CrowdUpdatePbyP check: the ratio of the particle " << iat << " differs by " << dr << endl;
+      maxRatioDiff=std::max(maxRatioDiff,dr);
+    }
+    else
+      g=psi[iw]->evalGrad(*P[iw],iat);
+    GradType d(grads[iw]-g);
+    RealType dg=std::sqrt(std::abs(dot(d,d)))/std::max(std::sqrt(std::abs(dot(g,g))),eps);
+    if(dg>tol && maxGradDiff<=tol)
+      app_warning() << "  CrowdUpdatePbyP check: the gradient of the particle " << iat << " differs by " << dg << endl;
+    maxGradDiff=std::max(maxGradDiff,dg);
+  }
+}
+
+}
@@ -0,0 +1,95 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim
+//////////////////////////////////////////////////////////////////
+// -*- C++ -*-
+/** @file CrowdUpdatePbyP.h
+ * @brief Declaration of CrowdUpdatePbyP
+ */
+#ifndef QMCPLUSPLUS_CROWD_PARTICLEBYPARTICLE_UPDATE_H
+#define QMCPLUSPLUS_CROWD_PARTICLEBYPARTICLE_UPDATE_H
+#include "QMCDrivers/QMCUpdateBase.h"
+
+namespace qmcplusplus
+{
+
+/** @ingroup QMCDrivers  ParticleByParticle
+ * @brief Particle-by-particle moves with drift of crowds of walkers in lock-step
+ *
+ * A crowd of walkers is loaded into the slots, each with its own W, Psi and
+ * H, and the iat-th particle of all the walkers is moved before the next
+ * particle. The gradients, the ratios and the updates of the crowd are done
+ * by the multi-walker functions of TrialWaveFunction, which pass the crowd
+ * down to the orbitals, e.g. the positions of the crowd are evaluated by one
+ * spline table back to back.
+ *
+ * The moves are those of VMCUpdatePbyPWithDriftFast or, in the DMC mode, of
+ * DMCUpdatePbyPWithRejectionFast, including the T-moves. Each walker draws its
+ * random numbers in the same order as with these movers, so with QMC_RNG_PHILOX
+ * the walkers follow the same paths up to round-off.
+ *
+ * With <parameter name="crowdcheck">yes</parameter>, the gradients and the
+ * ratios of every crowd are compared with those of the single-walker functions
+ * of TrialWaveFunction. The largest relative differences are reported.
+ */
+class CrowdUpdatePbyP: public QMCUpdateBase
+{
+public:
+  /** constructor
+   * @param w walkers of the slots, w[0] is the walkers of the thread
+   * @param psi trial wavefunctions of the slots
+   * @param h Hamiltonians of the slots
+   * @param rg random number generator of the thread
+   * @param crowd number of the walkers of a crowd
+   * @param dmc if true, use the DMC moves
+   */
+  CrowdUpdatePbyP(const vector<MCWalkerConfiguration*>& w, const vector<TrialWaveFunction*>& psi,
+                  const vector<QMCHamiltonian*>& h, RandomGenerator_t& rg, int crowd, bool dmc);
+
+  ~CrowdUpdatePbyP();
+
+  void initWalkersForPbyP(WalkerIter_t it, WalkerIter_t it_end);
+
+  void advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool measure);
+
+private:
+  ///true for the DMC moves
+  bool DMCMode;
+  ///walkers of the slots
+  vector<MCWalkerConfiguration*> wSlots;
+  ///particle sets of the slots
+  vector<ParticleSet*> pSlots;
+  ///trial wavefunctions of the slots
+  vector<TrialWaveFunction*> psiSlots;
+  ///Hamiltonians of the slots
+  vector<QMCHamiltonian*> hSlots;
+  ///random displacements of the slots
+  vector<ParticleSet::ParticlePos_t> deltaRSlots;
+  ///random number generators of the slots, owned by the slots k>0 with QMC_RNG_PHILOX
+  vector<RandomGenerator_t*> rngSlots;
+  vector<NewTimer*> myTimers;
+  ///if yes, check the crowd functions against the single-walker functions
+  string CrowdCheck;
+  ///largest relative difference of the gradients found by checkCrowd
+  RealType maxGradDiff;
+  ///largest relative difference of the ratios found by checkCrowd
+  RealType maxRatioDiff;
+
+  ///load the walkers [it,it+nw) into the slots
+  void loadCrowd(WalkerIter_t it, int nw);
+  ///VMC moves of the walkers [it,it+nw)
+  void advanceVMC(WalkerIter_t it, int nw);
+  ///DMC moves of the walkers [it,it+nw)
+  void advanceDMC(WalkerIter_t it, int nw);
+  /** compare the results of the crowd with the single-walker functions
+   * @param psi trial wavefunctions of the crowd
+   * @param P particle sets of the crowd
+   * @param iat active particle
+   * @param ratios ratios by TrialWaveFunction::ratioGrad, 0 after evalGrad
+   * @param grads gradients by TrialWaveFunction::evalGrad or ratioGrad
+   */
+  void checkCrowd(const vector<TrialWaveFunction*>& psi, const vector<ParticleSet*>& P, int iat,
+                  const vector<RealType>* ratios, const vector<GradType>& grads);
+};
+}
+
+#endif
@@ -18,6 +18,7 @@
 #include "QMCDrivers/DMC/DMCUpdatePbyP.h"
 //#include "QMCDrivers/DMC/DMCNonLocalUpdate.h"
 #include "QMCDrivers/DMC/DMCUpdateAll.h"
+#include "QMCDrivers/CrowdUpdatePbyP.h"
 #include "QMCApp/HamiltonianPool.h"
 #include "Message/Communicate.h"
 #include "Message/OpenMP.h"
@@ -45,6 +46,7 @@ DMCOMP::DMCOMP(MCWalkerConfiguration& w, TrialWaveFunction& psi, QMCHamiltonian&
   m_param.add(NonLocalMove,"nonlocalmoves","string");
   m_param.add(mover_MaxAge,"MaxAge","double");
   m_param.add(UseFastGrad,"fastgrad", "string");
+  m_param.add(CrowdSize,"crowd","int");
   //DMC overwrites ConstPopulation
   ConstPopulation=false;
 }
@@ -68,6 +70,8 @@ void DMCOMP::resetComponents(xmlNodePtr cur)
     estimatorClones[ip]->setCollectionMode(false);
     branchClones[ip] = new BranchEngineType(*branchEngine);
   }
+  if(CrowdSize>1 && QMCDriverMode[QMC_UPDATE_MODE] && UseFastGrad == "yes")
+    makeCrowdClones(CrowdSize);
 #if !defined(BGP_BUG)
   #pragma omp parallel for
 #endif
@@ -75,7 +79,9 @@ void DMCOMP::resetComponents(xmlNodePtr cur)
   {
     if(QMCDriverMode[QMC_UPDATE_MODE])
     {
-      if(UseFastGrad == "yes")
+      if(UseFastGrad == "yes" && CrowdSize>1)
+        Movers[ip] = new CrowdUpdatePbyP(wCrowdClones[ip],psiCrowdClones[ip],hCrowdClones[ip],*Rng[ip],CrowdSize,true);
+      else if(UseFastGrad == "yes")
         Movers[ip] = new DMCUpdatePbyPWithRejectionFast(*wClones[ip],*psiClones[ip],*hClones[ip],*Rng[ip]);
       else
         Movers[ip] = new DMCUpdatePbyPWithRejection(*wClones[ip],*psiClones[ip],*hClones[ip],*Rng[ip]);
@@ -127,12 +133,16 @@ void DMCOMP::resetUpdateEngines()
         o << " using fast gradient version ";
       else
         o << " using full-ratio version ";
+      if(QMCDriverMode[QMC_UPDATE_MODE] && UseFastGrad == "yes" && CrowdSize>1)
+        o << "\n  Walkers are moved in crowds of " << CrowdSize;
       if(KillNodeCrossing)
         o << "\n  Walkers are killed when a node crossing is detected";
       else
         o << "\n  DMC moves are rejected when a node crossing is detected";
       app_log() << o.str() << endl;
     }
+    if(CrowdSize>1 && QMCDriverMode[QMC_UPDATE_MODE] && UseFastGrad == "yes")
+      makeCrowdClones(CrowdSize);
 #if !defined(BGP_BUG)
     #pragma omp parallel for
 #endif
@@ -145,7 +155,9 @@ void DMCOMP::resetUpdateEngines()
       branchClones[ip] = new BranchEngineType(*branchEngine);
       if(QMCDriverMode[QMC_UPDATE_MODE])
       {
-        if(UseFastGrad == "yes")
+        if(UseFastGrad == "yes" && CrowdSize>1)
+          Movers[ip] = new CrowdUpdatePbyP(wCrowdClones[ip],psiCrowdClones[ip],hCrowdClones[ip],*Rng[ip],CrowdSize,true);
+        else if(UseFastGrad == "yes")
           Movers[ip] = new DMCUpdatePbyPWithRejectionFast(*wClones[ip],*psiClones[ip],*hClones[ip],*Rng[ip]);
         else
           Movers[ip] = new DMCUpdatePbyPWithRejection(*wClones[ip],*psiClones[ip],*hClones[ip],*Rng[ip]);
@@ -205,9 +217,12 @@ bool DMCOMP::run()
   resetUpdateEngines();
   //estimator does not need to collect data
   Estimators->setCollectionMode(true);
+  Estimators->setTargetStop(true);
   Estimators->start(nBlocks);
   for(int ip=0; ip<NumThreads; ip++)
     Movers[ip]->startRun(nBlocks,false);
+  //the duplicates made by branching copy their buffers in the parallel region
+  W.deferBufferCopy(true);
   Timer myclock;
   IndexType block = 0;
   IndexType updatePeriod=(QMCDriverMode[QMC_UPDATE_MODE])?Period4CheckProperties:(nBlocks+1)*nSteps;
@@ -229,6 +244,8 @@ bool DMCOMP::run()
         int now=CurrentStep;
         MCWalkerConfiguration::iterator
         wit(W.begin()+wPerNode[ip]), wit_end(W.begin()+wPerNode[ip+1]);
+        W.syncBuffers(wit,wit_end);
+        #pragma omp barrier
         for(int interval = 0; interval<BranchInterval-1; ++interval,++now)
           Movers[ip]->advanceWalkers(wit,wit_end,false);
         wClones[ip]->resetCollectables();
@@ -261,8 +278,11 @@ bool DMCOMP::run()
         *(RandomNumberControl::Children[ip])=*(Rng[ip]);
     }
     recordBlock(block);
+    W.reportWalkerPool(block);
   }
-  while(block<nBlocks && myclock.elapsed()<MaxCPUSecs);
+  while(block<nBlocks && myclock.elapsed()<MaxCPUSecs && !Estimators->targetReached());
+  W.syncBuffers(W.begin(),W.end());
+  W.deferBufferCopy(false);
   //for(int ip=0; ip<NumThreads; ip++) Movers[ip]->stopRun();
   for(int ip=0; ip<NumThreads; ip++)
     *(RandomNumberControl::Children[ip])=*(Rng[ip]);
@@ -54,11 +54,13 @@ DMCUpdatePbyPWithRejectionFast::~DMCUpdatePbyPWithRejectionFast() { }
 void DMCUpdatePbyPWithRejectionFast::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end
     , bool measure)
 {
+  nextRandomStep();
   myTimers[0]->start();
   for(; it != it_end; ++it)
   {
     //MCWalkerConfiguration::WalkerData_t& w_buffer = *(W.DataSet[iwalker]);
     Walker_t& thisWalker(**it);
+    setRandomStream(RandomGen,thisWalker);
     Walker_t::Buffer_t& w_buffer(thisWalker.DataSet);
     W.loadWalker(thisWalker,true);
     //W.R = thisWalker.R;
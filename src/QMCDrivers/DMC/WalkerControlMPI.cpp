@@ -121,14 +121,7 @@ WalkerControlMPI::branch(int iter, MCWalkerConfiguration& W, RealType trigger)
   //  swapWalkersSimple(W);
   //  //swapWalkersMap(W);
   //}
-  //set Weight and Multiplicity to default values
-  MCWalkerConfiguration::iterator it(W.begin()),it_end(W.end());
-  while(it != it_end)
-  {
-    (*it)->Weight= 1.0;
-    (*it)->Multiplicity=1.0;
-    ++it;
-  }
+  resetWalkers(W);
   //update the global number of walkers and offsets
   W.setGlobalNumWalkers(Cur_pop);
   W.setWalkerOffsets(FairOffSet);
@@ -203,7 +196,7 @@ void WalkerControlMPI::swapWalkersSimple(MCWalkerConfiguration& W)
     {
       OOMPI_Packed recvBuffer(wRef.byteSize(),myComm->getComm());
       myComm->getComm()[plus[ic]].Recv(recvBuffer);
-      Walker_t *awalker= new Walker_t(wRef);
+      Walker_t *awalker= W.newWalker(wRef,true);
       awalker->getMessage(recvBuffer);
       newW.push_back(awalker);
     }
@@ -327,7 +320,7 @@ void WalkerControlMPI::swapWalkersAsync(MCWalkerConfiguration& W)
       requests[ip].Wait();
       for(int cs = 0; cs < sendCounts[ip]; ++cs)
       {
-        Walker_t *awalker= new Walker_t(wRef);
+        Walker_t *awalker= W.newWalker(wRef,true);
         awalker->getMessage(*(recvBuffers[ip]));
         newW.push_back(awalker);
       }
@@ -384,7 +377,7 @@ void WalkerControlMPI::swapWalkersBlocked(MCWalkerConfiguration& W)
     myComm->getComm()[MyContext-1].Recv(recvBuffer);
     while(dn)
     {
-      Walker_t *awalker= new Walker_t(wRef);
+      Walker_t *awalker= W.newWalker(wRef,true);
       awalker->getMessage(recvBuffer);
       newW.push_back(awalker);
       --dn;
@@ -434,7 +427,7 @@ void WalkerControlMPI::swapWalkersBlocked(MCWalkerConfiguration& W)
       int dn=toRight;
       while(dn)
       {
-        Walker_t *awalker= new Walker_t(wRef);
+        Walker_t *awalker= W.newWalker(wRef,true);
         awalker->getMessage(recvBuffer);
         newW.push_back(awalker);
         --dn;
@@ -519,7 +512,7 @@ void WalkerControlMPI::swapWalkersMap(MCWalkerConfiguration& W)
       int last = W.getActiveWalkers();
       while(dnw)
       {
-        Walker_t *awalker= new Walker_t(wRef);
+        Walker_t *awalker= W.newWalker(wRef,true);
         awalker->getMessage(recvBuffer);
         W.push_back(awalker);
         --dnw;
@@ -81,6 +81,7 @@ void QMCCSLinearOptimizeWFmanagerOMP::resetPsi(bool final_reset)
   Psi.resetParameters(OptVariablesForPsi);
   for (int i=0; i<psiClones.size(); ++i)
     psiClones[i]->resetParameters(OptVariablesForPsi);
+  resetCrowdClones(OptVariablesForPsi);
 //     for (int i=0; i<psiClones.size(); ++i)
 //       psiClones[i]->reportStatus(app_log());
 }
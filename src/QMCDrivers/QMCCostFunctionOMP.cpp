@@ -477,6 +477,7 @@ void QMCCostFunctionOMP::resetPsi(bool final_reset)
   Psi.resetParameters(OptVariablesForPsi);
   for (int i=0; i<psiClones.size(); ++i)
     psiClones[i]->resetParameters(OptVariablesForPsi);
+  resetCrowdClones(OptVariablesForPsi);
 }
 
 QMCCostFunctionOMP::Return_t QMCCostFunctionOMP::correlatedSampling(bool needGrad)
@@ -18,6 +18,8 @@
 #include "Utilities/OhmmsInfo.h"
 #include "Particle/MCWalkerConfiguration.h"
 #include "Particle/HDFWalkerIO.h"
+#include "QMCDrivers/CheckpointWriter.h"
+#include "QMCDrivers/CloneManager.h"
 #include "ParticleBase/ParticleUtility.h"
 #include "ParticleBase/RandomSeqGenerator.h"
 #include "OhmmsData/AttributeSet.h"
@@ -28,18 +30,21 @@
 #include "HDFVersion.h"
 #include <qmc_common.h>
 #include <limits>
+#include <algorithm>
 
 namespace qmcplusplus
 {
 
 QMCDriver::QMCDriver(MCWalkerConfiguration& w, TrialWaveFunction& psi, QMCHamiltonian& h, WaveFunctionPool& ppool)
   : MPIObjectBase(0), branchEngine(0)
-  , W(w), Psi(psi), H(h), psiPool(ppool), Estimators(0), qmcNode(NULL), wOut(0)
+  , W(w), Psi(psi), H(h), psiPool(ppool), Estimators(0), qmcNode(NULL), wOut(0), ckWriter(0)
 {
   //set defaults
   ResetRandom=false;
   AppendRun=false;
   DumpConfig=false;
+  DumpState=false;
+  AsyncCheckpoint=false;
   ConstPopulation=true; //default is a fixed population method
   MyCounter=0;
   //<parameter name=" "> value </parameter>
@@ -48,6 +53,8 @@ QMCDriver::QMCDriver(MCWalkerConfiguration& w, TrialWaveFunction& psi, QMCHamilt
   RollBackBlocks=0;
   m_param.add(RollBackBlocks,"rewind","int");
   Period4CheckPoint=-1;
+  KeepCheckpoints=1;
+  RestoreCheckStride=1;
   storeConfigs=0;
   m_param.add(storeConfigs,"storeConfigs","int");
   m_param.add( storeConfigs,"storeconfigs","int");
@@ -108,6 +115,7 @@ QMCDriver::QMCDriver(MCWalkerConfiguration& w, TrialWaveFunction& psi, QMCHamilt
 
 QMCDriver::~QMCDriver()
 {
+  delete ckWriter;
   delete_iter(Rng.begin(),Rng.end());
 }
 
@@ -161,8 +169,12 @@ void QMCDriver::process(xmlNodePtr cur)
   }
   branchEngine->put(cur);
   Estimators->put(W,H,cur);
+  //only the drivers which check targetReached() enable it in run()
+  Estimators->setTargetStop(false);
   if(wOut==0)
     wOut = new HDFWalkerOutput(W,RootName,myComm);
+  if(DumpConfig && AsyncCheckpoint && ckWriter==0)
+    ckWriter = new CheckpointWriter(W,RootName,myComm,KeepCheckpoints);
   branchEngine->start(RootName);
   branchEngine->write(RootName);
   //use new random seeds
@@ -172,12 +184,62 @@ void QMCDriver::process(xmlNodePtr cur)
     RandomNumberControl::make_seeds();
     ResetRandom=false;
   }
+  if(QMCDriverMode[QMC_UPDATE_MODE])
+    validateRestoredState();
   //flush the ostreams
   OhmmsInfo::flush();
   //increment QMCCounter of the branch engine
   branchEngine->advanceQMCCounter();
 }
 
+void QMCDriver::validateRestoredState()
+{
+  //every CheckStride-th restored walker, all of them by default
+  const int CheckStride=std::max(RestoreCheckStride,1);
+  //the restored buffers carry the roundoff of the particle-by-particle updates
+  const RealType check_tol=std::max(RealType(1e-6),100*numeric_limits<RealType>::epsilon());
+  const RealType buffer_tol=std::max(RealType(1e-5),1e4*numeric_limits<RealType>::epsilon());
+  int nrestored=0, nchecked=0, nbad=0;
+  Buffer_t buf;
+  ParticleSet::ParticlePos_t r_saved(W.R);
+  for(MCWalkerConfiguration::iterator it=W.begin(); it!=W.end(); ++it)
+  {
+    Walker_t& awalker(**it);
+    if(!awalker.StateRestored || (nrestored++)%CheckStride)
+      continue;
+    ++nchecked;
+    W.R=awalker.R;
+    W.update();
+    buf.clear();
+    buf.rewind();
+    Psi.registerData(W,buf);
+    RealType logpsi=Psi.updateBuffer(W,buf,false);
+    bool good=(buf.size() == awalker.DataSet.size())
+              && std::abs(logpsi-awalker.Properties(LOGPSI)) < check_tol*std::max(RealType(1),std::abs(logpsi));
+    for(int iat=0; good && iat<W.getTotalNum(); ++iat)
+      for(int idim=0; idim<OHMMS_DIM; ++idim)
+        good &= std::abs(W.G[iat][idim]-awalker.G[iat][idim]) < check_tol*std::max(RealType(1),std::abs(W.G[iat][idim]));
+    for(int i=0; good && i<buf.size(); ++i)
+      good = std::abs(buf.myData[i]-awalker.DataSet.myData[i]) < buffer_tol*std::max(RealType(1),std::abs(buf.myData[i]));
+    if(!good)
+      ++nbad;
+  }
+  if(nchecked)
+  {
+    W.R=r_saved;
+    W.update();
+  }
+  myComm->allreduce(nbad);
+  if(nbad)
+  {
+    app_warning() << "  The restored buffers of " << nbad << " walkers do not match the wavefunction. They are recomputed." << endl;
+    for(MCWalkerConfiguration::iterator it=W.begin(); it!=W.end(); ++it)
+      (*it)->StateRestored=false;
+  }
+  else if(nrestored)
+    app_log() << "  Using the restored buffers of " << nrestored << " walkers, " << nchecked << " checked" << endl;
+}
+
 void QMCDriver::setStatus(const string& aname, const string& h5name, bool append)
 {
   RootName = aname;
@@ -217,14 +279,17 @@ void QMCDriver::putWalkers(vector<xmlNodePtr>& wset)
     nwoff[ip+1]=nwoff[ip]+nw[ip];
   W.setGlobalNumWalkers(nwoff[np]);
   W.setWalkerOffsets(nwoff);
+  setWalkerID();
 }
 
 void QMCDriver::recordBlock(int block)
 {
   ////first dump the data for restart
-  if(DumpConfig &&block%Period4CheckPoint == 0)
+  if(ckWriter && block%Period4CheckPoint == 0)
+    ckWriter->write(W,DumpState,*branchEngine);
+  else if(DumpConfig &&block%Period4CheckPoint == 0)
   {
-    wOut->dump(W);
+    wOut->dump(W,DumpState);
     branchEngine->write(RootName,true); //save energy_history
     RandomNumberControl::write(RootName,myComm);
 //       if (storeConfigs) wOut->dump( ForwardWalkingHistory);
@@ -240,8 +305,17 @@ bool QMCDriver::finalize(int block, bool dumpwalkers)
 {
   TimerManager.print(myComm);
   TimerManager.reset();
+  //the determinants do not outlive the walker buffers of this driver
+  Psi.setBufferResident(false);
+  CloneManager::releaseWalkerBuffers();
+  //complete the last checkpoint before the final dump
+  delete ckWriter;
+  ckWriter=0;
   if(DumpConfig && dumpwalkers)
-    wOut->dump(W);
+    wOut->dump(W,DumpState);
+  //the buffers restored from a checkpoint are consumed by the first driver
+  for(MCWalkerConfiguration::iterator it=W.begin(); it!=W.end(); ++it)
+    (*it)->StateRestored=false;
   branchEngine->finalize(W);
   RandomNumberControl::write(RootName,myComm);
   delete wOut;
@@ -295,10 +369,40 @@ QMCDriver::addWalkers(int nwalkers)
     nwoff[ip+1]=nwoff[ip]+nw[ip];
   W.setGlobalNumWalkers(nwoff[myComm->size()]);
   W.setWalkerOffsets(nwoff);
+  setWalkerID();
   app_log() << "  Total number of walkers: " << W.EnsembleProperty.NumSamples  <<  endl;
   app_log() << "  Total weight: " << W.EnsembleProperty.Weight  <<  endl;
 }
 
+void QMCDriver::setWalkerID()
+{
+  int np=myComm->size();
+  int ip=myComm->rank();
+  //largest k of the IDs in use on all the nodes
+  vector<long> kmax(np,0);
+  MCWalkerConfiguration::iterator it(W.begin()), it_end(W.end());
+  for(; it != it_end; ++it)
+    kmax[ip]=std::max(kmax[ip],(*it)->ID/np);
+  myComm->allreduce(kmax);
+  long k=*std::max_element(kmax.begin(),kmax.end());
+  for(it=W.begin(); it != it_end; ++it)
+    if((*it)->ID==0)
+    {
+      (*it)->ID=(++k)*np+ip;
+      (*it)->ParentID=(*it)->ID;
+    }
+#if defined(QMC_RNG_PHILOX)
+  vector<long> ids(W.WalkerOffsets[np],0);
+  int iw=W.WalkerOffsets[ip];
+  for(it=W.begin(); it != it_end; ++it)
+    ids[iw++]=(*it)->ID;
+  myComm->allreduce(ids);
+  std::sort(ids.begin(),ids.end());
+  if(std::adjacent_find(ids.begin(),ids.end()) != ids.end())
+    APP_ABORT("QMCDriver::setWalkerID the walker IDs of the random streams are not unique");
+#endif
+}
+
 
 /** Parses the xml input file for parameter definitions for a single qmc simulation.
  *
@@ -308,6 +412,9 @@ QMCDriver::addWalkers(int nwalkers)
  *   -- 1 = do not write anything
  *   -- 0 = dump after the completion of a qmc section
  *   -- n = dump after n blocks
+ * - <checkpoint stride="n" state="yes|no"/> state="yes" dumps the buffers of the walkers, default=no
+ * - <checkpoint stride="n" async="yes|no" keep="m"/> async="yes" writes the checkpoints in the background
+ *   and keeps the last m of them, default=no and m=1
  */
 bool QMCDriver::putQMCInfo(xmlNodePtr cur)
 {
@@ -345,7 +452,19 @@ bool QMCDriver::putQMCInfo(xmlNodePtr cur)
         OhmmsAttributeSet rAttrib;
         rAttrib.add(Period4CheckPoint,"stride");
         rAttrib.add(Period4CheckPoint,"period");
+        string dstate(DumpState?"yes":"no");
+        string dasync(AsyncCheckpoint?"yes":"no");
+        rAttrib.add(dstate,"state");
+        rAttrib.add(dasync,"async");
+        rAttrib.add(KeepCheckpoints,"keep");
+        rAttrib.add(RestoreCheckStride,"check");
         rAttrib.put(tcur);
+        DumpState=(dstate=="yes");
+        AsyncCheckpoint=(dasync=="yes");
+#if !(defined(HAVE_PTHREAD) && defined(H5_HAVE_THREADSAFE))
+        if(AsyncCheckpoint)
+          app_warning() << "  async=\"yes\" needs pthreads and a thread-safe hdf5. The checkpoints are written synchronously." << endl;
+#endif
         //DumpConfig=(Period4CheckPoint>0);
       }
       else if(cname == "dumpconfig")
@@ -436,7 +555,13 @@ bool QMCDriver::putQMCInfo(xmlNodePtr cur)
     app_log() << "  stepsbetweensamples = " << nStepsBetweenSamples << endl;
   
   if(DumpConfig)
+  {
     app_log() << "  DumpConfig==true Configurations are dumped to config.h5 with a period of " << Period4CheckPoint << " blocks" << endl;
+    if(DumpState)
+      app_log() << "  DumpState==true The buffers of the walkers are dumped with the configurations" << endl;
+    if(AsyncCheckpoint)
+      app_log() << "  AsyncCheckpoint==true The checkpoints are written in the background, keeping " << KeepCheckpoints << endl;
+  }
   else
     app_log() << "  DumpConfig==false Nothing (configurations, state) will be saved." << endl;
   if (Period4WalkerDump>0)
@@ -58,6 +58,7 @@ namespace qmcplusplus
 
 class MCWalkerConfiguration;
 class HDFWalkerOutput;
+class CheckpointWriter;
 /** @ingroup QMCDrivers
  * @{
  * @brief abstract base class for QMC engines
@@ -210,6 +211,10 @@ protected:
   bool AppendRun;
   ///flag to turn off dumping configurations
   bool DumpConfig;
+  ///flag to dump the full state of the walkers with the configurations
+  bool DumpState;
+  ///flag to write the checkpoints in the background
+  bool AsyncCheckpoint;
   ///true, if the size of population is fixed.
   bool ConstPopulation;
   /** the number of times this QMCDriver is executed
@@ -226,6 +231,10 @@ protected:
    * The unit is a block.
    */
   int Period4CheckPoint;
+  ///number of the checkpoints to keep with AsyncCheckpoint
+  int KeepCheckpoints;
+  ///every RestoreCheckStride-th restored walker is validated, 1 for all
+  int RestoreCheckStride;
   /** period of dumping walker positions and IDs for Forward Walking
   *
   * The unit is in steps.
@@ -304,6 +313,8 @@ protected:
 
   ///record engine for walkers
   HDFWalkerOutput* wOut;
+  ///background writer of the checkpoints, used if AsyncCheckpoint
+  CheckpointWriter* ckWriter;
   ///walker ensemble
   MCWalkerConfiguration& W;
 
@@ -351,6 +362,24 @@ protected:
 
   void addWalkers(int nwalkers);
 
+  /** assign the IDs of the walkers without one
+   *
+   * The IDs are k*size+rank as by WalkerControlBase with k above those in use
+   * on any node. With QMC_RNG_PHILOX, the IDs key the random streams and
+   * are checked to be unique. WalkerOffsets have to be set.
+   */
+  void setWalkerID();
+
+  /** validate the buffers restored from a checkpoint
+   *
+   * Every RestoreCheckStride-th walker with Walker::StateRestored, set by the check
+   * attribute of checkpoint and all of them by default, is recomputed by Psi
+   * and compared with its restored logpsi, G and buffer element by element. If any
+   * differs on any node, StateRestored is cleared for all the walkers so that the
+   * movers recompute their buffers. Called by process for the particle-by-particle drivers.
+   */
+  void validateRestoredState();
+
   //void updateWalkers();
 
   /** record the state of the block
@@ -18,6 +18,7 @@
 #include "ParticleBase/ParticleUtility.h"
 #include "ParticleBase/RandomSeqGenerator.h"
 #include "QMCDrivers/DriftOperators.h"
+#include "QMCHamiltonians/NonLocalECPotential.h"
 #include "OhmmsData/AttributeSet.h"
 #include "Message/OpenMP.h"
 
@@ -59,7 +60,9 @@ void QMCUpdateBase::setDefaults()
   nSubSteps=1;
   MaxAge=10;
   m_r2max=-1;
+  UseResident="no";
   myParams.add(m_r2max,"maxDisplSq","double"); //maximum displacement
+  myParams.add(UseResident,"resident","string"); //bind the wavefunction to the walker buffers
   //myParams.add(nSubSteps,"subSteps","int");
   //myParams.add(nSubSteps,"substeps","int");
   //myParams.add(nSubSteps,"sub_steps","int");
@@ -87,6 +90,13 @@ void QMCUpdateBase::resetRun(BranchEngineType* brancher, EstimatorManager* est)
   dG.resize(NumPtcl);
   L.resize(NumPtcl);
   dL.resize(NumPtcl);
+  if(UseTMove)
+  {
+    //a block of knots per electron, Txy grows once more for the electrons near several ions
+    NonLocalECPotential* nlpp=dynamic_cast<NonLocalECPotential*>(H.getHamiltonian("NonLocalECP"));
+    if(nlpp)
+      nonLocalOps.reserve(1+NumPtcl*nlpp->maxKnots());
+  }
   ////Tau=brancher->getTau();
   ////m_oneover2tau = 0.5/Tau;
   ////m_sqrttau = std::sqrt(Tau);
@@ -149,6 +159,7 @@ void QMCUpdateBase::initWalkers(WalkerIter_t it, WalkerIter_t it_end)
   UpdatePbyP=false;
   for (; it != it_end; ++it)
   {
+    (*it)->StateRestored=false;
     W.R = (*it)->R;
     W.update();
     RealType logpsi(Psi.evaluateLog(W));
@@ -165,26 +176,44 @@ void QMCUpdateBase::initWalkers(WalkerIter_t it, WalkerIter_t it_end)
 }
 
 
+/** initialize the buffers of the walkers for particle-by-particle moves
+ *
+ * The walkers restored from a checkpoint with their buffers are used as they are,
+ * after the first one and a random subset are recomputed and compared with the
+ * checkpoint. The check is done before any restored buffer is accepted: when a
+ * walker does not match, the buffers of all the walkers are recomputed.
+ */
 void QMCUpdateBase::initWalkersForPbyP(WalkerIter_t it, WalkerIter_t it_end)
 {
   UpdatePbyP=true;
+  Psi.setBufferResident(UseResident=="yes");
+  //the restored buffers are validated by QMCDriver::validateRestoredState
   for (; it != it_end; ++it)
   {
     Walker_t& awalker(**it);
-    W.R=awalker.R;
-    W.update();
-    //W.loadWalker(awalker,UpdatePbyP);
-    if (awalker.DataSet.size())
-      awalker.DataSet.clear();
-    awalker.DataSet.rewind();
-    RealType logpsi=Psi.registerData(W,awalker.DataSet);
-    RealType logpsi2=Psi.updateBuffer(W,awalker.DataSet,false);
-    awalker.G=W.G;
-    awalker.L=W.L;
+    bool restored=awalker.StateRestored;
+    awalker.StateRestored=false;
+    if(restored)
+      continue;
+    resetBuffer(awalker);
     randomize(awalker);
   }
 }
 
+QMCUpdateBase::RealType QMCUpdateBase::resetBuffer(Walker_t& awalker)
+{
+  W.R=awalker.R;
+  W.update();
+  if (awalker.DataSet.size())
+    awalker.DataSet.clear();
+  awalker.DataSet.rewind();
+  Psi.registerData(W,awalker.DataSet);
+  RealType logpsi=Psi.updateBuffer(W,awalker.DataSet,false);
+  awalker.G=W.G;
+  awalker.L=W.L;
+  return logpsi;
+}
+
 /** randomize a walker with a diffusion MC using gradients */
 void QMCUpdateBase::randomize(Walker_t& awalker)
 {
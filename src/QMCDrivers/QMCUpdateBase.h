@@ -216,6 +216,8 @@ protected:
   bool UpdatePbyP;
   ///use T-moves
   bool UseTMove;
+  ///if yes, the wavefunction components work in the walker buffers
+  string UseResident;
   ///number of particles
   IndexType NumPtcl;
   ///Time-step factor \f$ 1/(2\Tau)\f$
@@ -267,6 +269,36 @@ protected:
    */
   void randomize(Walker_t& awalker);
 
+  /** recompute the buffer, G and L of awalker at its positions
+   * @return logpsi
+   */
+  RealType resetBuffer(Walker_t& awalker);
+
+  ///advance the step of the random streams, once per advanceWalkers
+  inline void nextRandomStep()
+  {
+#if defined(QMC_RNG_PHILOX)
+    RandomGen.nextStep();
+#endif
+  }
+
+  /** start the random stream of a walker
+   * @param rng generator of the walker
+   * @param awalker walker
+   *
+   * With QMC_RNG_PHILOX, the numbers of a walker in a step only depend on its
+   * ID, its stream count and the step, not on the thread or the order of the
+   * walkers. The IDs are assigned by QMCDriver::setWalkerID.
+   */
+  inline void setRandomStream(RandomGenerator_t& rng, Walker_t& awalker)
+  {
+#if defined(QMC_RNG_PHILOX)
+    if(awalker.ID==0)
+      APP_ABORT("QMCUpdateBase::setRandomStream the walker has no ID");
+    rng.setStream(RandomGen.currentStep(),awalker.ID,awalker.StreamCount++);
+#endif
+  }
+
 private:
 
   ///set default parameters
@@ -79,6 +79,7 @@ bool RMCSingleOMP::run()
       }
       wClones[ip]->reptile->calcTauScaling();
       wClones[ip]->reptile->calcERun();
+      wClones[ip]->reptile->resetSums();
       //wClones[ip]->reptile->resetR2Avg();
       Movers[ip]->stopBlock(false);
       //  if (block > 2*wClones[ip]->reptile->nbeads){
@@ -224,6 +225,7 @@ void RMCSingleOMP::resetRun()
         currentbead.Properties(wClones[ip]->reptile->TransProb[1])=0.0;
       }
     }
+    wClones[ip]->reptile->resetSums();
     /*
         while(wit!=wit_end)
         {
@@ -257,7 +259,12 @@ void RMCSingleOMP::resetRun()
 bool
 RMCSingleOMP::put(xmlNodePtr q)
 {
-  //nothing to add
+  //the beads keep no buffer: RMCUpdatePbyP rebuilds the head in its own buffer
+  if(DumpState)
+  {
+    app_error() << "  <checkpoint state=\"yes\"/> is not supported by rmc: the beads of a reptile have no buffer." << endl;
+    APP_ABORT("RMCSingleOMP::put");
+  }
   return true;
 }
 }
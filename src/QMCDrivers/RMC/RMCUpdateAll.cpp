@@ -144,6 +144,7 @@ void RMCUpdateAllWithDrift::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end,
     H.auxHevaluate(W,overwriteWalker);
     H.saveProperty(overwriteWalker.getPropertyBase());
     overwriteWalker.Age=0;
+    W.reptile->addHead();
     ++nAccept;
   }
   else
@@ -53,9 +53,10 @@ void RMCUpdatePbyPWithDrift::initWalkersForPbyP(WalkerIter_t it, WalkerIter_t it
     //W.loadWalker(awalker,UpdatePbyP);
     if (awalker.DataSet.size())
       awalker.DataSet.clear();
-    awalker.DataSet.rewind();
-    RealType logpsi=Psi.registerData(W,awalker.DataSet);
-    RealType logpsi2=Psi.updateBuffer(W,awalker.DataSet,false);
+    if (headBuffer.size())
+      headBuffer.clear();
+    headBuffer.rewind();
+    RealType logpsi=Psi.registerData(W,headBuffer);
     awalker.G=W.G;
     awalker.L=W.L;
   }
@@ -67,16 +68,16 @@ void RMCUpdatePbyPWithDrift::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end
   IndexType forward =(1-direction)/2;
   IndexType backward=(1+direction)/2;
   Walker_t& curhead=W.reptile->getHead();
-  Walker_t::Buffer_t& w_buffer(curhead.DataSet);
+  Walker_t::Buffer_t& w_buffer(headBuffer);
   W.loadWalker(curhead, true);
   W.R=curhead.R;
   W.update();
   //W.loadWalker(awalker,UpdatePbyP);
-  if (curhead.DataSet.size())
-    curhead.DataSet.clear();
-  curhead.DataSet.rewind();
-  RealType logpsi=Psi.registerData(W,curhead.DataSet);
-  RealType logpsi2=Psi.updateBuffer(W,curhead.DataSet,false);
+  if (headBuffer.size())
+    headBuffer.clear();
+  headBuffer.rewind();
+  RealType logpsi=Psi.registerData(W,headBuffer);
+  RealType logpsi2=Psi.updateBuffer(W,headBuffer,false);
   // curhead.G=W.G;
   //  curhead.L=W.L;
   // Walker_t& thisWalker(**it);
@@ -367,9 +368,8 @@ void RMCUpdatePbyPWithDrift::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end
     MCWalkerConfiguration::Walker_t& overwriteWalker(W.reptile->getNewHead());
     if (curhead.Age>=MaxAge)
       app_log()<<"\tForce Acceptance...\n";
-    Walker_t::Buffer_t& o_buffer(overwriteWalker.DataSet);
     overwriteWalker.R = W.R;
-    RealType logpsi = Psi.updateBuffer(W,o_buffer,false);
+    RealType logpsi = Psi.updateBuffer(W,w_buffer,false);
     W.saveWalker(overwriteWalker);
     overwriteWalker.Properties(LOCALENERGY)=eloc;
     overwriteWalker.Properties(W.reptile->Action[forward])=0;
@@ -381,6 +381,7 @@ void RMCUpdatePbyPWithDrift::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end
     H.auxHevaluate(W,overwriteWalker);
     H.saveProperty(overwriteWalker.getPropertyBase());
     overwriteWalker.Age=0;
+    W.reptile->addHead();
     W.reptile->accumulateE(eloc);
     ++nAccept;
   }
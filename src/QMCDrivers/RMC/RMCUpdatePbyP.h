@@ -27,6 +27,8 @@ private:
     return *this;
   }
   std::vector<int> Action, TransProb;
+  ///buffer of the head, rebuilt at each move: the beads do not keep buffers
+  Walker_t::Buffer_t headBuffer;
 };
 
 
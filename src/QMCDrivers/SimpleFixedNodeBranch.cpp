@@ -290,7 +290,8 @@ void SimpleFixedNodeBranch::branch(int iter, MCWalkerConfiguration& walkers)
         BackupWalkerController=0;
         vParam[B_ETRIAL]=vParam[B_EREF];
         app_log()  << "  Etrial     = " << vParam[B_ETRIAL] << endl;
-        WalkerController->start();
+        //continue the IDs created by the warmup controller
+        WalkerController->setWalkerID(walkers);
       }
       //This is not necessary
       //EnergyHist(DMCEnergyHist.mean());
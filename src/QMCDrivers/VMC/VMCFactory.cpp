@@ -16,13 +16,13 @@
 // -*- C++ -*-
 #include "QMCDrivers/VMC/VMCFactory.h"
 #include "QMCDrivers/VMC/VMCSingleOMP.h"
+#include "QMCDrivers/CorrelatedSampling/CSVMC.h"
 #if defined(QMC_BUILD_COMPLETE)
 //REMOVE Broken warping
 //#if !defined(QMC_COMPLEX)
 //#include "QMCDrivers/VMC/VMCMultipleWarp.h"
 //#include "QMCDrivers/VMC/VMCPbyPMultiWarp.h"
 //#endif
-#include "QMCDrivers/CorrelatedSampling/CSVMC.h"
 #endif
 #include "Message/OpenMP.h"
 
@@ -48,6 +48,10 @@ QMCDriver* VMCFactory::create(MCWalkerConfiguration& w, TrialWaveFunction& psi,
     {
       qmc = new VMCSingleOMP(w,psi,h,hpool,ppool);
     }
+    else if(VMCMode == 2 || VMCMode == 3) //(0,1,0) (0,1,1)
+    {
+      qmc = new CSVMC(w,psi,h,ppool);
+    }
 #if defined(QMC_BUILD_COMPLETE)
   //else if(VMCMode == 2) //(0,1,0)
   //{
@@ -57,10 +61,6 @@ QMCDriver* VMCFactory::create(MCWalkerConfiguration& w, TrialWaveFunction& psi,
   //{
   //  qmc = new VMCPbyPMultiple(w,psi,h);
   //}
-//    else if(VMCMode ==2 || VMCMode ==3)
-//    {
-//      qmc = new CSVMC(w,psi,h);
-//    }
 //#if !defined(QMC_COMPLEX)
 //    else if(VMCMode == 6) //(1,1,0)
 //    {
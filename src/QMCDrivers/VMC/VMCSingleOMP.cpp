@@ -17,6 +17,7 @@
 #include "QMCDrivers/VMC/VMCSingleOMP.h"
 #include "QMCDrivers/VMC/VMCUpdatePbyP.h"
 #include "QMCDrivers/VMC/VMCUpdateAll.h"
+#include "QMCDrivers/CrowdUpdatePbyP.h"
 #include "OhmmsApp/RandomNumberControl.h"
 #include "Message/OpenMP.h"
 #include "Message/CommOperators.h"
@@ -39,12 +40,14 @@ VMCSingleOMP::VMCSingleOMP(MCWalkerConfiguration& w, TrialWaveFunction& psi, QMC
   m_param.add(UseDrift,"useDrift","string");
   m_param.add(UseDrift,"usedrift","string");
   m_param.add(UseDrift,"use_drift","string");
+  m_param.add(CrowdSize,"crowd","int");
 }
 
 bool VMCSingleOMP::run()
 {
   resetRun();
   //start the main estimator
+  Estimators->setTargetStop(true);
   Estimators->start(nBlocks);
   for (int ip=0; ip<NumThreads; ++ip)
     Movers[ip]->startRun(nBlocks,false);
@@ -89,6 +92,8 @@ bool VMCSingleOMP::run()
     //why was this commented out? Are checkpoints stored some other way?
     if(storeConfigs)
       recordBlock(block);
+    if(Estimators->targetReached())
+      break;
   }//block
   hpmStop(QMC_VMC_0_EVENT);
   Estimators->stop(estimatorClones);
@@ -113,6 +118,13 @@ void VMCSingleOMP::resetRun()
   if(nTargetPopulation>0)
     branchEngine->iParam[SimpleFixedNodeBranch::B_TARGETWALKERS]=static_cast<int>(std::ceil(nTargetPopulation));
   makeClones(W,Psi,H);
+  if(CrowdSize>1 && QMCDriverMode[QMC_UPDATE_MODE])
+  {
+    if(UseDrift == "yes")
+      makeCrowdClones(CrowdSize);
+    else
+      app_warning() << "  VMCSingleOMP crowd=" << CrowdSize << " requires usedrift=yes. Walkers are moved one by one." << endl;
+  }
 
   FairDivideLow(W.getActiveWalkers(),NumThreads,wPerNode);
   app_log() << "  Initial partition of walkers ";
@@ -160,7 +172,12 @@ void VMCSingleOMP::resetRun()
         //               // Movers[ip]=new VMCUpdatePbyPWithDrift(*wClones[ip],*psiClones[ip],*hClones[ip],*Rng[ip]);
         //             }
         //             else
-        if (UseDrift == "yes")
+        if (UseDrift == "yes" && CrowdSize>1)
+        {
+          os <<"  PbyP moves with drift in crowds of " << CrowdSize << " walkers, using CrowdUpdatePbyP"<<endl;
+          Movers[ip]=new CrowdUpdatePbyP(wCrowdClones[ip],psiCrowdClones[ip],hCrowdClones[ip],*Rng[ip],CrowdSize,false);
+        }
+        else if (UseDrift == "yes")
         {
           os <<"  PbyP moves with drift, using VMCUpdatePbyPWithDriftFast"<<endl;
           Movers[ip]=new VMCUpdatePbyPWithDriftFast(*wClones[ip],*psiClones[ip],*hClones[ip],*Rng[ip]);
@@ -47,10 +47,12 @@ VMCUpdatePbyP::~VMCUpdatePbyP()
 
 void VMCUpdatePbyP::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool measure)
 {
+  nextRandomStep();
   myTimers[0]->start();
   for (; it != it_end; ++it)
   {
     Walker_t& thisWalker(**it);
+    setRandomStream(RandomGen,thisWalker);
     W.loadWalker(thisWalker,true);
     Walker_t::Buffer_t& w_buffer(thisWalker.DataSet);
     Psi.copyFromBuffer(W,w_buffer);
@@ -387,10 +389,12 @@ VMCUpdatePbyPWithDrift::~VMCUpdatePbyPWithDrift()
 
 void VMCUpdatePbyPWithDrift::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool measure)
 {
+  nextRandomStep();
   myTimers[0]->start();
   for (; it != it_end; ++it)
   {
     Walker_t& thisWalker(**it);
+    setRandomStream(RandomGen,thisWalker);
     W.loadWalker(thisWalker,true);
     Walker_t::Buffer_t& w_buffer(thisWalker.DataSet);
     Psi.copyFromBuffer(W,thisWalker.DataSet);
@@ -636,10 +640,12 @@ VMCUpdatePbyPWithDriftFast::RealType VMCUpdatePbyPWithDriftFast::advanceWalkerFo
 
 void VMCUpdatePbyPWithDriftFast::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool measure)
 {
+  nextRandomStep();
   myTimers[0]->start();
   for (; it != it_end; ++it)
   {
     Walker_t& thisWalker(**it);
+    setRandomStream(RandomGen,thisWalker);
     Walker_t::Buffer_t& w_buffer(thisWalker.DataSet);
     W.loadWalker(thisWalker,true);
     //W.R = thisWalker.R;
@@ -754,11 +760,13 @@ VMCUpdateRenyiWithDriftFast::~VMCUpdateRenyiWithDriftFast()
 
 void VMCUpdateRenyiWithDriftFast::advanceWalkers(WalkerIter_t it, WalkerIter_t it_end, bool measure)
 {
+  nextRandomStep();
   myTimers[0]->start();
   WalkerIter_t begin(it);
   for (; it != it_end; ++it)
   {
     Walker_t& thisWalker(**it);
+    setRandomStream(RandomGen,thisWalker);
     Walker_t::Buffer_t& w_buffer(thisWalker.DataSet);
     W.loadWalker(thisWalker,true);
     Psi.copyFromBuffer(W,w_buffer);
@@ -17,6 +17,8 @@
 #include "QMCDrivers/WalkerControlBase.h"
 #include "Particle/HDFWalkerIO.h"
 #include "OhmmsData/ParameterSet.h"
+#include "Message/OpenMP.h"
+#include "Utilities/UtilityFunctions.h"
 
 namespace qmcplusplus
 {
@@ -99,7 +101,14 @@ void WalkerControlBase::setWalkerID(MCWalkerConfiguration& walkers)
   start(); //do the normal start
   MCWalkerConfiguration::iterator wit(walkers.begin());
   MCWalkerConfiguration::iterator wit_end(walkers.end());
+  //new IDs are above those in use on all the contexts, e.g. assigned by QMCDriver
+  vector<long> kmax(NumContexts,0);
   for(; wit != wit_end; ++wit)
+    kmax[MyContext]=std::max(kmax[MyContext],(*wit)->ID/NumContexts);
+  myComm->allreduce(kmax);
+  NumWalkersCreated=std::max(NumWalkersCreated,
+                             static_cast<IndexType>(*std::max_element(kmax.begin(),kmax.end())));
+  for(wit=walkers.begin(); wit != wit_end; ++wit)
   {
     if((*wit)->ID==0)
     {
@@ -239,19 +248,27 @@ int WalkerControlBase::branch(int iter, MCWalkerConfiguration& W, RealType trigg
   //accumData[WALKERSIZE_INDEX] += curData[WALKERSIZE_INDEX];
   //accumData[WEIGHT_INDEX]     += curData[WEIGHT_INDEX];
   int nw_tot = copyWalkers(W);
-  //set Weight and Multiplicity to default values
-  MCWalkerConfiguration::iterator it(W.begin()),it_end(W.end());
-  while(it != it_end)
-  {
-    (*it)->Weight= 1.0;
-    (*it)->Multiplicity=1.0;
-    ++it;
-  }
+  resetWalkers(W);
   //set the global number of walkers
   W.setGlobalNumWalkers(nw_tot);
   return nw_tot;
 }
 
+void WalkerControlBase::resetWalkers(MCWalkerConfiguration& W)
+{
+  bool sync=!W.bufferCopyDeferred();
+  int nw=W.getActiveWalkers();
+  #pragma omp parallel for
+  for(int iw=0; iw<nw; ++iw)
+  {
+    //set Weight and Multiplicity to default values
+    W[iw]->Weight= 1.0;
+    W[iw]->Multiplicity=1.0;
+    if(sync)
+      W[iw]->syncBuffer();
+  }
+}
+
 void Write2XYZ(MCWalkerConfiguration& W)
 {
   ofstream fout("bad.xyz");
@@ -274,102 +291,40 @@ void Write2XYZ(MCWalkerConfiguration& W)
  */
 int WalkerControlBase::sortWalkers(MCWalkerConfiguration& W)
 {
-  MCWalkerConfiguration::iterator it(W.begin());
-  vector<Walker_t*> bad,good_rn;
+  vector<Walker_t*> good_rn;
   vector<int> ncopy_rn;
-  NumWalkers=0;
-  MCWalkerConfiguration::iterator it_end(W.end());
-  RealType esum=0.0,e2sum=0.0,wsum=0.0,ecum=0.0, w2sum=0.0, besum=0.0, bwgtsum=0.0;
-  RealType r2_accepted=0.0,r2_proposed=0.0;
-  int nfn(0),nrn(0),ngoodfn(0),ncr(0),nc(0);
-  while(it != it_end)
+  #pragma omp parallel
   {
-    bool inFN=(((*it)->ReleasedNodeAge)==0);
-    nc= std::min(static_cast<int>((*it)->Multiplicity),MaxCopy);
-    if(WriteRN)
+    #pragma omp single
     {
-      if ((*it)->ReleasedNodeAge==1)
-        ncr+=1;
-      else
-        if ((*it)->ReleasedNodeAge==0)
-        {
-          nfn+=1;
-          ngoodfn+=nc;
-        }
-      r2_accepted+=(*it)->Properties(R2ACCEPTED);
-      r2_proposed+=(*it)->Properties(R2PROPOSED);
-      RealType e((*it)->Properties(LOCALENERGY));
-      RealType bfe((*it)->Properties(ALTERNATEENERGY));
-      RealType wgt=((*it)->Weight);
-      RealType rnwgt=((*it)->ReleasedNodeWeight);
-      esum += wgt*rnwgt*e;
-      e2sum += wgt*rnwgt*e*e;
-      wsum += rnwgt*wgt;
-      w2sum += rnwgt*rnwgt*wgt*wgt;
-      ecum += e;
-      besum += bfe*wgt;
-      bwgtsum += wgt;
-    }
-    else
-    {
-      if (nc>0)
-        nfn++;
-      else
-        ncr++;
-      r2_accepted+=(*it)->Properties(R2ACCEPTED);
-      r2_proposed+=(*it)->Properties(R2PROPOSED);
-      RealType e((*it)->Properties(LOCALENERGY));
-      RealType wgt=((*it)->Weight);
-      esum += wgt*e;
-      e2sum += wgt*e*e;
-      wsum += wgt;
-      w2sum += wgt*wgt;
-      ecum += e;
+      threadBins.resize(omp_get_num_threads());
+      FairDivideLow(W.getActiveWalkers(),threadBins.size(),wPerThread);
     }
-    if((nc) && (inFN))
-    {
-      NumWalkers += nc;
-      good_w.push_back(*it);
-      ncopy_w.push_back(nc-1);
-    }
-    else
-      if (nc)
-      {
-        NumWalkers += nc;
-        nrn+=nc;
-        good_rn.push_back(*it);
-        ncopy_rn.push_back(nc-1);
-      }
-      else
-      {
-        bad.push_back(*it);
-      }
-    ++it;
+    int ip=omp_get_thread_num();
+    sortWalkers(W.begin()+wPerThread[ip],W.begin()+wPerThread[ip+1],threadBins[ip]);
   }
   //temp is an array to perform reduction operations
   std::fill(curData.begin(),curData.end(),0);
-  //update curData
-  curData[ENERGY_INDEX]=esum;
-  curData[ENERGY_SQ_INDEX]=e2sum;
+  NumWalkers=0;
+  vector<Walker_t*> bad;
+  //merge the bins in the thread order
+  for(int ip=0; ip<threadBins.size(); ++ip)
+  {
+    WalkerBins& bins(threadBins[ip]);
+    for(int i=0; i<LE_MAX; ++i)
+      curData[i]+=bins.sums[i];
+    NumWalkers+=bins.nw;
+    good_w.insert(good_w.end(),bins.good.begin(),bins.good.end());
+    ncopy_w.insert(ncopy_w.end(),bins.ncopy.begin(),bins.ncopy.end());
+    good_rn.insert(good_rn.end(),bins.good_rn.begin(),bins.good_rn.end());
+    ncopy_rn.insert(ncopy_rn.end(),bins.ncopy_rn.begin(),bins.ncopy_rn.end());
+    bad.insert(bad.end(),bins.bad.begin(),bins.bad.end());
+  }
+  int nrn=static_cast<int>(curData[RNSIZE_INDEX]);
   curData[WALKERSIZE_INDEX]=W.getActiveWalkers();
-  curData[WEIGHT_INDEX]=wsum;
-  curData[EREF_INDEX]=ecum;
-  curData[R2ACCEPTED_INDEX]=r2_accepted;
-  curData[R2PROPOSED_INDEX]=r2_proposed;
   curData[FNSIZE_INDEX]=static_cast<RealType>(good_w.size());
-  curData[RNONESIZE_INDEX]=static_cast<RealType>(ncr);
-  curData[RNSIZE_INDEX]=nrn;
-  curData[B_ENERGY_INDEX]=besum;
-  curData[B_WGT_INDEX]=bwgtsum;
-  ////this should be move
-  //W.EnsembleProperty.NumSamples=curData[WALKERSIZE_INDEX];
-  //W.EnsembleProperty.Weight=curData[WEIGHT_INDEX];
-  //W.EnsembleProperty.Energy=(esum/=wsum);
-  //W.EnsembleProperty.Variance=(e2sum/wsum-esum*esum);
-  //W.EnsembleProperty.Variance=(e2sum*wsum-esum*esum)/(wsum*wsum-w2sum);
   //remove bad walkers empty the container
-  for(int i=0; i<bad.size(); i++)
-    delete bad[i];
+  W.recycleWalkers(bad);
   if (!WriteRN)
   {
     if(good_w.empty())
@@ -417,36 +372,137 @@ int WalkerControlBase::sortWalkers(MCWalkerConfiguration& W)
   }
   else
   {
-    it=good_rn.begin();
-    it_end=good_rn.end();
-    int indy(0);
-    while(it!=it_end)
+    good_w.insert(good_w.end(),good_rn.begin(),good_rn.end());
+    ncopy_w.insert(ncopy_w.end(),ncopy_rn.begin(),ncopy_rn.end());
+  }
+  return NumWalkers;
+}
+
+void WalkerControlBase::sortWalkers(MCWalkerConfiguration::iterator it, MCWalkerConfiguration::iterator it_end
+                                    , WalkerBins& bins)
+{
+  bins.sums.assign(LE_MAX,0.0);
+  bins.nw=0;
+  bins.good.clear();
+  bins.good_rn.clear();
+  bins.bad.clear();
+  bins.ncopy.clear();
+  bins.ncopy_rn.clear();
+  RealType esum=0.0,e2sum=0.0,wsum=0.0,ecum=0.0, besum=0.0, bwgtsum=0.0;
+  RealType r2_accepted=0.0,r2_proposed=0.0;
+  int nrn(0),ncr(0),nc(0);
+  while(it != it_end)
+  {
+    bool inFN=(((*it)->ReleasedNodeAge)==0);
+    nc= std::min(static_cast<int>((*it)->Multiplicity),MaxCopy);
+    if(WriteRN)
+    {
+      if ((*it)->ReleasedNodeAge==1)
+        ncr+=1;
+      r2_accepted+=(*it)->Properties(R2ACCEPTED);
+      r2_proposed+=(*it)->Properties(R2PROPOSED);
+      RealType e((*it)->Properties(LOCALENERGY));
+      RealType bfe((*it)->Properties(ALTERNATEENERGY));
+      RealType wgt=((*it)->Weight);
+      RealType rnwgt=((*it)->ReleasedNodeWeight);
+      esum += wgt*rnwgt*e;
+      e2sum += wgt*rnwgt*e*e;
+      wsum += rnwgt*wgt;
+      ecum += e;
+      besum += bfe*wgt;
+      bwgtsum += wgt;
+    }
+    else
+    {
+      if (nc==0)
+        ncr++;
+      r2_accepted+=(*it)->Properties(R2ACCEPTED);
+      r2_proposed+=(*it)->Properties(R2PROPOSED);
+      RealType e((*it)->Properties(LOCALENERGY));
+      RealType wgt=((*it)->Weight);
+      esum += wgt*e;
+      e2sum += wgt*e*e;
+      wsum += wgt;
+      ecum += e;
+    }
+    if((nc) && (inFN))
     {
-      good_w.push_back(*it);
-      ncopy_w.push_back(ncopy_rn[indy]);
-      it++,indy++;
+      bins.nw += nc;
+      bins.good.push_back(*it);
+      bins.ncopy.push_back(nc-1);
     }
+    else
+      if (nc)
+      {
+        bins.nw += nc;
+        nrn+=nc;
+        bins.good_rn.push_back(*it);
+        bins.ncopy_rn.push_back(nc-1);
+      }
+      else
+      {
+        bins.bad.push_back(*it);
+      }
+    ++it;
   }
-  return NumWalkers;
+  bins.sums[ENERGY_INDEX]=esum;
+  bins.sums[ENERGY_SQ_INDEX]=e2sum;
+  bins.sums[WEIGHT_INDEX]=wsum;
+  bins.sums[EREF_INDEX]=ecum;
+  bins.sums[R2ACCEPTED_INDEX]=r2_accepted;
+  bins.sums[R2PROPOSED_INDEX]=r2_proposed;
+  bins.sums[RNONESIZE_INDEX]=static_cast<RealType>(ncr);
+  bins.sums[RNSIZE_INDEX]=nrn;
+  bins.sums[B_ENERGY_INDEX]=besum;
+  bins.sums[B_WGT_INDEX]=bwgtsum;
 }
 
 int WalkerControlBase::copyWalkers(MCWalkerConfiguration& W)
 {
+#if defined(QMC_CUDA)
   //clear the WalkerList to populate them with the good walkers
   W.clear();
   W.insert(W.begin(), good_w.begin(), good_w.end());
-  int cur_walker = good_w.size();
   for(int i=0; i<good_w.size(); i++)
-    //,ie+=ncols) {
   {
-    for(int j=0; j<ncopy_w[i]; j++, cur_walker++)
+    for(int j=0; j<ncopy_w[i]; j++)
     {
-      Walker_t* awalker=new Walker_t(*(good_w[i]));
+      Walker_t* awalker=W.newWalker(*(good_w[i]),true);
       awalker->ID=(++NumWalkersCreated)*NumContexts+MyContext;
       awalker->ParentID=good_w[i]->ParentID;
       W.push_back(awalker);
     }
   }
+#else
+  //the good walkers are followed by the copies in the order of good_w
+  vector<int> parent;
+  for(int i=0; i<good_w.size(); i++)
+    parent.insert(parent.end(),ncopy_w[i],i);
+  int ncopies=parent.size();
+  vector<Walker_t*> newlist(good_w);
+  vector<Walker_t*> pool;
+  W.takeFreeWalkers(ncopies,pool);
+  newlist.insert(newlist.end(),pool.begin(),pool.end());
+  Walker_t** restrict copies=(ncopies)?&newlist[good_w.size()]:0;
+  #pragma omp parallel
+  {
+    #pragma omp single
+    FairDivideLow(ncopies,omp_get_num_threads(),wPerThread);
+    int ip=omp_get_thread_num();
+    for(int k=wPerThread[ip]; k<wPerThread[ip+1]; ++k)
+    {
+      const Walker_t& source(*good_w[parent[k]]);
+      if(copies[k]==0)
+        copies[k]=new Walker_t(source.size());
+      copies[k]->makeDuplicate(source);
+      copies[k]->ID=(NumWalkersCreated+k+1)*NumContexts+MyContext;
+      copies[k]->ParentID=source.ParentID;
+    }
+  }
+  NumWalkersCreated+=ncopies;
+  W.clear();
+  W.insert(W.begin(),newlist.begin(),newlist.end());
+#endif
   //clear good_w and ncopy_w for the next branch
   good_w.clear();
   ncopy_w.clear();
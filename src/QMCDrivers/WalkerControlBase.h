@@ -126,6 +126,30 @@ public:
   ///Add released-node fields to .dmc.dat file
   bool WriteRN;
 
+  /** walkers of a thread sorted by sortWalkers
+   */
+  struct WalkerBins
+  {
+    ///partial sums of curData
+    vector<RealType> sums;
+    ///number of walkers after branching
+    int nw;
+    ///walkers in the fixed-node region with copies
+    vector<Walker_t*> good;
+    ///released-node walkers with copies
+    vector<Walker_t*> good_rn;
+    ///walkers to be removed
+    vector<Walker_t*> bad;
+    ///copy counters of good
+    vector<int> ncopy;
+    ///copy counters of good_rn
+    vector<int> ncopy_rn;
+  };
+  ///bins of the threads
+  vector<WalkerBins> threadBins;
+  ///ranges of the walkers or the copies of the threads
+  vector<int> wPerThread;
+
   /** default constructor
    *
    * Set the SwapMode to zero so that instantiation can be done
@@ -184,11 +208,26 @@ public:
   int doNotBranch(int iter, MCWalkerConfiguration& W);
 
   /** sort Walkers between good and bad and prepare branching
+   *
+   * Each thread sorts its range of the walkers. The bins of the threads are
+   * merged in the thread order, so that the order of the walkers is the same
+   * as with one thread.
    */
   int sortWalkers(MCWalkerConfiguration& W);
   /** copy good walkers to W
+   *
+   * The duplicates are made by the threads at the positions and with the IDs
+   * fixed by the copy counters.
    */
   int copyWalkers(MCWalkerConfiguration& W);
+  /** set the weights of the walkers to one after branching
+   *
+   * The buffers of the duplicates are copied by the threads unless deferred.
+   */
+  void resetWalkers(MCWalkerConfiguration& W);
+  /** sort the walkers [first,last) into bins
+   */
+  void sortWalkers(MCWalkerConfiguration::iterator first, MCWalkerConfiguration::iterator last, WalkerBins& bins);
 
   /** reset to accumulate data */
   virtual void reset();
@@ -96,7 +96,7 @@ CoulombPBCAATemp::registerData(ParticleSet& P, BufferType& buffer)
     P.SK->DoUpdate=true;
     SR2.resize(NumCenters,NumCenters);
     dSR.resize(NumCenters);
-    del_eikr.resize(P.SK->KLists.numk);
+    zrhok.resize(P.SK->KLists.numk);
     Value=evaluateForPbyP(P);
     buffer.add(SR2.begin(),SR2.end());
     buffer.add(Value);
@@ -178,19 +178,21 @@ CoulombPBCAATemp::evaluatePbyP(ParticleSet& P, int active)
 #if defined(USE_REAL_STRUCT_FACTOR)
     APP_ABORT("CoulombPBCAATemp::evaluatePbyP");
 #else
-    const StructFact& PtclRhoK(*(P.SK));
-    const ComplexType* restrict eikr_new=PtclRhoK.eikr_temp.data();
-    const ComplexType* restrict eikr_old=PtclRhoK.eikr[active];
-    ComplexType* restrict d_ptr=del_eikr.data();
-    for(int k=0; k<del_eikr.size(); ++k)
-      *d_ptr++ = (*eikr_new++ - *eikr_old++);
-    int spec2=SpeciesID[active];
+    //sum_k F_k del_k (sum_s Z_s rho^s_k + z del_k) with a single pass over F_k
+    StructFact& PtclRhoK(*(P.SK));
+    const int nk=zrhok.size();
+    const ComplexType* restrict d_ptr=PtclRhoK.getDeltaEikr().data();
+    ComplexType* restrict z_ptr=zrhok.data();
+    for(int k=0; k<nk; ++k)
+      z_ptr[k] = z*d_ptr[k];
     for(int spec1=0; spec1<NumSpecies; ++spec1)
     {
-      Return_t zz=z*Zspec[spec1];
-      sr += zz*AA->evaluate(PtclRhoK.KLists.kshell,PtclRhoK.rhok[spec1],del_eikr.data());
+      const RealType zs=Zspec[spec1];
+      const ComplexType* restrict rhok_ptr=PtclRhoK.rhok[spec1];
+      for(int k=0; k<nk; ++k)
+        z_ptr[k] += zs*rhok_ptr[k];
     }
-    sr+= z*z*AA->evaluate(PtclRhoK.KLists.kshell,del_eikr.data(),del_eikr.data());
+    sr += z*AA->evaluate(PtclRhoK.KLists.kshell,zrhok.data(),d_ptr);
     //// const StructFact& PtclRhoK(*(PtclRef->SK));
     //const StructFact& PtclRhoK(*(P.SK));
     //const ComplexType* restrict eikr_new=PtclRhoK.eikr_temp.data();
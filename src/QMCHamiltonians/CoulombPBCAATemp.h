@@ -53,7 +53,8 @@ struct CoulombPBCAATemp: public QMCHamiltonianBase, public ForceBase
 
   Matrix<RealType> SR2;
   Vector<RealType> dSR;
-  Vector<ComplexType> del_eikr;
+  ///charge-weighted rhok and the change of rhok for evaluatePbyP
+  Vector<ComplexType> zrhok;
   /// Flag for whether to compute forces or not
   bool ComputeForces;
 //     madelung constant
@@ -391,9 +391,10 @@ CoulombPBCABTemp::evaluatePbyP(ParticleSet& P, int active)
   LRtmp=0.0;
   const StructFact& RhoKA(*(PtclA.SK));
   //const StructFact& RhoKB(*(PtclB->SK));
-  const StructFact& RhoKB(*(P.SK));
+  StructFact& RhoKB(*(P.SK));
+  const ComplexType* restrict eikr_new=RhoKB.getEikrTemp().data();
   for(int i=0; i<NumSpeciesA; i++)
-    LRtmp+=Zspec[i]*q*AB->evaluate(RhoKA.KLists.kshell, RhoKA.rhok[i],RhoKB.eikr_temp.data());
+    LRtmp+=Zspec[i]*q*AB->evaluate(RhoKA.KLists.kshell, RhoKA.rhok[i],eikr_new);
 #endif
   return NewValue=Value+(SRtmp-SRpart[active])+(LRtmp-LRpart[active]);
   //return NewValue=Value+(SRtmp-SRpart[active]);
@@ -53,10 +53,12 @@ bool ECPotentialBuilder::put(xmlNodePtr cur)
   string ecpFormat("table");
   string pbc("yes");
   string forces("no");
+  RealType vcut=0.0;
   OhmmsAttributeSet pAttrib;
   pAttrib.add(ecpFormat,"format");
   pAttrib.add(pbc,"pbc");
   pAttrib.add(forces,"forces");
+  pAttrib.add(vcut,"vcut");
   pAttrib.put(cur);
   bool doForces = (forces == "yes") || (forces == "true");
   //const xmlChar* t=xmlGetProp(cur,(const xmlChar*)"format");
@@ -142,6 +144,8 @@ bool ECPotentialBuilder::put(xmlNodePtr cur)
       {
         rc2=std::max(rc2,nonLocalPot[i]->Rmax);
         nknot_max=std::max(nknot_max,nonLocalPot[i]->nknot);
+        nonLocalPot[i]->VradCutoff=vcut;
+        nonLocalPot[i]->fuseChannels();
         apot->add(i,nonLocalPot[i]);
       }
     }
@@ -22,6 +22,7 @@ namespace qmcplusplus
 
 NonLocalECPComponent::NonLocalECPComponent():
   lmax(0), nchannel(0), nknot(0), Rmax(-1), myRNG(&Random)
+  , FusedChannels(false), VradCutoff(0.0)
 { }
 
 NonLocalECPComponent::~NonLocalECPComponent()
@@ -49,6 +50,7 @@ void NonLocalECPComponent::resize_warrays(int n,int m,int l)
 {
   app_log() << "  NonLocalECPComponent::resize_warrays " << endl;
   psiratio.resize(n);
+  deltaV.resize(n);
   psigrad.resize(n);
   psigrad_source.resize(n);
   vrad.resize(m);
@@ -73,6 +75,109 @@ void NonLocalECPComponent::resize_warrays(int n,int m,int l)
       Lfactor2[nl]=1.0e0/static_cast<RealType>(nl+1);
     }
   }
+  knotZ.resize(n);
+  knotP0.resize(n);
+  knotP1.resize(n);
+  knotSum.resize(n);
+  vradL.resize(lmax+1);
+}
+
+void NonLocalECPComponent::fuseChannels()
+{
+  FusedChannels=false;
+  if(nchannel<2)
+    return;
+  RadialPotentialType& v0(*nlpp_m[0]);
+  const int ng=v0.m_Y.size();
+  for(int ip=1; ip<nchannel; ip++)
+  {
+    RadialPotentialType& v(*nlpp_m[ip]);
+    if(v.m_Y.size()!=ng || v.m_grid->size()!=v0.m_grid->size()
+        || v.r_min!=v0.r_min || v.r_max!=v0.r_max)
+      return;
+    if(v.m_grid!=v0.m_grid)
+      for(int i=0; i<v0.m_grid->size(); i++)
+        if(v.m_grid->r(i)!=v0.m_grid->r(i))
+          return;
+  }
+  fusedY.resize(ng,nchannel);
+  fusedY2.resize(ng,nchannel);
+  for(int ip=0; ip<nchannel; ip++)
+  {
+    RadialPotentialType& v(*nlpp_m[ip]);
+    for(int i=0; i<ng; i++)
+    {
+      fusedY(i,ip)=v.m_Y[i]*wgt_angpp_m[ip];
+      fusedY2(i,ip)=v.m_Y2[i]*wgt_angpp_m[ip];
+    }
+  }
+  FusedChannels=true;
+  app_log() << "    Fused " << nchannel << " non-local channels on a grid of " << ng << " points" << endl;
+}
+
+bool NonLocalECPComponent::evaluateVrad(RealType r)
+{
+  RadialPotentialType& v0(*nlpp_m[0]);
+  if(FusedChannels && r>=v0.r_min && r<v0.r_max)
+  {
+    //one lookup on the shared grid for all the channels
+    GridType& agrid(*v0.m_grid);
+    agrid.updateSecondOrder(r,false);
+    int Loc=agrid.currentIndex();
+    const RealType* restrict y1=fusedY[Loc];
+    const RealType* restrict y2=fusedY[Loc+1];
+    const RealType* restrict d2y1=fusedY2[Loc];
+    const RealType* restrict d2y2=fusedY2[Loc+1];
+    for(int ip=0; ip<nchannel; ip++)
+      vrad[ip]=agrid.cubicInterpolateSecond(y1[ip],y2[ip],d2y1[ip],d2y2[ip]);
+  }
+  else
+  {
+    for(int ip=0; ip< nchannel; ip++)
+      vrad[ip]=nlpp_m[ip]->splint(r)*wgt_angpp_m[ip];
+  }
+  for(int ip=0; ip<nchannel; ip++)
+    if(std::abs(vrad[ip])>VradCutoff)
+      return true;
+  return false;
+}
+
+void NonLocalECPComponent::evaluateKnotSums(const PosType& dr, RealType rinv)
+{
+  const int nl=vradL.size();
+  std::fill(vradL.begin(),vradL.end(),0.0);
+  for(int ip=0; ip<nchannel; ip++)
+    vradL[angpp_m[ip]]+=vrad[ip];
+  RealType* restrict z=&knotZ[0];
+  RealType* restrict p0=&knotP0[0];
+  RealType* restrict p1=&knotP1[0];
+  RealType* restrict lsum=&knotSum[0];
+  for(int j=0; j<nknot; j++)
+    z[j]=dot(dr,rrotsgrid_m[j])*rinv;
+  //P_0=1 and P_1=z
+  const RealType v0=vradL[0];
+  const RealType v1=(nl>1)? vradL[1]:0.0;
+  for(int j=0; j<nknot; j++)
+  {
+    p0[j]=1.0;
+    p1[j]=z[j];
+    lsum[j]=v0+v1*z[j];
+  }
+  //P_{l+1}=((2l+1) z P_l - l P_{l-1})/(l+1)
+  for(int l=1; l+1<nl; l++)
+  {
+    const RealType f1=Lfactor1[l];
+    const RealType f2=Lfactor2[l];
+    const RealType fl=static_cast<RealType>(l);
+    const RealType vl=vradL[l+1];
+    for(int j=0; j<nknot; j++)
+    {
+      RealType p=f2*(f1*z[j]*p1[j]-fl*p0[j]);
+      p0[j]=p1[j];
+      p1[j]=p;
+      lsum[j]+=vl*p;
+    }
+  }
 }
 
 void NonLocalECPComponent::print(std::ostream& os)
@@ -99,75 +204,25 @@ NonLocalECPComponent::RealType
 NonLocalECPComponent::evaluate(ParticleSet& W, int iat, TrialWaveFunction& psi)
 {
   RealType esum=0.0;
-  vector<PosType> deltarV(nknot);
   for(int nn=myTable->M[iat],iel=0; nn<myTable->M[iat+1]; nn++,iel++)
   {
     register RealType r(myTable->r(nn));
     if(r>Rmax)
       continue;
+    // Compute radial potential, skip the ratios if it is negligible
+    if(!evaluateVrad(r))
+      continue;
     register RealType rinv(myTable->rinv(nn));
     register PosType  dr(myTable->dr(nn));
-    // Compute ratio of wave functions
     for (int j=0; j < nknot ; j++)
-    {
-      PosType deltar(r*rrotsgrid_m[j]-dr);
-      W.makeMoveOnSphere(iel,deltar);
-#if defined(QMC_COMPLEX)
-      psiratio[j]=psi.ratio(W,iel)*sgridweight_m[j]*std::cos(psi.getPhaseDiff());
-#else
-      psiratio[j]=psi.ratio(W,iel)*sgridweight_m[j];
-#endif
-      W.rejectMove(iel);
-      psi.resetPhaseDiff();
-      //psi.rejectMove(iel);
-    }
-    // Compute radial potential
-    //int k;
-    //RealType rfrac;
-    //nlpp_m[0]->locate(r,k,rfrac);
-    //for(int ip=0;ip< nchannel; ip++){
-    //  vrad[ip]=nlpp_m[ip]->f(k,rfrac)*wgt_angpp_m[ip];
-    //}
-    for(int ip=0; ip< nchannel; ip++)
-      vrad[ip]=nlpp_m[ip]->splint(r)*wgt_angpp_m[ip];
-    // Compute spherical harmonics on grid
-    for (int j=0, jl=0; j<nknot ; j++)
-    {
-      RealType zz=dot(dr,rrotsgrid_m[j])*rinv;
-      // Forming the Legendre polynomials
-      lpol[0]=1.0;
-      RealType lpolprev=0.0;
-      for (int l=0 ; l< lmax ; l++)
-      {
-        //Not a big difference
-        //lpol[l+1]=(2*l+1)*zz*lpol[l]-l*lpolprev;
-        //lpol[l+1]/=(l+1);
-        lpol[l+1]=Lfactor1[l]*zz*lpol[l]-l*lpolprev;
-        lpol[l+1]*=Lfactor2[l];
-        lpolprev=lpol[l];
-      }
-      for(int l=0; l <nchannel; l++,jl++)
-        Amat[jl]=lpol[ angpp_m[l] ];
-    }
-    if(nchannel==1)
-    {
-      esum += vrad[0]*BLAS::dot(nknot, &Amat[0],&psiratio[0]);
-    }
-    else
-    {
-      BLAS::gemv(nknot, nchannel, &Amat[0], &psiratio[0], &wvec[0]);
-      esum += BLAS::dot(nchannel, &vrad[0], &wvec[0]);
-    }
-    ////////////////////////////////////
-    //Original implmentation by S. C.
-    //const char TRANS('T');
-    //const int ione=1;
-    //const RealType one=1.0;
-    //const RealType zero=0.0;
-    //dgemv(TRANS,nknot,nchannel,one,&Amat[0],nknot,&psiratio[0],ione,zero,&wvec[0],ione);
-    //esum += ddot(nchannel,&vrad[0],ione,&wvec[0],ione);
-    ////////////////////////////////////
-    //iel++;
+      deltaV[j]=r*rrotsgrid_m[j]-dr;
+    // Compute the ratios of all the knots of iel
+    psi.NLratios(W,iel,deltaV,psiratio);
+    for (int j=0; j < nknot ; j++)
+      psiratio[j]*=sgridweight_m[j];
+    // Compute the Legendre polynomials of all the knots and channels
+    evaluateKnotSums(dr,rinv);
+    esum += BLAS::dot(nknot, &knotSum[0], &psiratio[0]);
   }   /* end loop over electron */
   return esum;
 }
@@ -557,54 +612,27 @@ NonLocalECPComponent::evaluate(ParticleSet& W, TrialWaveFunction& psi,int iat, v
     register RealType r(myTable->r(nn));
     if(r>Rmax)
       continue;
+    // Compute radial potential, no move of iel if it is negligible
+    if(!evaluateVrad(r))
+      continue;
     register RealType rinv(myTable->rinv(nn));
     register PosType  dr(myTable->dr(nn));
-    int txyCounter=Txy.size();
-    // Compute ratio of wave functions
     for (int j=0; j < nknot ; j++)
+      deltaV[j]=r*rrotsgrid_m[j]-dr;
+    // Compute the ratios of all the knots of iel
+    psi.NLratios(W,iel,deltaV,psiratio);
+    // Compute the Legendre polynomials of all the knots and channels
+    evaluateKnotSums(dr,rinv);
+    //the knots of iel are a block of Txy, kept by its capacity across the walkers
+    int txyCounter=Txy.size();
+    Txy.resize(txyCounter+nknot);
+    for (int j=0; j<nknot ; j++)
     {
-      PosType deltar(r*rrotsgrid_m[j]-dr);
-      W.makeMoveOnSphere(iel,deltar);
-#if defined(QMC_COMPLEX)
-      psiratio[j]=psi.ratio(W,iel)*sgridweight_m[j]*std::cos(psi.getPhaseDiff());
-#else
-      psiratio[j]=psi.ratio(W,iel)*sgridweight_m[j];
-#endif
-      W.rejectMove(iel);
-      psi.resetPhaseDiff();
-      //psi.rejectMove(iel);
-      //first, add a new NonLocalData with ratio
-      Txy.push_back(NonLocalData(iel,psiratio[j],deltar));
-    }
-    // Compute radial potential
-    for(int ip=0; ip< nchannel; ip++)
-    {
-      vrad[ip]=nlpp_m[ip]->splint(r)*wgt_angpp_m[ip];
-    }
-    // Compute spherical harmonics on grid
-    for (int j=0, jl=0; j<nknot ; j++)
-    {
-      RealType zz=dot(dr,rrotsgrid_m[j])*rinv;
-      // Forming the Legendre polynomials
-      lpol[0]=1.0;
-      RealType lpolprev=0.0;
-      for (int l=0 ; l< lmax ; l++)
-      {
-        //Not a big difference
-        //lpol[l+1]=(2*l+1)*zz*lpol[l]-l*lpolprev;
-        //lpol[l+1]/=(l+1);
-        lpol[l+1]=Lfactor1[l]*zz*lpol[l]-l*lpolprev;
-        lpol[l+1]*=Lfactor2[l];
-        lpolprev=lpol[l];
-      }
-      //for(int l=0; l <nchannel; l++,jl++) Amat[jl]=lpol[ angpp_m[l] ];
-      RealType lsum=0;
-      for(int l=0; l <nchannel; l++)
-        lsum += vrad[l]*lpol[ angpp_m[l] ];
-      esum += Txy[txyCounter++].Weight *= lsum;
+      NonLocalData& txy(Txy[txyCounter+j]);
+      txy.PID=iel;
+      txy.Delta=deltaV[j];
+      esum += txy.Weight = psiratio[j]*sgridweight_m[j]*knotSum[j];
     }
-    //BLAS::gemv(nknot, nchannel, &Amat[0], &psiratio[0], &wvec[0]);
-    //esum += BLAS::dot(nchannel, &vrad[0], &wvec[0]);
   }   /* end loop over electron */
   return esum;
 }
@@ -627,17 +655,19 @@ NonLocalECPComponent::evaluate(ParticleSet& W, TrialWaveFunction& psi,int iat,
     register RealType rinv(myTable->rinv(nn));
     register PosType  dr(myTable->dr(nn));
     int txyCounter=Txy.size();
+    Txy.resize(txyCounter+nknot);
     // Compute ratio of wave functions
     for (int j=0; j < nknot ; j++)
     {
-      PosType deltar(r*rrotsgrid_m[j]-dr);
-      W.makeMoveOnSphere(iel,deltar);
+      NonLocalData& txy(Txy[txyCounter+j]);
+      txy.Delta=r*rrotsgrid_m[j]-dr;
+      W.makeMoveOnSphere(iel,txy.Delta);
       psiratio[j]=psi.ratioGrad(W,iel,psigrad[j]) * sgridweight_m[j];
       psigrad[j] *= psiratio[j];
       W.rejectMove(iel);
       psi.rejectMove(iel);
-      //first, add a new NonLocalData with ratio
-      Txy.push_back(NonLocalData(iel,psiratio[j],deltar));
+      txy.PID=iel;
+      txy.Weight=psiratio[j];
     }
     // Compute radial potential
     for(int ip=0; ip< nchannel; ip++)
@@ -66,7 +66,21 @@ struct NonLocalECPComponent: public QMCTraits
   ///Working arrays
   vector<RealType> psiratio,vrad,dvrad,wvec,Amat,dAmat;
   vector<PosType> psigrad, psigrad_source;
+  ///displacements of the knots of an electron
+  vector<PosType> deltaV;
   vector<RealType> lpol, dlpol;
+  ///cosines, Legendre polynomials P_{l-1} and P_l, and angular sums of the knots
+  vector<RealType> knotZ, knotP0, knotP1, knotSum;
+  ///vrad summed by the angular momentum
+  vector<RealType> vradL;
+  ///true if the channels share a grid and vrad is evaluated by one lookup
+  bool FusedChannels;
+  ///the ratios of an electron are skipped if all |vrad| <= VradCutoff
+  RealType VradCutoff;
+  ///values of the channels times wgt_angpp_m on the shared grid, [grid point][channel]
+  Matrix<RealType> fusedY;
+  ///second derivatives of the channels times wgt_angpp_m, [grid point][channel]
+  Matrix<RealType> fusedY2;
 
   // For Pulay correction to the force
   vector<RealType> WarpNorm;
@@ -105,6 +119,26 @@ struct NonLocalECPComponent: public QMCTraits
 
   void resize_warrays(int n,int m,int l);
 
+  /** set fusedY and fusedY2 if the channels are splined on the same grid
+   *
+   * Called once by ECPotentialBuilder when the grids and VradCutoff are final.
+   */
+  void fuseChannels();
+
+  /** evaluate vrad at r
+   * @return false if all |vrad| <= VradCutoff
+   */
+  bool evaluateVrad(RealType r);
+
+  /** evaluate the angular sums of the knots
+   * @param dr displacement from the ion
+   * @param rinv 1/|dr|
+   *
+   * knotSum[j] = \f$\sum_l vrad_l P_{l}(\cos\theta_j)\f$ with the recursion
+   * of the Legendre polynomials over all the knots at once.
+   */
+  void evaluateKnotSums(const PosType& dr, RealType rinv);
+
   void randomize_grid(ParticleSet::ParticlePos_t& sphere, bool randomize);
   template<typename T> void randomize_grid(vector<T> &sphere);
 
@@ -71,6 +71,16 @@ struct NonLocalECPotential: public QMCHamiltonianBase,
 
   void add(int groupID, NonLocalECPComponent* pp);
 
+  ///return the largest number of knots of the components
+  inline int maxKnots() const
+  {
+    int n=0;
+    for(int ig=0; ig<PPset.size(); ++ig)
+      if(PPset[ig])
+        n=std::max(n,PPset[ig]->nknot);
+    return n;
+  }
+
   void setRandomGenerator(RandomGenerator_t* rng);
 
   void addObservables(PropertySetType& plist, BufferType& collectables);
@@ -18,6 +18,7 @@
  */
 #include "QMCHamiltonians/NonLocalTOperator.h"
 #include "OhmmsData/ParameterSet.h"
+#include <algorithm>
 
 namespace qmcplusplus
 {
@@ -44,6 +45,9 @@ bool NonLocalTOperator::put(xmlNodePtr cur)
   bool success = m_param.put(cur);
   plusFactor=Tau*Gamma;
   minusFactor=-Tau*(1.0-Alpha*(1.0+Gamma));
+  //a positive minusFactor makes the weights of the moves with negative ratios negative
+  if(use_tmove=="yes" && Alpha*(1.0+Gamma)>1.0)
+    app_warning() << "  NonLocalTOperator::put alpha*(1+gamma) > 1 gives negative T-move weights." << endl;
   return use_tmove=="yes";
 }
 
@@ -56,58 +60,39 @@ void NonLocalTOperator::reset()
 void NonLocalTOperator::reserve(int n)
 {
   Txy.reserve(n);
+  Wsum.reserve(n);
   Txy.push_back(NonLocalData());
 }
 
 int NonLocalTOperator::selectMove(RealType prob)
 {
-  RealType wgt_t=1.0;
-  for(int i=1; i<Txy.size(); i++)
-  {
-    if(Txy[i].Weight>0)
-    {
-      wgt_t += Txy[i].Weight *=plusFactor;
-    }
-    else
-    {
-      wgt_t += Txy[i].Weight *=minusFactor;
-    }
-  }
-  prob *= wgt_t;
-  RealType wsum=Txy[0].Weight;
-  int ibar=0;;
-  while(wsum<prob)
-  {
-    ibar++;
-    wsum += Txy[ibar].Weight;
-  }
-  return ibar;
+  return selectMove(prob,Txy);
 }
 
 int NonLocalTOperator::selectMove(RealType prob,
                                   vector<NonLocalData> &txy)
 {
-  RealType wgt_t=1.0;
-  for(int i=1; i<txy.size(); i++)
+  const int n=txy.size();
+  Wsum.resize(n);
+  RealType wgt_t=txy[0].Weight;
+  Wsum[0]=wgt_t;
+  bool monotone=true;
+  for(int i=1; i<n; i++)
   {
-    if(txy[i].Weight>0)
-    {
-      wgt_t += txy[i].Weight *=plusFactor;
-    }
-    else
-    {
-      wgt_t += txy[i].Weight *=minusFactor;
-    }
+    RealType w=txy[i].Weight;
+    w *= (w>0)? plusFactor:minusFactor;
+    monotone &= (w>=0);
+    txy[i].Weight=w;
+    Wsum[i]=wgt_t+=w;
   }
   prob *= wgt_t;
-  RealType wsum=txy[0].Weight;
-  int ibar=0;;
-  while(wsum<prob)
-  {
-    ibar++;
-    wsum += txy[ibar].Weight;
-  }
-  return ibar;
+  //the first move with the cumulative weight >= prob, the last one if the rounding leaves all below prob
+  int ibar;
+  if(monotone)
+    ibar=std::lower_bound(Wsum.begin(),Wsum.end(),prob)-Wsum.begin();
+  else
+    for(ibar=0; ibar<n && Wsum[ibar]<prob; ibar++);
+  return std::min(ibar,n-1);
 }
 
 
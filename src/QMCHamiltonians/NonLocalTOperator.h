@@ -40,6 +40,8 @@ struct NonLocalTOperator
   RealType minusFactor;
 
   vector<NonLocalData> Txy;
+  ///cumulative weights of the moves, the capacity is kept across the walkers
+  vector<RealType> Wsum;
 
   NonLocalTOperator();
   inline int size() const
@@ -60,7 +62,10 @@ struct NonLocalTOperator
   /** initialize the parameters */
   bool put(xmlNodePtr cur);
 
-  /** reserve Txy for memory optimization */
+  /** reserve Txy and Wsum for memory optimization
+   *
+   * The capacity is kept by reset(), so the walkers of a mover share the storage.
+   */
   void reserve(int n);
 
   /** reset Txy for a new set of non-local moves
@@ -72,6 +77,10 @@ struct NonLocalTOperator
   /** select the move for a given probability
    * @param prob value [0,1)
    * @return the move index k for \f$\sum_i^K T/\sum_i^N < prob\f$
+   *
+   * The weights are scaled and summed in one pass into Wsum. The move is
+   * found by a binary search of Wsum unless alpha(1+gamma)>1 made some weights
+   * negative, in which case Wsum is not monotone and is scanned.
    */
   int selectMove(RealType prob);
   int selectMove(RealType prob, vector<NonLocalData> &txy);
@@ -140,7 +140,24 @@ struct observable_helper
     a.write(data_id,pname.c_str());
   }
 
-  inline void write(const value_type* first_v, const value_type* first_vv)
+  ///return the number of values of a record
+  inline hsize_t size() const
+  {
+    hsize_t n=1;
+    for(int i=1; i<mydims.size(); ++i)
+      n*=mydims[i];
+    return n;
+  }
+
+  /** append a record
+   * @param first_v starting address of the values
+   * @param first_vv starting address of the squared values
+   * @param owner if false, only extend the datasets
+   *
+   * With a file opened for parallel I/O, every task extends the datasets and
+   * the owner of the observable writes the record.
+   */
+  inline void write(const value_type* first_v, const value_type* first_vv, bool owner=true)
   {
     hsize_t rank=mydims.size();
     if(rank)
@@ -148,15 +165,21 @@ struct observable_helper
       H5Sset_extent_simple(space1_id,rank,&curdims[0],&maxdims[0]);
       H5Sselect_hyperslab(space1_id, H5S_SELECT_SET, &offsets[0], NULL, &mydims[0], NULL);
       H5Dextend(value1_id,&curdims[0]);
-      hid_t memspace = H5Screate_simple(rank, &mydims[0], NULL);
-      herr_t ret = H5Dwrite(value1_id, h5_observable_type, memspace, space1_id, H5P_DEFAULT, first_v+lower_bound);
-      H5Sclose(memspace);
+      if(owner)
+      {
+        hid_t memspace = H5Screate_simple(rank, &mydims[0], NULL);
+        herr_t ret = H5Dwrite(value1_id, h5_observable_type, memspace, space1_id, H5P_DEFAULT, first_v+lower_bound);
+        H5Sclose(memspace);
+      }
       H5Sset_extent_simple(space2_id,rank,&curdims[0],&maxdims[0]);
       H5Sselect_hyperslab(space2_id, H5S_SELECT_SET, &offsets[0], NULL, &mydims[0], NULL);
       H5Dextend(value2_id,&curdims[0]);
-      memspace = H5Screate_simple(rank, &mydims[0], NULL);
-      ret = H5Dwrite(value2_id, h5_observable_type, memspace, space2_id, H5P_DEFAULT, first_vv+lower_bound);
-      H5Sclose(memspace);
+      if(owner)
+      {
+        hid_t memspace = H5Screate_simple(rank, &mydims[0], NULL);
+        herr_t ret = H5Dwrite(value2_id, h5_observable_type, memspace, space2_id, H5P_DEFAULT, first_vv+lower_bound);
+        H5Sclose(memspace);
+      }
       curdims[0]++;
       offsets[0]++;
     }
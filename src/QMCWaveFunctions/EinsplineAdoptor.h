@@ -10,6 +10,7 @@
  * - evaluate_v    value only
  * - evaluate_vgl  vgl
  * - evaluate_vgh  vgh
+ * - evaluate_vgl_crowd  vgl of a crowd of positions, false if not implemented
  * Specializations are implemented  in Spline*Adoptor.h and include
  * - SplineC2RAdoptor<ST,TT,D> : real wavefunction using complex einspline, tiling
  * - SplineC2CAdoptor<ST,TT,D> : complex wavefunction using complex einspline, tiling
@@ -147,6 +148,16 @@ struct SplineAdoptorBase
     kPoints.resize(n);
     MakeTwoCopies.resize(n);
   }
+
+  /** evaluate the values, gradients and laplacians of a crowd of positions with one kernel call
+   * @return false, if the adoptor has no multi-position kernel and BsplineSet evaluates the positions one by one
+   */
+  template<typename VV, typename GV>
+  inline bool evaluate_vgl_crowd(const vector<PointType>& r
+                                 , const vector<VV*>& psi, const vector<GV*>& dpsi, const vector<VV*>& d2psi)
+  {
+    return false;
+  }
 };
 
 /** a class to map a memory sequence to a vector
@@ -192,6 +203,9 @@ struct BsplineSet: public SPOSetBase, public SplineAdoptor
   typedef typename SplineAdoptor::SplineType SplineType;
   typedef typename SplineAdoptor::PointType  PointType;
 
+  ///positions of a crowd
+  vector<PointType> crowdR;
+
   /** default constructor */
   BsplineSet() { }
 
@@ -231,6 +245,36 @@ struct BsplineSet: public SPOSetBase, public SplineAdoptor
     SplineAdoptor::evaluate_vgh(P.R[iat],psi,dpsi,grad_grad_psi);
   }
 
+  ///evaluate the splines at the displaced positions without moving iat
+  inline void evaluateValues(ParticleSet& P, int iat, const vector<PosType>& displs, ValueMatrix_t& psiM)
+  {
+    typedef ValueMatrix_t::value_type value_type;
+    for(int j=0; j<displs.size(); ++j)
+    {
+      const PosType r(P.R[iat]+displs[j]);
+      VectorViewer<value_type> v(psiM[j],OrbitalSetSize);
+      SplineAdoptor::evaluate_v(r,v);
+    }
+  }
+
+  /** evaluate the positions of a crowd of the clones of this set
+   *
+   * The clones share the spline table. The adoptors with a multi-position
+   * kernel, SplineR2RAdoptor and SplineI16Adoptor, evaluate all the positions
+   * in one call. The others evaluate them one by one.
+   */
+  inline void evaluate(const vector<SPOSetBase*>& spos, const vector<ParticleSet*>& P, int iat,
+                       const vector<ValueVector_t*>& psi, const vector<GradVector_t*>& dpsi, const vector<ValueVector_t*>& d2psi)
+  {
+    const int nw=P.size();
+    crowdR.resize(nw);
+    for(int iw=0; iw<nw; ++iw)
+      crowdR[iw]=P[iw]->R[iat];
+    if(!SplineAdoptor::evaluate_vgl_crowd(crowdR,psi,dpsi,d2psi))
+      for(int iw=0; iw<nw; ++iw)
+        SplineAdoptor::evaluate_vgl(crowdR[iw],*psi[iw],*dpsi[iw],*d2psi[iw]);
+  }
+
   void resetParameters(const opt_variables_type& active)
   { }
 
@@ -27,6 +27,8 @@ class Communicate;
 namespace qmcplusplus
 {
 
+struct SharedSplineTable;
+
 // Helper needed for TwistMap
 struct Int3less
 {
@@ -230,6 +232,8 @@ public:
   int MaxNumGvecs;
   RealType MeshFactor;
   RealType BufferLayer;
+  ///node-shared coefficient tables, created with shared_table="yes"
+  SharedSplineTable* SharedTable;
   TinyVector<int,3> MeshSize;
   vector<vector<TinyVector<int,3> > > Gvecs;
 
@@ -21,6 +21,7 @@
 #include "QMCWaveFunctions/EinsplineSetBuilder.h"
 #include "OhmmsData/AttributeSet.h"
 #include "Message/CommOperators.h"
+#include "spline/einspline_shm.hpp"
 
 namespace qmcplusplus
 {
@@ -37,7 +38,7 @@ EinsplineSetBuilder::EinsplineSetBuilder(ParticleSet& p,
     NumBands(0), NumElectrons(0), NumSpins(0), NumTwists(0),
     ParticleSets(psets), TargetPtcl(p), H5FileID(-1),
     Format(QMCPACK), makeRotations(false), MeshFactor(1.0),
-    MeshSize(0,0,0)
+    MeshSize(0,0,0), SharedTable(0)
 {
 //     for (int i=0; i<3; i++) afm_vector[i]=0;
   for (int i=0; i<3; i++)
@@ -50,6 +51,8 @@ EinsplineSetBuilder::~EinsplineSetBuilder()
   DEBUG_MEMORY("EinsplineSetBuilder::~EinsplineSetBuilder");
   if(H5FileID>=0)
     H5Fclose(H5FileID);
+  if(SharedTable)
+    delete SharedTable;
 }
 
 
@@ -17,6 +17,10 @@
 #include "Message/CommOperators.h"
 #include <fftw3.h>
 #include <QMCWaveFunctions/einspline_helper.hpp>
+#include <spline/einspline_util.hpp>
+#include <spline/einspline_shm.hpp>
+#include "Utilities/Timer.h"
+#include "Utilities/UtilityFunctions.h"
 
 namespace qmcplusplus
 {
@@ -25,7 +29,7 @@ void EinsplineSetBuilder::ReadBands_ESHDF(int spin, EinsplineSetExtended<complex
 {
   ReportEngine PRE("EinsplineSetBuilder","ReadBands_ESHDF(EinsplineSetExtended<complex<double > >*");
   Timer c_prep, c_unpack,c_fft, c_phase, c_spline, c_newphase, c_h5, c_init;
-  double t_prep=0.0, t_unpack=0.0, t_fft=0.0, t_phase=0.0, t_spline=0.0, t_newphase=0.0, t_h5=0.0, t_init=0.0;
+  double t_prep=0.0, t_unpack=0.0, t_fft=0.0, t_phase=0.0, t_spline=0.0, t_newphase=0.0, t_h5=0.0, t_init=0.0, t_gather=0.0;
   c_prep.restart();
   bool root = myComm->rank()==0;
   // bcast other stuff
@@ -93,6 +97,14 @@ void EinsplineSetBuilder::ReadBands_ESHDF(int spin, EinsplineSetExtended<complex
   // Create the multiUBspline object
   orbitalSet->MultiSpline =
     create_multi_UBspline_3d_z (x_grid, y_grid, z_grid, xBC, yBC, zBC, NumValenceOrbs);
+  //with a node-shared table, only the first task of each node fills it over fillComm
+  Communicate* fillComm=myComm;
+  if(SharedTable)
+  {
+    SharedTable->attach(orbitalSet->MultiSpline);
+    fillComm=SharedTable->FillComm;
+  }
+  bool filler=(SharedTable == 0 || SharedTable->isFiller());
   //////////////////////////////////////
   // Create the MuffinTin APW splines //
   //////////////////////////////////////
@@ -138,53 +150,99 @@ void EinsplineSetBuilder::ReadBands_ESHDF(int spin, EinsplineSetExtended<complex
   if(havePsig)//perform FFT using FFTW
   {
     c_init.restart();
-    Array<ComplexType,3> FFTbox;
-    FFTbox.resize(MeshSize[0], MeshSize[1], MeshSize[2]);
-    fftw_plan FFTplan = fftw_plan_dft_3d
-                        (MeshSize[0], MeshSize[1], MeshSize[2],
-                         reinterpret_cast<fftw_complex*>(FFTbox.data()),
-                         reinterpret_cast<fftw_complex*>(FFTbox.data()),
-                         +1, FFTW_ESTIMATE);
-    Vector<complex<double> > cG(MaxNumGvecs);
-    //this will be parallelized with OpenMP
-    for(int iorb=0,ival=0; iorb<N; ++iorb, ++ival)
+    //the rank ip transforms the orbitals [OrbGroups[ip],OrbGroups[ip+1]) with the OpenMP threads
+    int np=std::min(N,fillComm->size());
+    vector<int> OrbGroups(np+1,0);
+    FairDivideLow(N,np,OrbGroups);
+    int ip=filler?fillComm->rank():np;
+    int iorb_first=(ip<np)?OrbGroups[ip]:N;
+    int iorb_last=(ip<np)?OrbGroups[ip+1]:N;
+    int ngvecs=Gvecs[0].size();
+    hdf_archive h5f(myComm,false);
+    if(iorb_first<iorb_last)
+      h5f.open(H5FileName,H5F_ACC_RDONLY);
+    bool foundit=true;
+    int nbadg=0;
+    #pragma omp parallel reduction(+:nbadg)
     {
-      //Vector<complex<double> > cG;
-      int ncg=0;
-      int ti=SortBands[iorb].TwistIndex;
-      c_h5.restart();
-      if(root)
+      Timer clock;
+      double my_h5=0.0, my_unpack=0.0, my_fft=0.0, my_phase=0.0, my_spline=0.0;
+      Array<ComplexType,3> FFTbox(MeshSize[0], MeshSize[1], MeshSize[2]);
+      Array<ComplexType,3> splineData(nx,ny,nz);
+      Vector<complex<double> > cG(ngvecs);
+      fftw_plan FFTplan;
+      #pragma omp critical
+      {
+        FFTplan = fftw_plan_dft_3d
+                  (MeshSize[0], MeshSize[1], MeshSize[2],
+                   reinterpret_cast<fftw_complex*>(FFTbox.data()),
+                   reinterpret_cast<fftw_complex*>(FFTbox.data()),
+                   +1, FFTW_ESTIMATE);
+      }
+      //each thread transforms a contiguous block of the orbitals
+      #pragma omp for schedule(static)
+      for(int iorb=iorb_first; iorb<iorb_last; ++iorb)
       {
+        int ti=SortBands[iorb].TwistIndex;
+        clock.restart();
         ostringstream path;
         path << "/electrons/kpoint_" << SortBands[iorb].TwistIndex
              << "/spin_" << spin << "/state_" << SortBands[iorb].BandIndex << "/psi_g";
-        HDFAttribIO<Vector<complex<double> > >  h_cG(cG);
-        h_cG.read (H5FileID, path.str().c_str());
-        ncg=cG.size();
+        //hdf5 is not thread safe
+        #pragma omp critical
+        {
+          foundit &= h5f.read(cG,path.str());
+        }
+        my_h5+= clock.elapsed();
+        if(cG.size() != ngvecs)
+        {
+          nbadg++;
+          continue;
+        }
+        clock.restart();
+        unpack4fftw(cG,Gvecs[0],MeshSize,FFTbox);
+        my_unpack+= clock.elapsed();
+        clock.restart();
+        fftw_execute (FFTplan);
+        my_fft+= clock.elapsed();
+        clock.restart();
+        fix_phase_rotate_c2c(FFTbox,splineData,TwistAngles[ti]);
+        my_phase+= clock.elapsed();
+        clock.restart();
+        set_multi_UBspline_3d_z(orbitalSet->MultiSpline, iorb, splineData.data());
+        my_spline+= clock.elapsed();
       }
-      myComm->bcast(ncg);
-      if(ncg != Gvecs[0].size())
+      #pragma omp critical
       {
-        APP_ABORT("Failed : ncg != Gvecs[0].size()");
+        fftw_destroy_plan(FFTplan);
       }
-      if(!root)
-        cG.resize(ncg);
-      myComm->bcast(cG);
-      t_h5 += c_h5.elapsed();
-      c_unpack.restart();
-      unpack4fftw(cG,Gvecs[0],MeshSize,FFTbox);
-      t_unpack+= c_unpack.elapsed();
-      c_fft.restart();
-      fftw_execute (FFTplan);
-      t_fft+= c_fft.elapsed();
-      c_phase.restart();
-      fix_phase_rotate_c2c(FFTbox,splineData,TwistAngles[ti]);
-      t_phase+= c_phase.elapsed();
-      c_spline.restart();
-      set_multi_UBspline_3d_z(orbitalSet->MultiSpline, ival, splineData.data());
-      t_spline+= c_spline.elapsed();
+      //the threads run concurrently, the master reports its own times
+      #pragma omp master
+      {
+        t_h5+=my_h5;
+        t_unpack+=my_unpack;
+        t_fft+=my_fft;
+        t_phase+=my_phase;
+        t_spline+=my_spline;
+      }
+    }
+    //failed reads and psi_g of a wrong size
+    vector<int> nfailed(2);
+    nfailed[0]=!foundit;
+    nfailed[1]=nbadg;
+    myComm->allreduce(nfailed);
+    if(nfailed[0])
+    {
+      APP_ABORT("EinsplineSetBuilder::ReadBands_ESHDF Failed to read band(s)");
+    }
+    if(nfailed[1])
+    {
+      APP_ABORT("Failed : ncg != Gvecs[0].size()");
     }
-    fftw_destroy_plan(FFTplan);
+    c_spline.restart();
+    if(filler)
+      gather_splines(fillComm, orbitalSet->MultiSpline, OrbGroups);
+    t_gather=c_spline.elapsed();
     t_init+=c_init.elapsed();
   }
   else
@@ -202,16 +260,20 @@ void EinsplineSetBuilder::ReadBands_ESHDF(int spin, EinsplineSetExtended<complex
         h_splineData.read(H5FileID, path.str().c_str());
       }
       myComm->bcast(splineData);
-      set_multi_UBspline_3d_z(orbitalSet->MultiSpline, ival, splineData.data());
+      if(filler)
+        set_multi_UBspline_3d_z(orbitalSet->MultiSpline, ival, splineData.data());
     }
     //return true;
   }
+  if(SharedTable)
+    SharedTable->fence();
   app_log() << "    READBANDS::PREP   = " << t_prep << endl;
   app_log() << "    READBANDS::H5     = " << t_h5 << endl;
   app_log() << "    READBANDS::UNPACK = " << t_unpack << endl;
   app_log() << "    READBANDS::FFT    = " << t_fft << endl;
   app_log() << "    READBANDS::PHASE  = " << t_phase << endl;
   app_log() << "    READBANDS::SPLINE = " << t_spline << endl;
+  app_log() << "    READBANDS::GATHER = " << t_gather << endl;
   app_log() << "    READBANDS::SUM    = " << t_init << endl;
   //now localized orbitals
   for(int iorb=0,ival=0; iorb<N; ++iorb, ++ival)
@@ -288,6 +350,9 @@ void EinsplineSetBuilder::ReadBands_ESHDF(int spin, EinsplineSetExtended<complex
 void EinsplineSetBuilder::ReadBands_ESHDF(int spin, EinsplineSetExtended<double>* orbitalSet)
 {
   ReportEngine PRE("EinsplineSetBuilder","ReadBands_ESHDF(EinsplineSetExtended<double>*");
+  Timer c_prep, c_spline, c_init;
+  double t_prep=0.0, t_unpack=0.0, t_fft=0.0, t_phase=0.0, t_spline=0.0, t_h5=0.0, t_init=0.0, t_gather=0.0;
+  c_prep.restart();
   vector<AtomicOrbital<double> > realOrbs(AtomicOrbitals.size());
   for (int iat=0; iat<realOrbs.size(); iat++)
   {
@@ -399,6 +464,14 @@ void EinsplineSetBuilder::ReadBands_ESHDF(int spin, EinsplineSetExtended<double>
   // Create the multiUBspline object
   orbitalSet->MultiSpline =
     create_multi_UBspline_3d_d (x_grid, y_grid, z_grid, xBC, yBC, zBC, NumValenceOrbs);
+  //with a node-shared table, only the first task of each node fills it over fillComm
+  Communicate* fillComm=myComm;
+  if(SharedTable)
+  {
+    SharedTable->attach(orbitalSet->MultiSpline);
+    fillComm=SharedTable->FillComm;
+  }
+  bool filler=(SharedTable == 0 || SharedTable->isFiller());
   if (HaveOrbDerivs)
   {
     orbitalSet->FirstOrderSplines.resize(IonPos.size());
@@ -437,6 +510,7 @@ void EinsplineSetBuilder::ReadBands_ESHDF(int spin, EinsplineSetExtended<double>
   {
     APP_ABORT("Core states not supported by ES-HDF yet.");
   }
+  t_prep += c_prep.elapsed();
   //this is common
   Array<double,3> splineData(nx,ny,nz);
   if(havePsir)
@@ -459,7 +533,8 @@ void EinsplineSetBuilder::ReadBands_ESHDF(int spin, EinsplineSetExtended<double>
         myComm->bcast(rawData);
         //multiply twist factor and project on the real
         fix_phase_c2r(rawData,splineData,TwistAngles[ti]);
-        set_multi_UBspline_3d_d (orbitalSet->MultiSpline, ival, splineData.data());
+        if(filler)
+          set_multi_UBspline_3d_d (orbitalSet->MultiSpline, ival, splineData.data());
       }
     }
     else
@@ -476,48 +551,119 @@ void EinsplineSetBuilder::ReadBands_ESHDF(int spin, EinsplineSetExtended<double>
           h_splineData.read(H5FileID, path.str().c_str());
         }
         myComm->bcast(splineData);
-        set_multi_UBspline_3d_d (orbitalSet->MultiSpline, ival, splineData.data());
+        if(filler)
+          set_multi_UBspline_3d_d (orbitalSet->MultiSpline, ival, splineData.data());
       }
     }
   }
   else
   {
-    Array<ComplexType,3> FFTbox;
-    FFTbox.resize(MeshSize[0], MeshSize[1], MeshSize[2]);
-    fftw_plan FFTplan = fftw_plan_dft_3d
-                        (MeshSize[0], MeshSize[1], MeshSize[2],
-                         reinterpret_cast<fftw_complex*>(FFTbox.data()),
-                         reinterpret_cast<fftw_complex*>(FFTbox.data()),
-                         +1, FFTW_ESTIMATE);
-    for(int iorb=0,ival=0; iorb<N; ++iorb, ++ival)
+    c_init.restart();
+    //the rank ip transforms the orbitals [OrbGroups[ip],OrbGroups[ip+1]) with the OpenMP threads
+    int np=std::min(N,fillComm->size());
+    vector<int> OrbGroups(np+1,0);
+    FairDivideLow(N,np,OrbGroups);
+    int ip=filler?fillComm->rank():np;
+    int iorb_first=(ip<np)?OrbGroups[ip]:N;
+    int iorb_last=(ip<np)?OrbGroups[ip+1]:N;
+    int ngvecs=Gvecs[0].size();
+    hdf_archive h5f(myComm,false);
+    if(iorb_first<iorb_last)
+      h5f.open(H5FileName,H5F_ACC_RDONLY);
+    bool foundit=true;
+    int nbadg=0;
+    #pragma omp parallel reduction(+:nbadg)
     {
-      Vector<complex<double> > cG;
-      int ncg=0;
-      int ti=SortBands[iorb].TwistIndex;
-      if(root)
+      Timer clock;
+      double my_h5=0.0, my_unpack=0.0, my_fft=0.0, my_phase=0.0, my_spline=0.0;
+      Array<ComplexType,3> FFTbox(MeshSize[0], MeshSize[1], MeshSize[2]);
+      Array<double,3> splineData(nx,ny,nz);
+      Vector<complex<double> > cG(ngvecs);
+      fftw_plan FFTplan;
+      #pragma omp critical
+      {
+        FFTplan = fftw_plan_dft_3d
+                  (MeshSize[0], MeshSize[1], MeshSize[2],
+                   reinterpret_cast<fftw_complex*>(FFTbox.data()),
+                   reinterpret_cast<fftw_complex*>(FFTbox.data()),
+                   +1, FFTW_ESTIMATE);
+      }
+      //each thread transforms a contiguous block of the orbitals
+      #pragma omp for schedule(static)
+      for(int iorb=iorb_first; iorb<iorb_last; ++iorb)
       {
+        int ti=SortBands[iorb].TwistIndex;
+        clock.restart();
         ostringstream path;
         path << "/electrons/kpoint_" << SortBands[iorb].TwistIndex
              << "/spin_" << spin << "/state_" << SortBands[iorb].BandIndex << "/psi_g";
-        HDFAttribIO<Vector<complex<double> > >  h_cG(cG);
-        h_cG.read (H5FileID, path.str().c_str());
-        ncg=cG.size();
+        //hdf5 is not thread safe
+        #pragma omp critical
+        {
+          foundit &= h5f.read(cG,path.str());
+        }
+        my_h5+= clock.elapsed();
+        if(cG.size() != ngvecs)
+        {
+          nbadg++;
+          continue;
+        }
+        clock.restart();
+        unpack4fftw(cG,Gvecs[0],MeshSize,FFTbox);
+        my_unpack+= clock.elapsed();
+        clock.restart();
+        fftw_execute (FFTplan);
+        my_fft+= clock.elapsed();
+        clock.restart();
+        fix_phase_rotate_c2r(FFTbox,splineData,TwistAngles[ti]);
+        my_phase+= clock.elapsed();
+        clock.restart();
+        set_multi_UBspline_3d_d (orbitalSet->MultiSpline, iorb, splineData.data());
+        my_spline+= clock.elapsed();
       }
-      myComm->bcast(ncg);
-      if(ncg != Gvecs[0].size())
+      #pragma omp critical
       {
-        APP_ABORT("Failed : ncg != Gvecs[0].size()");
+        fftw_destroy_plan(FFTplan);
+      }
+      //the threads run concurrently, the master reports its own times
+      #pragma omp master
+      {
+        t_h5+=my_h5;
+        t_unpack+=my_unpack;
+        t_fft+=my_fft;
+        t_phase+=my_phase;
+        t_spline+=my_spline;
       }
-      if(!root)
-        cG.resize(ncg);
-      myComm->bcast(cG);
-      unpack4fftw(cG,Gvecs[0],MeshSize,FFTbox);
-      fftw_execute (FFTplan);
-      fix_phase_rotate_c2r(FFTbox,splineData,TwistAngles[ti]);
-      set_multi_UBspline_3d_d (orbitalSet->MultiSpline, ival, splineData.data());
     }
-    fftw_destroy_plan(FFTplan);
+    //failed reads and psi_g of a wrong size
+    vector<int> nfailed(2);
+    nfailed[0]=!foundit;
+    nfailed[1]=nbadg;
+    myComm->allreduce(nfailed);
+    if(nfailed[0])
+    {
+      APP_ABORT("EinsplineSetBuilder::ReadBands_ESHDF Failed to read band(s)");
+    }
+    if(nfailed[1])
+    {
+      APP_ABORT("Failed : ncg != Gvecs[0].size()");
+    }
+    c_spline.restart();
+    if(filler)
+      gather_splines(fillComm, orbitalSet->MultiSpline, OrbGroups);
+    t_gather=c_spline.elapsed();
+    t_init+=c_init.elapsed();
   }
+  if(SharedTable)
+    SharedTable->fence();
+  app_log() << "    READBANDS::PREP   = " << t_prep << endl;
+  app_log() << "    READBANDS::H5     = " << t_h5 << endl;
+  app_log() << "    READBANDS::UNPACK = " << t_unpack << endl;
+  app_log() << "    READBANDS::FFT    = " << t_fft << endl;
+  app_log() << "    READBANDS::PHASE  = " << t_phase << endl;
+  app_log() << "    READBANDS::SPLINE = " << t_spline << endl;
+  app_log() << "    READBANDS::GATHER = " << t_gather << endl;
+  app_log() << "    READBANDS::SUM    = " << t_init << endl;
   for(int iorb=0,ival=0; iorb<N; ++iorb, ++ival)
   {
     // Read atomic orbital information
@@ -24,9 +24,12 @@
 #include <fftw3.h>
 #include <Utilities/ProgressReportEngine.h>
 #include <QMCWaveFunctions/einspline_helper.hpp>
+#include <spline/einspline_shm.hpp>
+#include <spline/einspline_cache.hpp>
 #include "QMCWaveFunctions/EinsplineAdoptor.h"
 #include "QMCWaveFunctions/SplineC2XAdoptor.h"
 #include "QMCWaveFunctions/SplineR2RAdoptor.h"
+#include "QMCWaveFunctions/SplineI16Adoptor.h"
 #include "QMCWaveFunctions/SplineAdoptorReader.h"
 #include "QMCWaveFunctions/SplineMixedAdoptor.h"
 #include "QMCWaveFunctions/SplineMixedAdoptorReader.h"
@@ -46,6 +49,7 @@ EinsplineSetBuilder::createSPOSet(xmlNodePtr cur)
   string sourceName;
   string spo_prec("double");
   string truncate("no");
+  string shared_table("no");
 #if defined(QMC_CUDA)
   string useGPU="yes";
 #else
@@ -64,10 +68,14 @@ EinsplineSetBuilder::createSPOSet(xmlNodePtr cur)
   attribs.add (spo_prec,   "precision");
   attribs.add (truncate,   "truncate");
   attribs.add (BufferLayer, "buffer");
+  attribs.add (shared_table, "shared_table");
   attribs.put (XMLRoot);
   attribs.add (numOrbs,    "size");
   attribs.add (numOrbs,    "norbs");
   attribs.put (cur);
+  //one copy of the coefficients per node, collective over myComm
+  if(shared_table == "yes" && SharedTable == 0)
+    SharedTable=new SharedSplineTable(myComm);
   ///////////////////////////////////////////////
   // Read occupation information from XML file //
   ///////////////////////////////////////////////
@@ -229,7 +237,8 @@ EinsplineSetBuilder::createSPOSet(xmlNodePtr cur)
   else // Otherwise, use EinsplineSetExtended
   {
     mytimer.restart();
-    bool use_single= (spo_prec == "single" || spo_prec == "float");
+    bool use_int16= (spo_prec == "int16");
+    bool use_single= (spo_prec == "single" || spo_prec == "float" || use_int16);
     if (UseRealOrbitals)
     {
       OccupyBands(spinSet, sortBands);
@@ -238,6 +247,8 @@ EinsplineSetBuilder::createSPOSet(xmlNodePtr cur)
       //if(TargetPtcl.Lattice.SuperCellEnum != SUPERCELL_BULK && truncate=="yes")
       if(truncate=="yes")
       {
+        if(use_int16)
+          app_log() << "  precision=\"int16\" is not implemented for truncated orbitals. Using float." << endl;
         if(use_single)
         {
           if(TargetPtcl.Lattice.SuperCellEnum == SUPERCELL_OPEN)
@@ -261,7 +272,9 @@ EinsplineSetBuilder::createSPOSet(xmlNodePtr cur)
       }
       else
       {
-        if(use_single)
+        if(use_int16)
+          spline_reader= new SplineAdoptorReader<SplineI16Adoptor<float,double,3> >(this);
+        else if(use_single)
           spline_reader= new SplineAdoptorReader<SplineR2RAdoptor<float,double,3> >(this);
       }
       if(spline_reader)
@@ -292,6 +305,10 @@ EinsplineSetBuilder::createSPOSet(xmlNodePtr cur)
       {
         app_log() << "  Truncated orbitals with multiple kpoints are not supported yet!" << endl;
       }
+      if(use_int16)
+      {
+        app_log() << "  precision=\"int16\" is implemented for real orbitals. Using float." << endl;
+      }
       if(use_single)
       {
 #if defined(QMC_COMPLEX)
@@ -29,7 +29,7 @@ namespace qmcplusplus
  *@param first index of the first particle
  */
 DiracDeterminantBase::DiracDeterminantBase(SPOSetBasePtr const &spos, int first):
-  NP(0), Phi(spos), FirstIndex(first)
+  NP(0), Phi(spos), FirstIndex(first), BufferResident(false), TempSynced(true)
   ,UpdateTimer("DiracDeterminantBase::update")
   ,RatioTimer("DiracDeterminantBase::ratio")
   ,InverseTimer("DiracDeterminantBase::inverse")
@@ -182,12 +182,20 @@ DiracDeterminantBase::RealType DiracDeterminantBase::updateBuffer(ParticleSet& P
   }
   UpdateTimer.stop();
   BufferTimer.start();
-  //copy psiM to psiM_temp
-  //psiM_temp=psiM;
-  simd::copy(psiM_temp.data(),psiM.data(),psiM.size());
-  buf.put(psiM.first_address(),psiM.last_address());
-  buf.put(FirstAddressOfdV,LastAddressOfdV);
-  buf.put(d2psiM.first_address(),d2psiM.last_address());
+  if(BufferResident)
+  {
+    bindBuffer(buf,true);
+    TempSynced=false;
+  }
+  else
+  {
+    //copy psiM to psiM_temp
+    //psiM_temp=psiM;
+    simd::copy(psiM_temp.data(),psiM.data(),psiM.size());
+    buf.put(psiM.first_address(),psiM.last_address());
+    buf.put(FirstAddressOfdV,LastAddressOfdV);
+    buf.put(d2psiM.first_address(),d2psiM.last_address());
+  }
   buf.put(myL.first_address(), myL.last_address());
   buf.put(FirstAddressOfG,LastAddressOfG);
   buf.put(LogValue);
@@ -199,26 +207,61 @@ DiracDeterminantBase::RealType DiracDeterminantBase::updateBuffer(ParticleSet& P
 void DiracDeterminantBase::copyFromBuffer(ParticleSet& P, PooledData<RealType>& buf)
 {
   BufferTimer.start();
-  buf.get(psiM.first_address(),psiM.last_address());
-  buf.get(FirstAddressOfdV,LastAddressOfdV);
-  buf.get(d2psiM.first_address(),d2psiM.last_address());
+  if(BufferResident)
+  {
+    //the copies to *_temp are made by ratio(P,iat,dG,dL) when needed
+    bindBuffer(buf,false);
+    TempSynced=false;
+  }
+  else
+  {
+    buf.get(psiM.first_address(),psiM.last_address());
+    buf.get(FirstAddressOfdV,LastAddressOfdV);
+    buf.get(d2psiM.first_address(),d2psiM.last_address());
+    //re-evaluate it for testing
+    //Phi.evaluate(P, FirstIndex, LastIndex, psiM, dpsiM, d2psiM);
+    //CurrentDet = Invert(psiM.data(),NumPtcls,NumOrbitals);
+    //need extra copy for gradient/laplacian calculations without updating it
+    //psiM_temp = psiM;
+    //dpsiM_temp = dpsiM;
+    //d2psiM_temp = d2psiM;
+    simd::copy(psiM_temp.data(),  psiM.data(),  psiM.size());
+    simd::copy(dpsiM_temp.data(), dpsiM.data(), dpsiM.size());
+    simd::copy(d2psiM_temp.data(),d2psiM.data(),d2psiM.size());
+  }
   buf.get(myL.first_address(), myL.last_address());
   buf.get(FirstAddressOfG,LastAddressOfG);
   buf.get(LogValue);
   buf.get(PhaseValue);
-  //re-evaluate it for testing
-  //Phi.evaluate(P, FirstIndex, LastIndex, psiM, dpsiM, d2psiM);
-  //CurrentDet = Invert(psiM.data(),NumPtcls,NumOrbitals);
-  //need extra copy for gradient/laplacian calculations without updating it
-  //psiM_temp = psiM;
-  //dpsiM_temp = dpsiM;
-  //d2psiM_temp = d2psiM;
-  simd::copy(psiM_temp.data(),  psiM.data(),  psiM.size());
-  simd::copy(dpsiM_temp.data(), dpsiM.data(), dpsiM.size());
-  simd::copy(d2psiM_temp.data(),d2psiM.data(),d2psiM.size());
   BufferTimer.stop();
 }
 
+void DiracDeterminantBase::setBufferResident(bool resident)
+{
+  BufferResident=resident;
+  TempSynced=true;
+  if(!resident)
+    detachBuffer();
+}
+
+void DiracDeterminantBase::bindBuffer(PooledData<RealType>& buf, bool keep)
+{
+  ValueType* restrict p=buf.lendReference<ValueType>(psiM.size());
+  GradType* restrict dp=buf.lendReference<GradType>(dpsiM.size());
+  ValueType* restrict d2p=buf.lendReference<ValueType>(d2psiM.size());
+  if(p == psiM.data())
+    return;
+  if(keep)
+  {
+    simd::copy(p,  psiM.data(),  psiM.size());
+    simd::copy(dp, dpsiM.data(), dpsiM.size());
+    simd::copy(d2p,d2psiM.data(),d2psiM.size());
+  }
+  psiM.attachReference(p);
+  dpsiM.attachReference(dp);
+  d2psiM.attachReference(d2p);
+}
+
 /** dump the inverse to the buffer
 */
 void DiracDeterminantBase::dumpToBuffer(ParticleSet& P, PooledData<RealType>& buf)
@@ -252,6 +295,25 @@ DiracDeterminantBase::ValueType DiracDeterminantBase::ratio(ParticleSet& P, int
   return curRatio;
 }
 
+bool DiracDeterminantBase::evaluateRatios(ParticleSet& P, int iat,
+                                          const vector<PosType>& displs, vector<ValueType>& ratios)
+{
+  const int nknot=displs.size();
+  ratios.resize(nknot);
+  if(nknot==0)
+    return true;
+  WorkingIndex = iat-FirstIndex;
+  psiVKnots.resize(nknot,NumOrbitals);
+  SPOVTimer.start();
+  Phi->evaluateValues(P,iat,displs,psiVKnots);
+  SPOVTimer.stop();
+  RatioTimer.start();
+  //ratios[j]=sum_k psiVKnots(j,k) psiM(WorkingIndex,k)
+  BLAS::gemv_trans(nknot,NumOrbitals,psiVKnots.data(),psiM[WorkingIndex],&ratios[0]);
+  RatioTimer.stop();
+  return true;
+}
+
 void DiracDeterminantBase::get_ratios(ParticleSet& P, vector<ValueType>& ratios)
 {
   SPOVTimer.start();
@@ -527,6 +589,39 @@ DiracDeterminantBase::ratioGrad(ParticleSet& P, int iat, GradType& grad_iat)
   ////////////////////////////////////////
 }
 
+void
+DiracDeterminantBase::ratioGrad(const vector<OrbitalBase*>& orbs, const vector<ParticleSet*>& P, int iat,
+                                vector<ValueType>& ratios, vector<GradType>& grads)
+{
+  int nw=orbs.size();
+  vector<SPOSetBase*> spos(nw);
+  vector<ValueVector_t*> psi(nw), d2psi(nw);
+  vector<GradVector_t*> dpsi(nw);
+  for(int iw=0; iw<nw; ++iw)
+  {
+    DiracDeterminantBase* det=static_cast<DiracDeterminantBase*>(orbs[iw]);
+    spos[iw]=&(*det->Phi);
+    psi[iw]=&(det->psiV);
+    dpsi[iw]=&(det->dpsiV);
+    d2psi[iw]=&(det->d2psiV);
+  }
+  SPOVGLTimer.start();
+  Phi->evaluate(spos,P,iat,psi,dpsi,d2psi);
+  SPOVGLTimer.stop();
+  RatioTimer.start();
+  for(int iw=0; iw<nw; ++iw)
+  {
+    DiracDeterminantBase& det=*static_cast<DiracDeterminantBase*>(orbs[iw]);
+    det.WorkingIndex = iat-FirstIndex;
+    det.UpdateMode=ORB_PBYP_PARTIAL;
+    det.curRatio=simd::dot(det.psiM[det.WorkingIndex],det.psiV.data(),NumOrbitals);
+    GradType rv=simd::dot(det.psiM[det.WorkingIndex],det.dpsiV.data(),NumOrbitals);
+    grads[iw] += (1.0/det.curRatio) * rv;
+    ratios[iw]=det.curRatio;
+  }
+  RatioTimer.stop();
+}
+
 /** return the ratio
  * @param P current configuration
  * @param iat particle whose position is moved
@@ -547,6 +642,13 @@ DiracDeterminantBase::ValueType DiracDeterminantBase::ratio(ParticleSet& P, int
   RatioTimer.start();
   WorkingIndex = iat-FirstIndex;
   //psiM_temp = psiM;
+  if(!TempSynced)
+  {
+    simd::copy(psiM_temp.data(),  psiM.data(),  psiM.size());
+    simd::copy(dpsiM_temp.data(), dpsiM.data(), dpsiM.size());
+    simd::copy(d2psiM_temp.data(),d2psiM.data(),d2psiM.size());
+    TempSynced=true;
+  }
   curRatio= DetRatioByRow(psiM_temp, psiV, WorkingIndex);
   RatioTimer.stop();
   if(abs(curRatio)<numeric_limits<RealType>::epsilon())
@@ -601,9 +703,13 @@ void DiracDeterminantBase::acceptMove(ParticleSet& P, int iat)
   {
   case ORB_PBYP_RATIO:
     InverseUpdateByRow(psiM,psiV,workV1,workV2,WorkingIndex,curRatio);
+    if(BufferResident)
+      TempSynced=false;
     break;
   case ORB_PBYP_PARTIAL:
     InverseUpdateByRow(psiM,psiV,workV1,workV2,WorkingIndex,curRatio);
+    if(BufferResident)
+      TempSynced=false;
     //std::copy(dpsiV.begin(),dpsiV.end(),dpsiM[WorkingIndex]);
     //std::copy(d2psiV.begin(),d2psiV.end(),d2psiM[WorkingIndex]);
     simd::copy(dpsiM[WorkingIndex],  dpsiV.data(),  NumOrbitals);
@@ -680,9 +786,14 @@ void DiracDeterminantBase::update(ParticleSet& P,
 DiracDeterminantBase::RealType
 DiracDeterminantBase::evaluateLog(ParticleSet& P, PooledData<RealType>& buf)
 {
-  buf.put(psiM.first_address(),psiM.last_address());
-  buf.put(FirstAddressOfdV,LastAddressOfdV);
-  buf.put(d2psiM.first_address(),d2psiM.last_address());
+  if(BufferResident)
+    bindBuffer(buf,true);
+  else
+  {
+    buf.put(psiM.first_address(),psiM.last_address());
+    buf.put(FirstAddressOfdV,LastAddressOfdV);
+    buf.put(d2psiM.first_address(),d2psiM.last_address());
+  }
   buf.put(myL.first_address(), myL.last_address());
   buf.put(FirstAddressOfG,LastAddressOfG);
   buf.put(LogValue);
@@ -713,6 +824,8 @@ void DiracDeterminantBase::registerDataForDerivatives(ParticleSet& P, PooledData
 
 void DiracDeterminantBase::copyToDerivativeBuffer(ParticleSet& P, PooledData<RealType>& buf)
 {
+  //the derivative buffers hold the matrices of evaluateLog(P,G,L), never a walker buffer
+  detachBuffer();
   if(DerivStorageType==0)
   {
     buf.put(psiM.first_address(),psiM.last_address());
@@ -731,6 +844,7 @@ void DiracDeterminantBase::copyToDerivativeBuffer(ParticleSet& P, PooledData<Rea
 
 void DiracDeterminantBase::copyFromDerivativeBuffer(ParticleSet& P, PooledData<RealType>& buf)
 {
+  detachBuffer();
   if(DerivStorageType==0)
   {
     buf.get(psiM.first_address(),psiM.last_address());
@@ -799,6 +913,10 @@ DiracDeterminantBase::evaluateLog(ParticleSet& P,
                                   ParticleSet::ParticleLaplacian_t& L)
 {
   //      cerr<<"I'm calling evaluate log"<<endl;
+  //evaluate from scratch without touching the walker buffer
+  detachBuffer();
+  if(BufferResident)
+    TempSynced=false;
   SPOVGLTimer.start();
   Phi->evaluate(P, FirstIndex, LastIndex, psiM,dpsiM, d2psiM);
   SPOVGLTimer.stop();
@@ -856,6 +974,7 @@ DiracDeterminantBase* DiracDeterminantBase::makeCopy(SPOSetBasePtr spo) const
 
 DiracDeterminantBase::DiracDeterminantBase(const DiracDeterminantBase& s)
   : OrbitalBase(s), NP(0),Phi(s.Phi),FirstIndex(s.FirstIndex)
+  ,BufferResident(false), TempSynced(true)
   ,UpdateTimer(s.UpdateTimer)
   ,RatioTimer(s.RatioTimer)
   ,InverseTimer(s.InverseTimer)
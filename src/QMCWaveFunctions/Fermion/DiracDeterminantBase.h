@@ -177,6 +177,31 @@ public:
 
   virtual void copyFromBuffer(ParticleSet& P, PooledData<RealType>& buf);
 
+  /** bind psiM, dpsiM and d2psiM to the walker buffer
+   *
+   * If resident, copyFromBuffer points psiM, dpsiM and d2psiM to the walker
+   * buffer and the updates are made in place.
+   */
+  virtual void setBufferResident(bool resident);
+
+  /** bind psiM, dpsiM and d2psiM to buf at the current position
+   * @param buf walker buffer
+   * @param keep if true, copy the current values to buf unless they are bound to it
+   */
+  void bindBuffer(PooledData<RealType>& buf, bool keep);
+
+  /** point psiM, dpsiM and d2psiM back to their own storage
+   *
+   * The elements are not copied: the walker buffer they were bound to may
+   * already be resized or freed.
+   */
+  inline void detachBuffer()
+  {
+    psiM.detachReference();
+    dpsiM.detachReference();
+    d2psiM.detachReference();
+  }
+
   /** dump the inverse to the buffer
    */
   void dumpToBuffer(ParticleSet& P, PooledData<RealType>& buf);
@@ -210,6 +235,12 @@ public:
                           ParticleSet::ParticleLaplacian_t& dL);
 
   virtual ValueType ratioGrad(ParticleSet& P, int iat, GradType& grad_iat);
+  /** ratios and gradients of a crowd of clones of this determinant
+   *
+   * The SPOs of the crowd are evaluated together by SPOSetBase::evaluate.
+   */
+  virtual void ratioGrad(const vector<OrbitalBase*>& orbs, const vector<ParticleSet*>& P, int iat,
+                         vector<ValueType>& ratios, vector<GradType>& grads);
   virtual GradType evalGrad(ParticleSet& P, int iat);
   virtual GradType evalGradSource(ParticleSet &P, ParticleSet &source,
                                   int iat);
@@ -269,6 +300,8 @@ public:
 //       virtual DiracDeterminantBase* makeCopy(ParticleSet& tqp, SPOSetBase* spo) const {return makeCopy(spo); };
 
   virtual void get_ratios(ParticleSet& P, vector<ValueType>& ratios);
+  ///evaluate the SPOs at all the displacements in one call and contract them with the row of iat
+  virtual bool evaluateRatios(ParticleSet& P, int iat, const vector<PosType>& displs, vector<ValueType>& ratios);
   ///total number of particles
   int NP;
   ///number of single-particle orbitals which belong to this Dirac determinant
@@ -307,6 +340,8 @@ public:
 
   /// value of single-particle orbital for particle-by-particle update
   ValueVector_t psiV;
+  /// values of the SPOs at the displacements of evaluateRatios, one row per displacement
+  ValueMatrix_t psiVKnots;
   GradVector_t dpsiV;
   ValueVector_t d2psiV;
   ValueVector_t workV1, workV2;
@@ -316,6 +351,10 @@ public:
   Vector<IndexType> Pivot;
 
   ValueType curRatio,cumRatio;
+  ///true, if psiM, dpsiM and d2psiM are bound to the walker buffer
+  bool BufferResident;
+  ///true, if psiM_temp, dpsiM_temp and d2psiM_temp are the copies of psiM, dpsiM and d2psiM
+  bool TempSynced;
   ValueType *FirstAddressOfG;
   ValueType *LastAddressOfG;
   ValueType *FirstAddressOfdV;
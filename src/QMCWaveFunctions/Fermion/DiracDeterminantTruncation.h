@@ -58,8 +58,16 @@ public:
   void set_truncation(int first, int nel,double &temp_cutoff,double &temp_radius);
   double radius;
   DiracDeterminantBase::ValueType ratio(ParticleSet& P, int iat);
+  ///ratio is specialized, the moves are evaluated one at a time
+  bool evaluateRatios(ParticleSet& P, int iat, const vector<PosType>& displs, vector<ValueType>& ratios)
+  {
+    return false;
+  }
   DiracDeterminantBase::ValueType ratio(ParticleSet& P, int iat,ParticleSet::ParticleGradient_t& dG, ParticleSet::ParticleLaplacian_t& dL);
 
+  ///ratio uses psiM_temp: always copy the walker buffer
+  void setBufferResident(bool resident) {}
+
   void resize(int nel, int morb);
 
   //   void set_iterative(int first,int nel, double &temp_cutoff);
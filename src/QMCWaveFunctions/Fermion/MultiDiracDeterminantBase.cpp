@@ -147,44 +147,49 @@ void MultiDiracDeterminantBase::evaluateForWalkerMove(ParticleSet& P, bool fromS
     ValueType det0 = DetSigns[ReferenceDeterminant]*std::exp(logValueRef)*std::cos(abs(phaseValueRef));
 #endif
     detValues[ReferenceDeterminant] = det0;
-    BuildDotProductsAndCalculateRatios(ReferenceDeterminant,0,detValues,psiMinv,TpsiM,dotProducts,detData,uniquePairs,DetSigns);
+    //table method: all the derivatives are rank-1 corrections to the reference table
+    buildTableTimer.start();
+    BuildDotProductsTable(psiMinv,TpsiM,refDotProducts);
+    buildTableTimer.stop();
+    readMatTimer.start();
+    CalculateRatios(ReferenceDeterminant,detValues,refDotProducts,detData,DetSigns);
+    readMatTimer.stop();
+    const int* restrict occ=&(confgList[ReferenceDeterminant].occup[0]);
     for(int iat=0; iat<NumPtcls; iat++)
     {
-      it = confgList[ReferenceDeterminant].occup.begin();
       GradType gradRatio;
       ValueType ratioLapl = 0.0;
       for(int i=0; i<NumPtcls; i++)
       {
-        gradRatio += psiMinv(i,iat)*dpsiM(iat,*it);
-        ratioLapl += psiMinv(i,iat)*d2psiM(iat,*it);
-        it++;
+        gradRatio += psiMinv(i,iat)*dpsiM(iat,occ[i]);
+        ratioLapl += psiMinv(i,iat)*d2psiM(iat,occ[i]);
+        tableCol[i] = psiMinv(i,iat);
       }
       grads(ReferenceDeterminant,iat) = det0*gradRatio;
       lapls(ReferenceDeterminant,iat) = det0*ratioLapl;
       for(int idim=0; idim<OHMMS_DIM; idim++)
       {
-        dpsiMinv = psiMinv;
-        it = confgList[ReferenceDeterminant].occup.begin();
+        buildTableGradTimer.start();
         for(int i=0; i<NumPtcls; i++)
-          psiV_temp[i] = dpsiM(iat,*(it++))[idim];
-        InverseUpdateByColumn(dpsiMinv,psiV_temp,workV1,workV2,iat,gradRatio[idim]);
-        //MultiDiracDeterminantBase::InverseUpdateByColumn_GRAD(dpsiMinv,dpsiV,workV1,workV2,iat,gradRatio[idim],idim);
+          psiV_temp[i] = dpsiM(iat,occ[i])[idim];
         for(int i=0; i<NumOrbitals; i++)
-          TpsiM(i,iat) = dpsiM(iat,i)[idim];
-        BuildDotProductsAndCalculateRatios(ReferenceDeterminant,iat,grads,dpsiMinv,TpsiM,dotProducts,detData,uniquePairs,DetSigns,idim);
+          tableRow[i] = dpsiM(iat,i)[idim];
+        UpdateDotProducts(refDotProducts,tableCol,psiV_temp,tableRow,1.0/gradRatio[idim],dotProducts,uniquePairs);
+        buildTableGradTimer.stop();
+        readMatGradTimer.start();
+        CalculateRatios(ReferenceDeterminant,iat,grads,dotProducts,detData,DetSigns,idim);
+        readMatGradTimer.stop();
       }
-      dpsiMinv = psiMinv;
-      it = confgList[ReferenceDeterminant].occup.begin();
+      buildTableTimer.start();
       for(int i=0; i<NumPtcls; i++)
-        psiV_temp[i] = d2psiM(iat,*(it++));
-      InverseUpdateByColumn(dpsiMinv,psiV_temp,workV1,workV2,iat,ratioLapl);
-      //MultiDiracDeterminantBase::InverseUpdateByColumn(dpsiMinv,d2psiM,workV1,workV2,iat,ratioLapl,confgList[ReferenceDeterminant].occup.begin());
+        psiV_temp[i] = d2psiM(iat,occ[i]);
       for(int i=0; i<NumOrbitals; i++)
-        TpsiM(i,iat) = d2psiM(iat,i);
-      BuildDotProductsAndCalculateRatios(ReferenceDeterminant,iat,lapls,dpsiMinv,TpsiM,dotProducts,detData,uniquePairs,DetSigns);
-// restore matrix
-      for(int i=0; i<NumOrbitals; i++)
-        TpsiM(i,iat) = psiM(iat,i);
+        tableRow[i] = d2psiM(iat,i);
+      UpdateDotProducts(refDotProducts,tableCol,psiV_temp,tableRow,1.0/ratioLapl,dotProducts,uniquePairs);
+      buildTableTimer.stop();
+      readMatTimer.start();
+      CalculateRatios(ReferenceDeterminant,iat,lapls,dotProducts,detData,DetSigns);
+      readMatTimer.stop();
     }
   } // NumPtcls==1
   psiMinv_temp = psiMinv;
@@ -562,6 +567,9 @@ void MultiDiracDeterminantBase::resize(int nel, int morb)
   lapls.resize(NumDets,nel);
   new_lapls.resize(NumDets,nel);
   dotProducts.resize(morb,morb);
+  refDotProducts.resize(nel,morb);
+  tableCol.resize(nel);
+  tableRow.resize(morb);
   createDetData(confgList[ReferenceDeterminant], detData,uniquePairs,DetSigns);
 }
 
@@ -465,6 +465,90 @@ public:
       }
   */
 
+  /** build the full table with a single GEMM
+   * @param psiinv inverse of the reference matrix, psiinv(i,k)
+   * @param psi orbital values, psi(a,k)
+   * @param table table(i,a) = \f$\sum_k\f$ psiinv(i,k)*psi(a,k), leading dimension psi.rows()
+   */
+  inline void BuildDotProductsTable(ValueMatrix_t& psiinv, ValueMatrix_t& psi, ValueMatrix_t& table)
+  {
+    int nel=psiinv.rows();
+    int norb=psi.rows();
+    BLAS::gemm('T','N',norb,nel,nel,ValueType(1.0),psi.data(),nel,psiinv.data(),nel,ValueType(0.0),table.data(),norb);
+  }
+
+  /** fill dotProducts for the unique pairs by a rank-1 correction to the reference table
+   * @param table reference table built by BuildDotProductsTable
+   * @param cvec column of the reference inverse of the electron, cvec[i]=psiinv(i,iat)
+   * @param gvec new row of the electron for the occupied orbitals of the reference
+   * @param rvec new row of the electron for all the orbitals; overwritten by the correction
+   * @param scale 1/ratio of the new reference determinant
+   *
+   * Replacing the row of an electron by gvec/rvec changes the table to
+   * table(i,a)+scale*cvec[i]*(rvec[a]-\f$\sum_k\f$ gvec[k]*table(k,a)),
+   * which avoids the inverse update and the full rebuild of the table.
+   */
+  inline void UpdateDotProducts(ValueMatrix_t& table, ValueVector_t& cvec, ValueVector_t& gvec, ValueVector_t& rvec
+                                , ValueType scale, ValueMatrix_t& dotProducts, vector<pair<int,int> >& pairs)
+  {
+    int nel=gvec.size();
+    int norb=rvec.size();
+    BLAS::gemv('N',norb,nel,ValueType(-1.0),table.data(),norb,gvec.data(),1,ValueType(1.0),rvec.data(),1);
+    for(int a=0; a<norb; a++)
+      rvec[a]*=scale;
+    vector<pair<int,int> >::iterator it(pairs.begin()), last(pairs.end());
+    while(it != last)
+    {
+      dotProducts((*it).first,(*it).second) = table((*it).first,(*it).second)+cvec[(*it).first]*rvec[(*it).second];
+      it++;
+    }
+  }
+
+  inline void CalculateRatios(int ref, ValueVector_t& ratios, ValueMatrix_t& dotProducts, vector<int>& data, vector<double>& sign)
+  {
+    ValueType det0 = ratios[ref];
+    vector<int>::iterator it2 = data.begin();
+    int count= 0;  // number of determinants processed
+    while(it2 != data.end())
+    {
+      int n = *it2; // number of excitations
+      if(count != ref)
+        ratios[count] = sign[count]*det0*CalculateRatioFromMatrixElements(n,dotProducts,it2+1);
+      count++;
+      it2+=3*n+1;  // number of integers used to encode the current excitation
+    }
+  }
+
+  inline void CalculateRatios(int ref, int iat, GradMatrix_t& ratios, ValueMatrix_t& dotProducts, vector<int>& data, vector<double>& sign, int dx)
+  {
+    ValueType det0 = ratios(ref,iat)[dx];
+    vector<int>::iterator it2 = data.begin();
+    int count= 0;  // number of determinants processed
+    while(it2 != data.end())
+    {
+      int n = *it2; // number of excitations
+      if(count != ref)
+        ratios(count,iat)[dx] = sign[count]*det0*CalculateRatioFromMatrixElements(n,dotProducts,it2+1);
+      count++;
+      it2+=3*n+1;
+    }
+  }
+
+  inline void CalculateRatios(int ref, int iat, ValueMatrix_t& ratios, ValueMatrix_t& dotProducts, vector<int>& data, vector<double>& sign)
+  {
+    ValueType det0 = ratios(ref,iat);
+    vector<int>::iterator it2 = data.begin();
+    int count= 0;  // number of determinants processed
+    while(it2 != data.end())
+    {
+      int n = *it2; // number of excitations
+      if(count != ref)
+        ratios(count,iat) = sign[count]*det0*CalculateRatioFromMatrixElements(n,dotProducts,it2+1);
+      count++;
+      it2+=3*n+1;
+    }
+  }
+
   inline void BuildDotProductsAndCalculateRatios(int ref, int iat, ValueVector_t& ratios, ValueMatrix_t &psiinv, ValueMatrix_t &psi, ValueMatrix_t& dotProducts, vector<int>& data, vector<pair<int,int> >& pairs, vector<double>& sign)
   {
     ValueType det0 = ratios[ref];
@@ -908,6 +992,10 @@ public:
   ValueVector_t workV1, workV2;
 
   ValueMatrix_t dotProducts;
+  /// table of the reference determinant used by evaluateForWalkerMove
+  ValueMatrix_t refDotProducts;
+  /// work space for the rank-1 corrections to refDotProducts
+  ValueVector_t tableCol, tableRow;
 
   Vector<ValueType> WorkSpace;
   Vector<IndexType> Pivot;
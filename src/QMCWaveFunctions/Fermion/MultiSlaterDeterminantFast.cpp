@@ -16,6 +16,7 @@
 #include "QMCWaveFunctions/Fermion/MultiSlaterDeterminantFast.h"
 #include "QMCWaveFunctions/Fermion/MultiDiracDeterminantBase.h"
 #include "ParticleBase/ParticleAttribOps.h"
+#include "Message/CommOperators.h"
 
 namespace qmcplusplus
 {
@@ -54,6 +55,7 @@ MultiSlaterDeterminantFast::MultiSlaterDeterminantFast(ParticleSet& targetPtcl,
       DetID[j]=i;
   usingBF=false;
   BFTrans=0;
+  ShardComm=0;
 }
 
 OrbitalBasePtr MultiSlaterDeterminantFast::makeClone(ParticleSet& tqp) const
@@ -74,6 +76,7 @@ OrbitalBasePtr MultiSlaterDeterminantFast::makeClone(ParticleSet& tqp) const
   clone->myVars=myVars;
   clone->usingCSF=usingCSF;
   clone->usingBF=usingBF;
+  clone->ShardComm=ShardComm;
   if (usingCSF)
   {
     clone->CSFcoeff=CSFcoeff;
@@ -202,6 +205,7 @@ OrbitalBase::ValueType MultiSlaterDeterminantFast::evaluate(ParticleSet& P
     upC++;
     dnC++;
   }
+  sumShards(psiCurrent,myG,myL);
   ValueType psiinv = 1.0/psiCurrent;
   myG *= psiinv;
   myL *= psiinv;
@@ -270,6 +274,7 @@ OrbitalBase::RealType MultiSlaterDeterminantFast::evaluateLog(ParticleSet& P,
     upC++;
     dnC++;
   }
+  sumShards(psiCurrent,myG,myL);
   ValueType psiinv = 1.0/psiCurrent;
   myG *= psiinv;
   myL *= psiinv;
@@ -305,6 +310,7 @@ OrbitalBase::GradType MultiSlaterDeterminantFast::evalGrad(ParticleSet& P, int i
       upC++;
       dnC++;
     }
+    sumShards(psi,grad_iat);
     grad_iat *= 1.0/psi;
     return grad_iat;
   }
@@ -326,6 +332,7 @@ OrbitalBase::GradType MultiSlaterDeterminantFast::evalGrad(ParticleSet& P, int i
       upC++;
       dnC++;
     }
+    sumShards(psi,grad_iat);
     grad_iat *= 1.0/psi;
     return grad_iat;
   }
@@ -363,6 +370,7 @@ OrbitalBase::ValueType MultiSlaterDeterminantFast::ratioGrad(ParticleSet& P
       upC++;
       dnC++;
     }
+    sumShards(psiNew,dummy);
     grad_iat+=dummy/psiNew;
     curRatio = psiNew/psiCurrent;
     RatioGradTimer.stop();
@@ -390,6 +398,7 @@ OrbitalBase::ValueType MultiSlaterDeterminantFast::ratioGrad(ParticleSet& P
       upC++;
       dnC++;
     }
+    sumShards(psiNew,dummy);
     grad_iat+=dummy/psiNew;
     curRatio = psiNew/psiCurrent;
     RatioGradTimer.stop();
@@ -458,6 +467,7 @@ OrbitalBase::ValueType  MultiSlaterDeterminantFast::ratio(ParticleSet& P, int ia
       upC++;
       dnC++;
     }
+    sumShards(psiNew,myG_temp,myL_temp);
     ValueType psiNinv=1.0/psiNew;
     myG_temp *= psiNinv;
     myL_temp *= psiNinv;
@@ -507,6 +517,7 @@ OrbitalBase::ValueType  MultiSlaterDeterminantFast::ratio(ParticleSet& P, int ia
       upC++;
       dnC++;
     }
+    sumShards(psiNew,myG_temp,myL_temp);
     ValueType psiNinv=1.0/psiNew;
     myG_temp *= psiNinv;
     myL_temp *= psiNinv;
@@ -542,6 +553,7 @@ OrbitalBase::ValueType MultiSlaterDeterminantFast::ratio(ParticleSet& P, int iat
     vector<RealType>::iterator it(C.begin()),last(C.end());
     while(it != last)
       psiNew += (*(it++))*detValues_up[*(upC++)]*detValues_dn[*(dnC++)];
+    sumShards(psiNew);
     curRatio = psiNew/psiCurrent;
     RatioTimer.stop();
     return curRatio;
@@ -559,6 +571,7 @@ OrbitalBase::ValueType MultiSlaterDeterminantFast::ratio(ParticleSet& P, int iat
     vector<RealType>::iterator it(C.begin()),last(C.end());
     while(it != last)
       psiNew += (*(it++))*detValues_up[*(upC++)]*detValues_dn[*(dnC++)];
+    sumShards(psiNew);
     curRatio = psiNew/psiCurrent;
     RatioTimer.stop();
     return curRatio;
@@ -727,6 +740,7 @@ OrbitalBase::RealType MultiSlaterDeterminantFast::updateBuffer(ParticleSet& P, B
     upC++;
     dnC++;
   }
+  sumShards(psiCurrent,myG,myL);
   ValueType psiinv = 1.0/psiCurrent;
   myG *= psiinv;
   myL *= psiinv;
@@ -754,6 +768,80 @@ void MultiSlaterDeterminantFast::copyFromBuffer(ParticleSet& P, BufferType& buf)
 }
 
 
+/// copy the real words of a value into the buffer of sumShards
+template<typename T> inline void packShard(double*& p, const T& v)
+{
+  *p++=v;
+}
+
+template<typename T> inline void packShard(double*& p, const std::complex<T>& v)
+{
+  *p++=v.real();
+  *p++=v.imag();
+}
+
+template<typename T> inline void unpackShard(const double*& p, T& v)
+{
+  v=*p++;
+}
+
+template<typename T> inline void unpackShard(const double*& p, std::complex<T>& v)
+{
+  v=std::complex<T>(p[0],p[1]);
+  p+=2;
+}
+
+void MultiSlaterDeterminantFast::sumShards(ValueType& psi)
+{
+  if(ShardComm==0)
+    return;
+  ShardBuffer.resize(sizeof(ValueType)/sizeof(RealType));
+  double* p=&ShardBuffer[0];
+  packShard(p,psi);
+  ShardComm->allreduce(ShardBuffer);
+  const double* q=&ShardBuffer[0];
+  unpackShard(q,psi);
+}
+
+void MultiSlaterDeterminantFast::sumShards(ValueType& psi, GradType& g)
+{
+  if(ShardComm==0)
+    return;
+  ShardBuffer.resize((OHMMS_DIM+1)*sizeof(ValueType)/sizeof(RealType));
+  double* p=&ShardBuffer[0];
+  packShard(p,psi);
+  for(int d=0; d<OHMMS_DIM; ++d)
+    packShard(p,g[d]);
+  ShardComm->allreduce(ShardBuffer);
+  const double* q=&ShardBuffer[0];
+  unpackShard(q,psi);
+  for(int d=0; d<OHMMS_DIM; ++d)
+    unpackShard(q,g[d]);
+}
+
+void MultiSlaterDeterminantFast::sumShards(ValueType& psi
+    , ParticleSet::ParticleGradient_t& g, ParticleSet::ParticleLaplacian_t& l)
+{
+  if(ShardComm==0)
+    return;
+  ShardBuffer.resize((1+g.size()*(OHMMS_DIM+1))*sizeof(ValueType)/sizeof(RealType));
+  double* p=&ShardBuffer[0];
+  packShard(p,psi);
+  for(int i=0; i<g.size(); ++i)
+    for(int d=0; d<OHMMS_DIM; ++d)
+      packShard(p,g[i][d]);
+  for(int i=0; i<l.size(); ++i)
+    packShard(p,l[i]);
+  ShardComm->allreduce(ShardBuffer);
+  const double* q=&ShardBuffer[0];
+  unpackShard(q,psi);
+  for(int i=0; i<g.size(); ++i)
+    for(int d=0; d<OHMMS_DIM; ++d)
+      unpackShard(q,g[i][d]);
+  for(int i=0; i<l.size(); ++i)
+    unpackShard(q,l[i]);
+}
+
 void MultiSlaterDeterminantFast::checkInVariables(opt_variables_type& active)
 {
   if(Optimizable)
@@ -153,6 +153,23 @@ public:
 
   void testMSD(ParticleSet& P, int iat);
 
+  /** sum the partial sums of the CI shards
+   *
+   * Each rank of ShardComm keeps a block of the CI terms. The loops over C
+   * produce partial sums, which are added with one allreduce per call.
+   * Nothing is done when the expansion is not sharded.
+   *
+   * Every call is collective over ShardComm. The ranks of a group must
+   * therefore move the same walker through the same sequence of calls, in
+   * bitwise lock-step: same random streams, same accept/reject decisions,
+   * same branching. qmcapp guarantees this only with one thread per rank
+   * and without CI optimization, and rejects --ci_shards otherwise. The
+   * allreduce must also return the same sum on every rank of the group.
+   */
+  void sumShards(ValueType& psi);
+  void sumShards(ValueType& psi, GradType& g);
+  void sumShards(ValueType& psi, ParticleSet::ParticleGradient_t& g, ParticleSet::ParticleLaplacian_t& l);
+
   int NP;
   int nels_up,nels_dn;
   int FirstIndex_up;
@@ -193,6 +210,11 @@ public:
   // coefficient of csf expansion (smaller dimension)
   vector<RealType> CSFexpansion;
 
+  ///communicator of the ranks which share the CI expansion, 0 if it is not sharded
+  Communicate* ShardComm;
+  ///send buffer of sumShards
+  vector<double> ShardBuffer;
+
   // transformation
   BackflowTransformation *BFTrans;
   bool usingBF;
@@ -63,6 +63,11 @@ public:
    * @param iat the particle thas is being moved
    */
   ValueType ratio(ParticleSet& P, int iat);
+  ///ratio is specialized, the moves are evaluated one at a time
+  bool evaluateRatios(ParticleSet& P, int iat, const vector<PosType>& displs, vector<ValueType>& ratios)
+  {
+    return false;
+  }
   void restore(int iat);
   RealType getAlternatePhaseDiff()
   {
@@ -88,6 +93,12 @@ public:
                   ParticleSet::ParticleLaplacian_t& dL);
 
   ValueType ratioGrad(ParticleSet& P, int iat, GradType& grad_iat);
+  ///evaluated walker by walker
+  void ratioGrad(const vector<OrbitalBase*>& orbs, const vector<ParticleSet*>& P, int iat,
+                 vector<ValueType>& ratios, vector<GradType>& grads)
+  {
+    OrbitalBase::ratioGrad(orbs,P,iat,ratios,grads);
+  }
   GradType evalGrad(ParticleSet& P, int iat);
   GradType evalGradSource(ParticleSet &P, ParticleSet &source,
                           int iat);
@@ -64,6 +64,11 @@ public:
    * @param iat the particle thas is being moved
    */
   ValueType ratio(ParticleSet& P, int iat);
+  ///ratio is specialized, the moves are evaluated one at a time
+  bool evaluateRatios(ParticleSet& P, int iat, const vector<PosType>& displs, vector<ValueType>& ratios)
+  {
+    return false;
+  }
 
   ValueType alternateRatio(ParticleSet& P);
 
@@ -81,6 +86,12 @@ public:
                   ParticleSet::ParticleLaplacian_t& dL);
 
   ValueType ratioGrad(ParticleSet& P, int iat, GradType& grad_iat);
+  ///evaluated walker by walker
+  void ratioGrad(const vector<OrbitalBase*>& orbs, const vector<ParticleSet*>& P, int iat,
+                 vector<ValueType>& ratios, vector<GradType>& grads)
+  {
+    OrbitalBase::ratioGrad(orbs,P,iat,ratios,grads);
+  }
   ValueType alternateRatioGrad(ParticleSet& P, int iat, GradType& grad_iat);
   GradType evalGrad(ParticleSet& P, int iat);
   GradType alternateEvalGrad(ParticleSet& P, int iat);
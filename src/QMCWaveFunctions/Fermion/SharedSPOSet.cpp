@@ -0,0 +1,171 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim
+//////////////////////////////////////////////////////////////////
+// -*- C++ -*-
+/** @file SharedSPOSet.cpp
+ * @brief implements the member functions of SharedSPOSet
+ */
+#include "QMCWaveFunctions/Fermion/SharedSPOSet.h"
+namespace qmcplusplus
+{
+
+///return true if a and b are identical
+inline bool samePosition(const QMCTraits::PosType& a, const QMCTraits::PosType& b)
+{
+  for(int d=0; d<OHMMS_DIM; ++d)
+    if(a[d]!=b[d])
+      return false;
+  return true;
+}
+
+SharedSPOSet::SharedSPOSet(SPOSetBasePtr const& spos)
+  : refPhi(spos), nEvals(0), nHits(0)
+{
+  className="SharedSPOSet";
+  objectName=refPhi->objectName;
+  Optimizable=refPhi->Optimizable;
+  TotalOrbitalSize=refPhi->TotalOrbitalSize;
+  BasisSetSize=refPhi->getBasisSetSize();
+  OrbitalSetSize=refPhi->getOrbitalSetSize();
+  invalidate();
+}
+
+SharedSPOSet::~SharedSPOSet()
+{
+  app_log() << "  SharedSPOSet " << objectName << " evaluations = " << nEvals
+            << " shared = " << nHits << endl;
+}
+
+void SharedSPOSet::invalidate()
+{
+  vPtcl=0;
+  vIat=-1;
+  vglCached=false;
+  mPtcl=0;
+  mFirst=mLast=-1;
+}
+
+void SharedSPOSet::resetParameters(const opt_variables_type& optVariables)
+{
+  refPhi->resetParameters(optVariables);
+  invalidate();
+}
+
+void SharedSPOSet::resetTargetParticleSet(ParticleSet& P)
+{
+  refPhi->resetTargetParticleSet(P);
+  invalidate();
+}
+
+void SharedSPOSet::setOrbitalSetSize(int norbs)
+{
+  refPhi->setOrbitalSetSize(norbs);
+  OrbitalSetSize=norbs;
+  invalidate();
+}
+
+SPOSetBase* SharedSPOSet::makeClone() const
+{
+  return refPhi->makeClone();
+}
+
+bool SharedSPOSet::cachedV(const ParticleSet& P, int iat, int n) const
+{
+  return vPtcl==&P && vIat==iat && psiV.size()==n && samePosition(vPos,P.R[iat]);
+}
+
+bool SharedSPOSet::cachedM(const ParticleSet& P, int first, int last, const ValueMatrix_t& logdet) const
+{
+  if(mPtcl!=&P || mFirst!=first || mLast!=last
+      || psiM.rows()!=logdet.rows() || psiM.cols()!=logdet.cols())
+    return false;
+  for(int i=first,k=0; i<last; ++i,++k)
+    if(!samePosition(mPos[k],P.R[i]))
+      return false;
+  return true;
+}
+
+void SharedSPOSet::evaluate(const ParticleSet& P, int iat, ValueVector_t& psi)
+{
+  if(cachedV(P,iat,psi.size()))
+    ++nHits;
+  else
+  {
+    psiV.resize(psi.size());
+    refPhi->evaluate(P,iat,psiV);
+    vPtcl=&P;
+    vIat=iat;
+    vPos=P.R[iat];
+    vglCached=false;
+    ++nEvals;
+  }
+  std::copy(psiV.begin(),psiV.end(),psi.begin());
+}
+
+void SharedSPOSet::evaluate(const ParticleSet& P, int iat
+                            , ValueVector_t& psi, GradVector_t& dpsi, ValueVector_t& d2psi)
+{
+  if(vglCached && cachedV(P,iat,psi.size()))
+    ++nHits;
+  else
+  {
+    psiV.resize(psi.size());
+    dpsiV.resize(psi.size());
+    d2psiV.resize(psi.size());
+    refPhi->evaluate(P,iat,psiV,dpsiV,d2psiV);
+    vPtcl=&P;
+    vIat=iat;
+    vPos=P.R[iat];
+    vglCached=true;
+    ++nEvals;
+  }
+  std::copy(psiV.begin(),psiV.end(),psi.begin());
+  std::copy(dpsiV.begin(),dpsiV.end(),dpsi.begin());
+  std::copy(d2psiV.begin(),d2psiV.end(),d2psi.begin());
+}
+
+void SharedSPOSet::evaluate(const ParticleSet& P, int iat
+                            , ValueVector_t& psi, GradVector_t& dpsi, HessVector_t& grad_grad_psi)
+{
+  refPhi->evaluate(P,iat,psi,dpsi,grad_grad_psi);
+}
+
+void SharedSPOSet::evaluate_notranspose(const ParticleSet& P, int first, int last
+                                        , ValueMatrix_t& logdet, GradMatrix_t& dlogdet, ValueMatrix_t& d2logdet)
+{
+  if(cachedM(P,first,last,logdet))
+  {
+    ++nHits;
+    std::copy(psiM.data(),psiM.data()+psiM.size(),logdet.data());
+    std::copy(dpsiM.data(),dpsiM.data()+dpsiM.size(),dlogdet.data());
+    std::copy(d2psiM.data(),d2psiM.data()+d2psiM.size(),d2logdet.data());
+    return;
+  }
+  refPhi->evaluate_notranspose(P,first,last,logdet,dlogdet,d2logdet);
+  psiM.resize(logdet.rows(),logdet.cols());
+  dpsiM.resize(logdet.rows(),logdet.cols());
+  d2psiM.resize(logdet.rows(),logdet.cols());
+  std::copy(logdet.data(),logdet.data()+psiM.size(),psiM.data());
+  std::copy(dlogdet.data(),dlogdet.data()+dpsiM.size(),dpsiM.data());
+  std::copy(d2logdet.data(),d2logdet.data()+d2psiM.size(),d2psiM.data());
+  mPtcl=&P;
+  mFirst=first;
+  mLast=last;
+  mPos.assign(P.R.begin()+first,P.R.begin()+last);
+  ++nEvals;
+}
+
+void SharedSPOSet::evaluate_notranspose(const ParticleSet& P, int first, int last
+                                        , ValueMatrix_t& logdet, GradMatrix_t& dlogdet, HessMatrix_t& grad_grad_logdet)
+{
+  refPhi->evaluate_notranspose(P,first,last,logdet,dlogdet,grad_grad_logdet);
+}
+
+void SharedSPOSet::evaluate_notranspose(const ParticleSet& P, int first, int last
+                                        , ValueMatrix_t& logdet, GradMatrix_t& dlogdet, HessMatrix_t& grad_grad_logdet
+                                        , GGGMatrix_t& grad_grad_grad_logdet)
+{
+  refPhi->evaluate_notranspose(P,first,last,logdet,dlogdet,grad_grad_logdet,grad_grad_grad_logdet);
+}
+
+}
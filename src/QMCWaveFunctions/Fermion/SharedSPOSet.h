@@ -0,0 +1,99 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim
+//////////////////////////////////////////////////////////////////
+// -*- C++ -*-
+/** @file SharedSPOSet.h
+ * @brief declare a proxy to a SPOSetBase shared by several trial wavefunctions
+ */
+#ifndef QMCPLUSPLUS_SHAREDSPOSET_H
+#define QMCPLUSPLUS_SHAREDSPOSET_H
+#include "QMCWaveFunctions/SPOSetBase.h"
+namespace qmcplusplus
+{
+
+/** proxy SPOSetBase which keeps the last evaluations
+ *
+ * The determinants of the trial wavefunctions of a correlated sampling run,
+ * which differ only by the Jastrow factors or the CI coefficients, use one
+ * SharedSPOSet. The first determinant evaluates the orbitals for a proposed
+ * move or for the particles of a walker, and the others get the copies as long
+ * as the particle set, the particle indices and their positions are the same.
+ *
+ * The clones are those of refPhi: the sharing is limited to the wavefunctions
+ * of the master thread, which are used by CSVMC.
+ */
+struct SharedSPOSet: public SPOSetBase
+{
+  ///SPOSet which evaluates the single-particle states
+  SPOSetBasePtr refPhi;
+
+  ///particle set of the cached values of a particle
+  const ParticleSet* vPtcl;
+  ///particle of the cached values
+  int vIat;
+  ///position of the cached values
+  PosType vPos;
+  ///true if gradients and laplacians are cached with the values
+  bool vglCached;
+  ///values for a particle
+  ValueVector_t psiV;
+  ///gradients for a particle
+  GradVector_t dpsiV;
+  ///laplacians for a particle
+  ValueVector_t d2psiV;
+
+  ///particle set of the cached matrices
+  const ParticleSet* mPtcl;
+  ///first particle of the cached matrices
+  int mFirst;
+  ///last particle of the cached matrices
+  int mLast;
+  ///positions of the cached matrices
+  vector<PosType> mPos;
+  ///values for [mFirst,mLast), not transposed
+  ValueMatrix_t psiM;
+  ///gradients for [mFirst,mLast)
+  GradMatrix_t dpsiM;
+  ///laplacians for [mFirst,mLast)
+  ValueMatrix_t d2psiM;
+
+  ///number of evaluations by refPhi
+  int nEvals;
+  ///number of evaluations served by the copies
+  int nHits;
+
+  /** constructor
+   * @param spos SPOSet to be shared
+   */
+  SharedSPOSet(SPOSetBasePtr const& spos);
+  ~SharedSPOSet();
+
+  ///invalidate the cached evaluations
+  void invalidate();
+
+  void resetParameters(const opt_variables_type& optVariables);
+  void resetTargetParticleSet(ParticleSet& P);
+  void setOrbitalSetSize(int norbs);
+  SPOSetBase* makeClone() const;
+
+  void evaluate(const ParticleSet& P, int iat, ValueVector_t& psi);
+  void evaluate(const ParticleSet& P, int iat
+                , ValueVector_t& psi, GradVector_t& dpsi, ValueVector_t& d2psi);
+  void evaluate(const ParticleSet& P, int iat
+                , ValueVector_t& psi, GradVector_t& dpsi, HessVector_t& grad_grad_psi);
+  void evaluate_notranspose(const ParticleSet& P, int first, int last
+                            , ValueMatrix_t& logdet, GradMatrix_t& dlogdet, ValueMatrix_t& d2logdet);
+  void evaluate_notranspose(const ParticleSet& P, int first, int last
+                            , ValueMatrix_t& logdet, GradMatrix_t& dlogdet, HessMatrix_t& grad_grad_logdet);
+  void evaluate_notranspose(const ParticleSet& P, int first, int last
+                            , ValueMatrix_t& logdet, GradMatrix_t& dlogdet, HessMatrix_t& grad_grad_logdet
+                            , GGGMatrix_t& grad_grad_grad_logdet);
+
+private:
+  ///return true if the values of iat at its current position are cached
+  bool cachedV(const ParticleSet& P, int iat, int n) const;
+  ///return true if the matrices of [first,last) at their current positions are cached
+  bool cachedM(const ParticleSet& P, int first, int last, const ValueMatrix_t& logdet) const;
+};
+}
+#endif
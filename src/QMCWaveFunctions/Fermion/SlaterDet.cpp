@@ -233,6 +233,12 @@ void SlaterDet::copyFromBuffer(ParticleSet& P, PooledData<RealType>& buf)
   DEBUG_PSIBUFFER(" SlaterDet::copyFromBuffer ",buf.current());
 }
 
+void SlaterDet::setBufferResident(bool resident)
+{
+  for (int i = 0; i < Dets.size(); i++)
+    Dets[i]->setBufferResident(resident);
+}
+
 /** reimplements the virtual function
  *
  * The DiractDeterminants of SlaterDet need to save the inverse
@@ -126,6 +126,9 @@ public:
   virtual
   void copyFromBuffer(ParticleSet& P, PooledData<RealType>& buf);
 
+  virtual
+  void setBufferResident(bool resident);
+
   virtual
   void dumpToBuffer(ParticleSet& P, PooledData<RealType>& buf);
 
@@ -149,6 +152,18 @@ public:
     return Dets[DetID[iat]]->ratioGrad(P,iat,grad_iat);
   }
 
+  /** forward the crowd to the determinants of the iat-th particle */
+  virtual
+  inline void ratioGrad(const vector<OrbitalBase*>& orbs, const vector<ParticleSet*>& P, int iat,
+                        vector<ValueType>& ratios, vector<GradType>& grads)
+  {
+    int d=DetID[iat];
+    vector<OrbitalBase*> dets(orbs.size());
+    for(int iw=0; iw<orbs.size(); ++iw)
+      dets[iw]=static_cast<SlaterDet*>(orbs[iw])->Dets[d];
+    Dets[d]->ratioGrad(dets,P,iat,ratios,grads);
+  }
+
   virtual
   inline ValueType alternateRatioGrad(ParticleSet& P, int iat, GradType& grad_iat)
   {
@@ -227,6 +242,12 @@ public:
     return Dets[DetID[iat]]->ratio(P,iat);
   }
 
+  virtual
+  inline bool evaluateRatios(ParticleSet& P, int iat, const vector<PosType>& displs, vector<ValueType>& ratios)
+  {
+    return Dets[DetID[iat]]->evaluateRatios(P,iat,displs,ratios);
+  }
+
   virtual
   inline ValueType alternateRatio(ParticleSet& P)
   {
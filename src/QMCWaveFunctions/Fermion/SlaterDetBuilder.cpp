@@ -37,20 +37,26 @@
 #include "QMCWaveFunctions/Fermion/SlaterDetWithBackflow.h"
 #include "QMCWaveFunctions/Fermion/MultiSlaterDeterminantWithBackflow.h"
 #include "QMCWaveFunctions/Fermion/DiracDeterminantWithBackflow.h"
+#include "Utilities/UtilityFunctions.h"
+#include "qmc_common.h"
 #include<vector>
 //#include "QMCWaveFunctions/Fermion/ci_node.h"
 #include "QMCWaveFunctions/Fermion/ci_configuration.h"
 #include "QMCWaveFunctions/Fermion/ci_configuration2.h"
 #include "QMCWaveFunctions/Fermion/SPOSetProxy.h"
 #include "QMCWaveFunctions/Fermion/SPOSetProxyForMSD.h"
+#include "QMCWaveFunctions/Fermion/SharedSPOSet.h"
 #include "QMCWaveFunctions/Fermion/DiracDeterminantOpt.h"
 #include "QMCWaveFunctions/Fermion/DiracDeterminantAFM.h"
 
 #include <bitset>
+#include <limits>
 
 namespace qmcplusplus
 {
 
+map<SlaterDetBuilder::SharedKey_t,SPOSetBasePtr> SlaterDetBuilder::SharedSPOSets;
+
 SlaterDetBuilder::SlaterDetBuilder(ParticleSet& els, TrialWaveFunction& psi,
                                    PtclPoolType& psets)
   : OrbitalBuilderBase(els,psi), ptclPool(psets)
@@ -60,6 +66,7 @@ SlaterDetBuilder::SlaterDetBuilder(ParticleSet& els, TrialWaveFunction& psi,
   ClassName="SlaterDetBuilder";
   BFTrans=0;
   UseBackflow=false;
+  ShareSPOSets=false;
 }
 SlaterDetBuilder::~SlaterDetBuilder()
 {
@@ -79,6 +86,10 @@ SlaterDetBuilder::~SlaterDetBuilder()
  * - slaterdeterminant
  *   - determinant 0..*
  * - ci
+ *
+ * With shareorbitals="yes", the SPO sets are shared with the trial
+ * wavefunctions built before with the same names of the SPO sets, e.g., for
+ * correlated sampling over the Jastrow factors or the CI coefficients.
  */
 bool SlaterDetBuilder::put(xmlNodePtr cur)
 {
@@ -90,6 +101,11 @@ bool SlaterDetBuilder::put(xmlNodePtr cur)
   string cname, tname;
   std::map<string,SPOSetBasePtr> spomap;
   bool multiDet=false;
+  string shareSPO("no");
+  OhmmsAttributeSet rAttrib;
+  rAttrib.add(shareSPO,"shareorbitals");
+  rAttrib.put(curRoot);
+  ShareSPOSets=(shareSPO=="yes");
   //check the basis set
   cur = curRoot->children;
   while (cur != NULL)//check the basis set
@@ -119,8 +135,16 @@ bool SlaterDetBuilder::put(xmlNodePtr cur)
           myBasisSetFactory->setReportLevel(ReportLevel);
         }
 //     myBasisSetFactory->createBasisSet(cur,cur);
-        SPOSetBasePtr spo = myBasisSetFactory->createSPOSet(cur);
-        spo->put(cur, spomap);
+        SPOSetBasePtr spo;
+        if(ShareSPOSets && findSharedSPOSet(spo_name,spo))
+          app_log() << "  Sharing the SPO set " << spo_name << endl;
+        else
+        {
+          spo = myBasisSetFactory->createSPOSet(cur);
+          spo->put(cur, spomap);
+          if(ShareSPOSets)
+            spo = addSharedSPOSet(spo_name,spo);
+        }
         if (spomap.find(spo_name) != spomap.end())
         {
           app_error() << "SPOSet name \"" << spo_name << "\" is already in use.\n";
@@ -260,6 +284,8 @@ bool SlaterDetBuilder::put(xmlNodePtr cur)
         }
         else
         {
+          if(qmc_common.ci_shards>1)
+            app_warning() << "  ci_shards is used only by the fast multideterminant algorithm. Every rank evaluates the full expansion." << endl;
           SPOSetProxyForMSD* spo_up;
           SPOSetProxyForMSD* spo_dn;
           spo_up=new SPOSetProxyForMSD(spomap.find(spo_alpha)->second,targetPtcl.first(0),targetPtcl.last(0));
@@ -339,6 +365,32 @@ bool SlaterDetBuilder::put(xmlNodePtr cur)
 }
 
 
+bool SlaterDetBuilder::findSharedSPOSet(const string& name, SPOSetBasePtr& spo)
+{
+  map<SharedKey_t,SPOSetBasePtr>::iterator it(SharedSPOSets.find(SharedKey_t(&targetPtcl,name)));
+  if(it == SharedSPOSets.end())
+    return false;
+  spo=(*it).second;
+  return true;
+}
+
+SPOSetBasePtr SlaterDetBuilder::addSharedSPOSet(const string& name, SPOSetBasePtr spo)
+{
+  if(spo->Optimizable)
+  {
+    app_warning() << "  Optimizable SPO set " << name << " is not shared." << endl;
+    return spo;
+  }
+  SPOSetBasePtr shared(new SharedSPOSet(spo));
+  SharedSPOSets[SharedKey_t(&targetPtcl,name)]=shared;
+  return shared;
+}
+
+void SlaterDetBuilder::clearSharedSPOSets()
+{
+  SharedSPOSets.clear();
+}
+
 bool SlaterDetBuilder::putDeterminant(xmlNodePtr cur, int spin_group)
 {
   ReportEngine PRE(ClassName,"putDeterminant(xmlNodePtr,int)");
@@ -365,7 +417,12 @@ bool SlaterDetBuilder::putDeterminant(xmlNodePtr cur, int spin_group)
   map<string,SPOSetBasePtr>& spo_ref(slaterdet_0->mySPOSet);
   map<string,SPOSetBasePtr>::iterator lit(spo_ref.find(detname));
   SPOSetBasePtr psi;
-  if (lit == spo_ref.end())
+  if (ShareSPOSets && lit == spo_ref.end() && findSharedSPOSet(detname,psi))
+  {
+    slaterdet_0->add(psi,detname);
+    app_log() << "  Sharing the SPO set " << detname << endl;
+  }
+  else if (lit == spo_ref.end())
   {
     // cerr << "Didn't find sposet named \"" << detname << "\"\n";
 #if defined(ENABLE_SMARTPOINTER)
@@ -375,6 +432,8 @@ bool SlaterDetBuilder::putDeterminant(xmlNodePtr cur, int spin_group)
 #endif
     psi->put(cur);
     psi->checkObject();
+    if(ShareSPOSets)
+      psi=addSharedSPOSet(detname,psi);
     slaterdet_0->add(psi,detname);
     //SPOSet[detname]=psi;
     app_log() << "  Creating a new SPO set " << detname << endl;
@@ -475,9 +534,13 @@ bool SlaterDetBuilder::createMSDFast(MultiSlaterDeterminantFast* multiSD, xmlNod
   bool optimizeCI;
   int nels_up = multiSD->nels_up;
   int nels_dn = multiSD->nels_dn;
-  success = readDetList(cur,uniqueConfg_up,uniqueConfg_dn,multiSD->C2node_up, multiSD->C2node_dn,CItags,multiSD->C,optimizeCI,nels_up,nels_dn,multiSD->CSFcoeff,multiSD->DetsPerCSF,multiSD->CSFexpansion,multiSD->usingCSF);
+  success = readDetList(cur,uniqueConfg_up,uniqueConfg_dn,multiSD->C2node_up, multiSD->C2node_dn,CItags,multiSD->C,optimizeCI,nels_up,nels_dn,multiSD->CSFcoeff,multiSD->DetsPerCSF,multiSD->CSFexpansion,multiSD->usingCSF,qmc_common.ci_comm);
   if(!success)
     return false;
+  if (multiSD->CSFcoeff.size()==1)
+    optimizeCI=false;
+  if(qmc_common.ci_comm && qmc_common.ci_comm->size()>1)
+    multiSD->ShardComm=qmc_common.ci_comm;
 // you should choose the det with highest weight for reference
   multiSD->Dets[0]->ReferenceDeterminant = 0; // for now
   multiSD->Dets[0]->NumDets=uniqueConfg_up.size();
@@ -513,8 +576,6 @@ bool SlaterDetBuilder::createMSDFast(MultiSlaterDeterminantFast* multiSD, xmlNod
     }
   }
   multiSD->Dets[1]->set(multiSD->FirstIndex_dn,nels_dn,multiSD->Dets[1]->Phi->getOrbitalSetSize());
-  if (multiSD->CSFcoeff.size()==1)
-    optimizeCI=false;
   if(optimizeCI)
   {
     app_log() <<"CI coefficients are optimizable. \n";
@@ -730,7 +791,49 @@ bool SlaterDetBuilder::createMSD(MultiSlaterDeterminant* multiSD, xmlNodePtr cur
 }
 
 
-bool SlaterDetBuilder::readDetList(xmlNodePtr cur, vector<ci_configuration>& uniqueConfg_up, vector<ci_configuration>& uniqueConfg_dn, vector<int>& C2node_up, vector<int>& C2node_dn, vector<std::string>& CItags, vector<RealType>& coeff, bool& optimizeCI, int nels_up, int nels_dn,  vector<RealType>& CSFcoeff, vector<int>& DetsPerCSF, vector<RealType>& CSFexpansion, bool& usingCSF)
+int SlaterDetBuilder::countDetTerms(xmlNodePtr cur, bool usingCSF, RealType cutoff, const string& CSFChoice)
+{
+  int n=0;
+  string cname,cname0;
+  for(cur=cur->children; cur != NULL; cur=cur->next)
+  {
+    getNodeName(cname,cur);
+    if(usingCSF && cname == "csf")
+    {
+      RealType exctLvl=0.0,ci=0.0,qc_ci=0.0;
+      OhmmsAttributeSet confAttrib;
+      confAttrib.add(ci,"coeff");
+      confAttrib.add(qc_ci,"qchem_coeff");
+      confAttrib.add(exctLvl,"exctLvl");
+      confAttrib.put(cur);
+      if(qc_ci == 0.0)
+        qc_ci = ci;
+      if(((abs(qc_ci) < cutoff)&&(CSFChoice=="qchem_coeff"))||((CSFChoice=="exctLvl")&&(exctLvl>cutoff))||((CSFChoice=="coeff")&&(abs(ci) < cutoff)))
+        continue;
+      for(xmlNodePtr csf=cur->children; csf != NULL; csf=csf->next)
+      {
+        getNodeName(cname0,csf);
+        if(cname0 == "det")
+          n++;
+      }
+    }
+    else if(!usingCSF && (cname == "configuration" || cname == "ci"))
+    {
+      RealType ci=0.0, qc_ci=0.0;
+      OhmmsAttributeSet confAttrib;
+      confAttrib.add(ci,"coeff");
+      confAttrib.add(qc_ci,"qchem_coeff");
+      confAttrib.put(cur);
+      if(qc_ci == 0.0)
+        qc_ci = ci;
+      if(abs(qc_ci) >= cutoff)
+        n++;
+    }
+  }
+  return n;
+}
+
+bool SlaterDetBuilder::readDetList(xmlNodePtr cur, vector<ci_configuration>& uniqueConfg_up, vector<ci_configuration>& uniqueConfg_dn, vector<int>& C2node_up, vector<int>& C2node_dn, vector<std::string>& CItags, vector<RealType>& coeff, bool& optimizeCI, int nels_up, int nels_dn,  vector<RealType>& CSFcoeff, vector<int>& DetsPerCSF, vector<RealType>& CSFexpansion, bool& usingCSF, Communicate* shards)
 {
   bool success=true;
   uniqueConfg_up.clear();
@@ -752,6 +855,12 @@ bool SlaterDetBuilder::readDetList(xmlNodePtr cur, vector<ci_configuration>& uni
   ciAttrib.add (optCI,"Optimize");
   ciAttrib.put(cur);
   optimizeCI = (optCI=="yes");
+  //with CI shards, each rank stores only its block of the terms
+  bool sharded=(shards && shards->size()>1);
+  if(sharded && optimizeCI)
+  {
+    APP_ABORT("SlaterDetBuilder::readDetList: the CI coefficients cannot be optimized with --ci_shards. Set optimize=\"no\" in multideterminant or run without --ci_shards.");
+  }
   xmlNodePtr curRoot=cur,DetListNode;
   string cname,cname0;
   cur = curRoot->children;
@@ -810,6 +919,19 @@ bool SlaterDetBuilder::readDetList(xmlNodePtr cur, vector<ci_configuration>& uni
   for(int i=0; i<NCB+NEB; i++)
     dummyC_beta.occup[i]=true;
   RealType sumsq_qc=0.0;
+  RealType sumsq=0.0;
+  //the terms [first,last) of the list are stored, all of them if not sharded
+  int first=0, last=std::numeric_limits<int>::max();
+  if(sharded)
+  {
+    vector<int> terms(shards->size()+1);
+    FairDivideLow(countDetTerms(DetListNode,usingCSF,cutoff,CSFChoice),shards->size(),terms);
+    first=terms[shards->rank()];
+    last=terms[shards->rank()+1];
+  }
+  //index of a term over the whole list and the configurations of the first term, the reference
+  int iterm=0;
+  ci_configuration ref_up, ref_dn;
   //app_log() <<"alpha reference: \n" <<dummyC_alpha;
   //app_log() <<"beta reference: \n" <<dummyC_beta;
   int ntot=0;
@@ -842,11 +964,11 @@ bool SlaterDetBuilder::readDetList(xmlNodePtr cur, vector<ci_configuration>& uni
         cnt0++;
         if(abs(qc_ci)<zero_cutoff)
           ci=0.0;
-        CSFcoeff.push_back(ci);
         sumsq_qc += qc_ci*qc_ci;
-        DetsPerCSF.push_back(0);
-        CItags.push_back(tag);
         count++;
+        //the CSF is stored with its first det of the block
+        bool csfKept=false;
+        int ndetsInCSF=0;
         xmlNodePtr csf=cur->children;
         while(csf != NULL)
         {
@@ -904,23 +1026,46 @@ bool SlaterDetBuilder::readDetList(xmlNodePtr cur, vector<ci_configuration>& uni
               APP_ABORT("Found incorrect beta determinant label. noccup != ncb+neb");
             }
 //app_log() <<" <ci id=\"coeff_" <<ntot++ <<"\" coeff=\"" <<ci*coef <<"\" alpha=\"" <<alpha <<"\" beta=\"" <<beta <<"\" />" <<endl;
-            DetsPerCSF.back()++;
-            CSFexpansion.push_back(coef);
-            coeff.push_back(coef*ci);
-            confgList_up.push_back(dummyC_alpha);
-            for(int i=0; i<NCA; i++)
-              confgList_up.back().occup[i]=true;
-            for(int i=NCA; i<NCA+nstates; i++)
-              confgList_up.back().occup[i]= (alpha[i-NCA]=='1');
-            confgList_dn.push_back(dummyC_beta);
-            for(int i=0; i<NCB; i++)
-              confgList_dn.back().occup[i]=true;
-            for(int i=NCB; i<NCB+nstates; i++)
-              confgList_dn.back().occup[i]=(beta[i-NCB]=='1');
+            ndetsInCSF++;
+            sumsq += coef*ci*coef*ci;
+            bool keep=(iterm>=first && iterm<last);
+            if(iterm == 0 || keep)
+            {
+              ci_configuration c_up(dummyC_alpha), c_dn(dummyC_beta);
+              for(int i=0; i<NCA; i++)
+                c_up.occup[i]=true;
+              for(int i=NCA; i<NCA+nstates; i++)
+                c_up.occup[i]= (alpha[i-NCA]=='1');
+              for(int i=0; i<NCB; i++)
+                c_dn.occup[i]=true;
+              for(int i=NCB; i<NCB+nstates; i++)
+                c_dn.occup[i]=(beta[i-NCB]=='1');
+              if(iterm == 0)
+              {
+                ref_up=c_up;
+                ref_dn=c_dn;
+              }
+              if(keep)
+              {
+                if(!csfKept)
+                {
+                  CSFcoeff.push_back(ci);
+                  DetsPerCSF.push_back(0);
+                  CItags.push_back(tag);
+                  csfKept=true;
+                }
+                DetsPerCSF.back()++;
+                CSFexpansion.push_back(coef);
+                coeff.push_back(coef*ci);
+                confgList_up.push_back(c_up);
+                confgList_dn.push_back(c_dn);
+              }
+            }
+            iterm++;
           } // if(name=="det")
           csf = csf->next;
         } // csf loop
-        if(DetsPerCSF.back() == 0)
+        if(ndetsInCSF == 0)
         {
           APP_ABORT("Found empty CSF (no det blocks).");
         }
@@ -999,19 +1144,34 @@ bool SlaterDetBuilder::readDetList(xmlNodePtr cur, vector<ci_configuration>& uni
           APP_ABORT("Found incorrect beta determinant label. noccup != ncb+neb");
         }
         count++;
-        coeff.push_back(ci);
         sumsq_qc += qc_ci*qc_ci;
-        CItags.push_back(tag);
-        confgList_up.push_back(dummyC_alpha);
-        for(int i=0; i<NCA; i++)
-          confgList_up.back().occup[i]=true;
-        for(int i=NCA; i<NCA+nstates; i++)
-          confgList_up.back().occup[i]= (alpha[i-NCA]=='1');
-        confgList_dn.push_back(dummyC_beta);
-        for(int i=0; i<NCB; i++)
-          confgList_dn.back().occup[i]=true;
-        for(int i=NCB; i<NCB+nstates; i++)
-          confgList_dn.back().occup[i]=(beta[i-NCB]=='1');
+        sumsq += ci*ci;
+        bool keep=(iterm>=first && iterm<last);
+        if(iterm == 0 || keep)
+        {
+          ci_configuration c_up(dummyC_alpha), c_dn(dummyC_beta);
+          for(int i=0; i<NCA; i++)
+            c_up.occup[i]=true;
+          for(int i=NCA; i<NCA+nstates; i++)
+            c_up.occup[i]= (alpha[i-NCA]=='1');
+          for(int i=0; i<NCB; i++)
+            c_dn.occup[i]=true;
+          for(int i=NCB; i<NCB+nstates; i++)
+            c_dn.occup[i]=(beta[i-NCB]=='1');
+          if(iterm == 0)
+          {
+            ref_up=c_up;
+            ref_dn=c_dn;
+          }
+          if(keep)
+          {
+            coeff.push_back(ci);
+            CItags.push_back(tag);
+            confgList_up.push_back(c_up);
+            confgList_dn.push_back(c_dn);
+          }
+        }
+        iterm++;
       }
       cur = cur->next;
     }
@@ -1028,12 +1188,15 @@ bool SlaterDetBuilder::readDetList(xmlNodePtr cur, vector<ci_configuration>& uni
   //  }
   C2node_up.resize(coeff.size());
   C2node_dn.resize(coeff.size());
-  app_log() <<"Found " <<coeff.size() <<" terms in the MSD expansion.\n";
-  RealType sumsq=0.0;
-  for(int i=0; i<coeff.size(); i++)
-    sumsq += coeff[i]*coeff[i];
+  app_log() <<"Found " <<iterm <<" terms in the MSD expansion.\n";
   app_log() <<"Norm of ci vector (sum of ci^2): " <<sumsq <<endl;
   app_log() <<"Norm of qchem ci vector (sum of qchem_ci^2): " <<sumsq_qc <<endl;
+  //the reference determinant is the first unique determinant on every rank
+  if(iterm)
+  {
+    uniqueConfg_up.push_back(ref_up);
+    uniqueConfg_dn.push_back(ref_dn);
+  }
   for(int i=0; i<confgList_up.size(); i++)
   {
     bool found=false;
@@ -1080,6 +1243,9 @@ bool SlaterDetBuilder::readDetList(xmlNodePtr cur, vector<ci_configuration>& uni
       C2node_dn[i]=uniqueConfg_dn.size()-1;
     }
   }
+  if(sharded)
+    app_log() <<"  CI expansion is split over " <<shards->size() <<" ranks. Rank 0 keeps "
+              <<coeff.size() <<" terms.\n";
   app_log() <<"Found " <<uniqueConfg_up.size() <<" unique up determinants.\n";
   app_log() <<"Found " <<uniqueConfg_dn.size() <<" unique down determinants.\n";
   return success;
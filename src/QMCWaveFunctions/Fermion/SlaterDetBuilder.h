@@ -57,6 +57,9 @@ public:
    */
   bool put(xmlNodePtr cur);
 
+  ///forget the shared SPO sets when the trial wavefunctions are destroyed
+  static void clearSharedSPOSets();
+
 private:
 
   ///reference to a PtclPoolType
@@ -69,6 +72,27 @@ private:
   bool UseBackflow;
   BackflowTransformation *BFTrans;
 
+  ///if true, the SPO sets are shared by the trial wavefunctions
+  bool ShareSPOSets;
+  ///key of a shared SPO set: the target particle set and the name of the SPO set
+  typedef std::pair<const ParticleSet*,string> SharedKey_t;
+  ///SPO sets shared by the trial wavefunctions, see SharedSPOSet
+  static map<SharedKey_t,SPOSetBasePtr> SharedSPOSets;
+
+  /** find a shared SPO set
+   * @param name name of the SPO set
+   * @param spo the shared SPO set if found
+   * @return true if found
+   */
+  bool findSharedSPOSet(const string& name, SPOSetBasePtr& spo);
+
+  /** add a SPO set to SharedSPOSets
+   * @param name name of the SPO set
+   * @param spo new SPO set
+   * @return the SharedSPOSet of spo or spo if it is optimizable
+   */
+  SPOSetBasePtr addSharedSPOSet(const string& name, SPOSetBasePtr spo);
+
   /** process a determinant element
    * @param cur xml node
    * @param firstIndex index of the determinant
@@ -80,7 +104,17 @@ private:
 
   bool createMSDFast(MultiSlaterDeterminantFast* multiSD, xmlNodePtr cur);
 
-  bool readDetList(xmlNodePtr cur, vector<ci_configuration>& uniqueConfg_up, vector<ci_configuration>& uniqueConfg_dn, vector<int>& C2node_up, vector<int>& C2node_dn, vector<std::string>& CItags, vector<RealType>& coeff, bool& optimizeCI, int nels_up, int nels_dn, vector<RealType>& CSFcoeff, vector<int>& DetsPerCSF, vector<RealType>& CSFexpansion, bool& usingCSF);
+  /** read the determinant list
+   * @param shards if not 0, the terms are split over its ranks
+   *
+   * With shards, a rank stores only its block of the terms and the unique
+   * determinants used by the block. The reference determinant, from the first
+   * term, is the unique determinant 0 on all ranks.
+   */
+  bool readDetList(xmlNodePtr cur, vector<ci_configuration>& uniqueConfg_up, vector<ci_configuration>& uniqueConfg_dn, vector<int>& C2node_up, vector<int>& C2node_dn, vector<std::string>& CItags, vector<RealType>& coeff, bool& optimizeCI, int nels_up, int nels_dn, vector<RealType>& CSFcoeff, vector<int>& DetsPerCSF, vector<RealType>& CSFexpansion, bool& usingCSF, Communicate* shards=0);
+
+  ///count the determinant terms of a detlist that pass the cutoff of readDetList
+  int countDetTerms(xmlNodePtr cur, bool usingCSF, RealType cutoff, const string& CSFChoice);
 
 };
 }
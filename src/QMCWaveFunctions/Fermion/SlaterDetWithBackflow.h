@@ -117,6 +117,13 @@ public:
     return psi;
   }
 
+  ///the backflow transformation is evaluated walker by walker
+  inline void ratioGrad(const vector<OrbitalBase*>& orbs, const vector<ParticleSet*>& P, int iat,
+                        vector<ValueType>& ratios, vector<GradType>& grads)
+  {
+    OrbitalBase::ratioGrad(orbs,P,iat,ratios,grads);
+  }
+
   inline ValueType alternateRatioGrad(ParticleSet& P, int iat, GradType& grad_iat)
   {
     APP_ABORT("Need to implement SlaterDetWithBackflow::ratioGrad() \n");
@@ -174,6 +181,12 @@ public:
   }
 
 
+  ///the backflow transformation moves all the particles, the moves are evaluated one at a time
+  inline bool evaluateRatios(ParticleSet& P, int iat, const vector<PosType>& displs, vector<ValueType>& ratios)
+  {
+    return false;
+  }
+
   inline ValueType ratio(ParticleSet& P, int iat)
   {
     BFTrans->evaluatePbyP(P,iat);
@@ -173,18 +173,19 @@ LRTwoBodyJastrow::ratio(ParticleSet& P, int iat)
 #if defined(USE_REAL_STRUCT_FACTOR)
   APP_ABORT("LRTwoBodyJastrow::ratio(ParticleSet& P, int iat)");
 #else
-  const KContainer::VContainer_t& kpts(P.SK->KLists.kpts_cart);
+  //eikr of the proposed move is shared with the other k-space objects
+  const ComplexType* restrict eikr_new(P.SK->getEikrTemp().data());
   const ComplexType* restrict eikr_ptr(P.SK->eikr[iat]);
   const ComplexType* restrict rhok_ptr(Rhok.data());
-  PosType pos(P.R[iat]);
   curVal=0.0;
   int ki=0;
   for(int ks=0; ks<MaxKshell; ks++)
   {
-    RealType dd=0.0,s,c;
-    for(; ki<Kshell[ks+1]; ki++,eikr_ptr++,rhok_ptr++)
+    RealType dd=0.0;
+    for(; ki<Kshell[ks+1]; ki++,eikr_new++,eikr_ptr++,rhok_ptr++)
     {
-      sincos(dot(kpts[ki],pos),&s,&c);
+      RealType c=(*eikr_new).real();
+      RealType s=(*eikr_new).imag();
       dd += c*(c+(*rhok_ptr).real()-(*eikr_ptr).real())
             + s*(s+(*rhok_ptr).imag()-(*eikr_ptr).imag());
     }
@@ -215,17 +216,13 @@ LRTwoBodyJastrow::logRatio(ParticleSet& P, int iat,
   NeedToRestore=true;
   const KContainer::VContainer_t& kpts(P.SK->KLists.kpts_cart);
   {
-    ComplexType* restrict eikr1(eikr_new.data());
-    ComplexType* restrict deikr(delta_eikr.data());
+    //eikr of the proposed move is shared with the other k-space objects
+    const ComplexType* restrict eikr1(P.SK->getEikrTemp().data());
     const ComplexType* restrict eikr0(eikr[iat]);
-    PosType pos(P.R[iat]);
-    RealType c,s;
+    ComplexType* restrict deikr(delta_eikr.data());
     for(int ki=0; ki<MaxK; ki++)
-    {
-      sincos(dot(kpts[ki],pos),&s,&c);
-      (*eikr1)=ComplexType(c,s);
-      (*deikr++)=(*eikr1++)-(*eikr0++);
-    }
+      deikr[ki]=eikr1[ki]-eikr0[ki];
+    std::copy(eikr1,eikr1+MaxK,eikr_new.data());
   }
   //new Rhok: restored by rejectMove
   Rhok += delta_eikr;
@@ -18,6 +18,7 @@
 
 #include "QMCWaveFunctions/SPOSetBase.h"
 #include <simd/simd.hpp>
+#include "Numerics/OhmmsBlas.h"
 
 namespace qmcplusplus
 {
@@ -149,13 +150,26 @@ public:
   void evaluate_notranspose(const ParticleSet& P, int first, int last
                             , ValueMatrix_t& logdet, GradMatrix_t& dlogdet, HessMatrix_t& grad_grad_logdet)
   {
-    APP_ABORT("Need specialization of LCOrbitalSet<BS,true>::evaluate_notranspose() for grad_grad_logdet. \n");
+    for(int i=0, iat=first; iat<last; i++,iat++)
+    {
+      myBasisSet->evaluateWithHessian(P,iat);
+      std::copy(myBasisSet->Phi.data(),myBasisSet->Phi.data()+OrbitalSetSize,logdet[i]);
+      std::copy(myBasisSet->dPhi.data(),myBasisSet->dPhi.data()+OrbitalSetSize,dlogdet[i]);
+      std::copy(myBasisSet->grad_grad_Phi.data(),myBasisSet->grad_grad_Phi.data()+OrbitalSetSize,grad_grad_logdet[i]);
+    }
   }
 
   void evaluate_notranspose(const ParticleSet& P, int first, int last
                             , ValueMatrix_t& logdet, GradMatrix_t& dlogdet, HessMatrix_t& grad_grad_logdet, GGGMatrix_t& grad_grad_grad_logdet)
   {
-    APP_ABORT("Need specialization of LCOrbitalSet<BS,true>::evaluate_notranspose() for grad_grad_grad_logdet. \n");
+    for(int i=0, iat=first; iat<last; i++,iat++)
+    {
+      myBasisSet->evaluateWithThirdDeriv(P,iat);
+      std::copy(myBasisSet->Phi.data(),myBasisSet->Phi.data()+OrbitalSetSize,logdet[i]);
+      std::copy(myBasisSet->dPhi.data(),myBasisSet->dPhi.data()+OrbitalSetSize,dlogdet[i]);
+      std::copy(myBasisSet->grad_grad_Phi.data(),myBasisSet->grad_grad_Phi.data()+OrbitalSetSize,grad_grad_logdet[i]);
+      std::copy(myBasisSet->grad_grad_grad_Phi.data(),myBasisSet->grad_grad_grad_Phi.data()+OrbitalSetSize,grad_grad_grad_logdet[i]);
+    }
   }
 
 };
@@ -246,16 +260,16 @@ public:
   evaluate(const ParticleSet& P, int iat, ValueVector_t& psi)
   {
     myBasisSet->evaluateForPtclMove(P,iat);
-    simd::gemv(C,myBasisSet->Phi.data(),psi.data());
+    product_active(myBasisSet->Phi.data(),psi.data());
   }
 
   inline void
   evaluate(const ParticleSet& P, int iat, ValueVector_t& psi, GradVector_t& dpsi, ValueVector_t& d2psi)
   {
     myBasisSet->evaluateAllForPtclMove(P,iat);
-    simd::gemv(C,myBasisSet->Phi.data(),psi.data());
-    simd::gemv(C,myBasisSet->dPhi.data(),dpsi.data());
-    simd::gemv(C,myBasisSet->d2Phi.data(),d2psi.data());
+    product_active(myBasisSet->Phi.data(),psi.data());
+    product_active(myBasisSet->dPhi.data(),dpsi.data());
+    product_active(myBasisSet->d2Phi.data(),d2psi.data());
   }
 
   inline void
@@ -264,9 +278,9 @@ public:
            HessVector_t& grad_grad_psi)
   {
     myBasisSet->evaluateForPtclMoveWithHessian(P,iat);
-    simd::gemv(C,myBasisSet->Phi.data(),psi.data());
-    simd::gemv(C,myBasisSet->dPhi.data(),dpsi.data());
-    simd::gemv(C,myBasisSet->grad_grad_Phi.data(),grad_grad_psi.data());
+    product_active(myBasisSet->Phi.data(),psi.data());
+    product_active(myBasisSet->dPhi.data(),dpsi.data());
+    product_active(myBasisSet->grad_grad_Phi.data(),grad_grad_psi.data());
 //#if defined(USE_BLAS2)
 //      MatrixOperators::product(C,myBasisSet->Phi.data(),psi.data());
 //      MatrixOperators::product(C,myBasisSet->dPhi.data(),dpsi.data());
@@ -292,110 +306,230 @@ public:
 //#endif
   }
 
+  /** evaluate the orbitals of the particles [first,last)
+   *
+   * The basis functions of all the particles are collected in BasisBlock
+   * and each quantity is obtained by a GEMM with C over the basis functions
+   * active for any of the particles, see BlockRanges.
+   */
   void evaluate_notranspose(const ParticleSet& P, int first, int last,
                             ValueMatrix_t& logdet, GradMatrix_t& dlogdet, ValueMatrix_t& d2logdet)
   {
-    const ValueType* restrict cptr=C.data();
-#pragma ivdep
-    for(int i=0,ij=0, iat=first; iat<last; i++,iat++)
+    const int n=last-first;
+    //rows: values [0,n), laplacians [n,2n), gradients [2n,5n)
+    BasisBlock.resize(5*n,BasisSetSize);
+    BlockMask.assign(BasisSetSize,0);
+    for(int i=0, iat=first; iat<last; i++,iat++)
     {
       myBasisSet->evaluateForWalkerMove(P,iat);
-      MatrixOperators::product(C,myBasisSet->Phi,logdet[i]);
-      MatrixOperators::product(C,myBasisSet->d2Phi,d2logdet[i]);
-      const typename BS::GradType* restrict dptr=myBasisSet->dPhi.data();
-      for(int j=0,jk=0; j<OrbitalSetSize; j++)
-      {
-        register GradType dres;
-        for(int b=0; b<BasisSetSize; ++b)
-          dres +=  cptr[jk++]*dptr[b];
-        dlogdet(ij)=dres;
-        ++ij;
-      }
+      add_block_ranges();
+      gather(i,1,myBasisSet->Phi.data(),BasisBlock[0]);
+      gather(i,1,myBasisSet->d2Phi.data(),BasisBlock[n]);
+      gather(i,OHMMS_DIM,myBasisSet->dPhi.data()->begin(),BasisBlock[2*n]);
     }
+    close_block_ranges();
+    product(n,BasisBlock[0],logdet.data(),logdet.cols());
+    product(n,BasisBlock[n],d2logdet.data(),d2logdet.cols());
+    product(OHMMS_DIM*n,BasisBlock[2*n]);
+    for(int i=0; i<n; i++)
+      scatter(i,OHMMS_DIM,dlogdet[i]->begin());
   }
 
   void evaluate_notranspose(const ParticleSet& P, int first, int last,
                             ValueMatrix_t& logdet, GradMatrix_t& dlogdet, HessMatrix_t& grad_grad_logdet)
   {
-    const ValueType* restrict cptr=C.data();
-#pragma ivdep
-    for(int i=0,ij=0, iat=first; iat<last; i++,iat++)
+    const int n=last-first;
+    const int nh=OHMMS_DIM*OHMMS_DIM;
+    //rows: values [0,n), gradients [n,4n), hessians [4n,13n)
+    BasisBlock.resize((1+OHMMS_DIM+nh)*n,BasisSetSize);
+    ValueType* restrict hblock=BasisBlock[(1+OHMMS_DIM)*n];
+    BlockMask.assign(BasisSetSize,0);
+    for(int i=0, iat=first; iat<last; i++,iat++)
     {
       myBasisSet->evaluateWithHessian(P,iat);
-      MatrixOperators::product(C,myBasisSet->Phi,logdet[i]);
-      const typename BS::GradType* restrict dptr=myBasisSet->dPhi.data();
-      const typename BS::HessType* restrict d2ptr=myBasisSet->grad_grad_Phi.data();
-      for(int j=0,jk=0; j<OrbitalSetSize; j++)
-      {
-        register GradType dres;
-        register HessType d2res;
-        for(int b=0; b<BasisSetSize; ++b,++jk)
-        {
-          dres +=  cptr[jk]*dptr[b];
-          d2res +=  cptr[jk]*d2ptr[b];
-        }
-        dlogdet(ij)=dres;
-        grad_grad_logdet(ij)=d2res;
-        ++ij;
-      }
+      add_block_ranges();
+      gather(i,1,myBasisSet->Phi.data(),BasisBlock[0]);
+      gather(i,OHMMS_DIM,myBasisSet->dPhi.data()->begin(),BasisBlock[n]);
+      gather(i,nh,myBasisSet->grad_grad_Phi.data()->begin(),hblock);
     }
+    close_block_ranges();
+    product(n,BasisBlock[0],logdet.data(),logdet.cols());
+    product(OHMMS_DIM*n,BasisBlock[n]);
+    for(int i=0; i<n; i++)
+      scatter(i,OHMMS_DIM,dlogdet[i]->begin());
+    product(nh*n,hblock);
+    for(int i=0; i<n; i++)
+      scatter(i,nh,grad_grad_logdet[i]->begin());
   }
 
   void evaluate_notranspose(const ParticleSet& P, int first, int last
                             , ValueMatrix_t& logdet, GradMatrix_t& dlogdet, HessMatrix_t& grad_grad_logdet, GGGMatrix_t& grad_grad_grad_logdet)
   {
-    const ValueType* restrict cptr=C.data();
-#pragma ivdep
-    for(int i=0,ij=0, iat=first; iat<last; i++,iat++)
+    const int n=last-first;
+    const int nh=OHMMS_DIM*OHMMS_DIM;
+    const int ng=OHMMS_DIM*nh;
+    //rows: values [0,n), gradients [n,4n), hessians [4n,13n), third derivatives [13n,40n)
+    BasisBlock.resize((1+OHMMS_DIM+nh+ng)*n,BasisSetSize);
+    ValueType* restrict hblock=BasisBlock[(1+OHMMS_DIM)*n];
+    ValueType* restrict gblock=BasisBlock[(1+OHMMS_DIM+nh)*n];
+    BlockMask.assign(BasisSetSize,0);
+    for(int i=0, iat=first; iat<last; i++,iat++)
     {
       myBasisSet->evaluateWithThirdDeriv(P,iat);
-      MatrixOperators::product(C,myBasisSet->Phi,logdet[i]);
-      const typename BS::GradType* restrict dptr=myBasisSet->dPhi.data();
-      const typename BS::HessType* restrict d2ptr=myBasisSet->grad_grad_Phi.data();
-      const typename BS::GGGType* restrict gggptr=myBasisSet->grad_grad_grad_Phi.data();
-      for(int j=0,jk=0; j<OrbitalSetSize; j++)
-      {
-        register GradType dres;
-        register HessType d2res;
-        register GGGType gggres;
-        for(int b=0; b<BasisSetSize; ++b)
-        {
-          dres +=  cptr[jk]*dptr[b];
-          d2res +=  cptr[jk]*d2ptr[b];
-          gggres[0] +=  cptr[jk]*(gggptr[b])[0];
-          gggres[1] +=  cptr[jk]*(gggptr[b])[1];
-          gggres[2] +=  cptr[jk++]*(gggptr[b])[2];
-        }
-        dlogdet(ij)=dres;
-        grad_grad_logdet(ij)=d2res;
-        grad_grad_grad_logdet(ij)=gggres;
-        ++ij;
-      }
+      add_block_ranges();
+      gather(i,1,myBasisSet->Phi.data(),BasisBlock[0]);
+      gather(i,OHMMS_DIM,myBasisSet->dPhi.data()->begin(),BasisBlock[n]);
+      gather(i,nh,myBasisSet->grad_grad_Phi.data()->begin(),hblock);
+      gather(i,ng,(*myBasisSet->grad_grad_grad_Phi.data())[0].begin(),gblock);
     }
+    close_block_ranges();
+    product(n,BasisBlock[0],logdet.data(),logdet.cols());
+    product(OHMMS_DIM*n,BasisBlock[n]);
+    for(int i=0; i<n; i++)
+      scatter(i,OHMMS_DIM,dlogdet[i]->begin());
+    product(nh*n,hblock);
+    for(int i=0; i<n; i++)
+      scatter(i,nh,grad_grad_logdet[i]->begin());
+    product(ng*n,gblock);
+    for(int i=0; i<n; i++)
+      scatter(i,ng,(*grad_grad_grad_logdet[i])[0].begin());
   }
 
   void evaluateThirdDeriv(const ParticleSet& P, int first, int last
                           , GGGMatrix_t& grad_grad_grad_logdet)
   {
-    const ValueType* restrict cptr=C.data();
-#pragma ivdep
-    for(int i=0,ij=0, iat=first; iat<last; i++,iat++)
+    const int n=last-first;
+    const int ng=OHMMS_DIM*OHMMS_DIM*OHMMS_DIM;
+    BasisBlock.resize(ng*n,BasisSetSize);
+    BlockMask.assign(BasisSetSize,0);
+    for(int i=0, iat=first; iat<last; i++,iat++)
     {
       myBasisSet->evaluateThirdDerivOnly(P,iat);
-      const typename BS::GGGType* restrict gggptr=myBasisSet->grad_grad_grad_Phi.data();
-      for(int j=0,jk=0; j<OrbitalSetSize; j++)
-      {
-        register GGGType gggres;
-        for(int b=0; b<BasisSetSize; ++b)
-        {
-          gggres[0] +=  cptr[jk]*(gggptr[b])[0];
-          gggres[1] +=  cptr[jk]*(gggptr[b])[1];
-          gggres[2] +=  cptr[jk++]*(gggptr[b])[2];
-        }
-        grad_grad_grad_logdet(ij)=gggres;
-        ++ij;
-      }
+      add_block_ranges();
+      gather(i,ng,(*myBasisSet->grad_grad_grad_Phi.data())[0].begin(),BasisBlock[0]);
     }
+    close_block_ranges();
+    product(ng*n,BasisBlock[0]);
+    for(int i=0; i<n; i++)
+      scatter(i,ng,(*grad_grad_grad_logdet[i])[0].begin());
+  }
+
+private:
+  /** psi=C*phi over the basis functions of the centers within their cutoff
+   *
+   * The ranges are myBasisSet->ActiveRanges of the last evaluation.
+   */
+  template<typename T>
+  inline void product_active(const T* restrict phi, T* restrict psi)
+  {
+    const vector<int>& ranges(myBasisSet->ActiveRanges);
+    if(ranges.size()==2 && ranges[0]==0 && ranges[1]==BasisSetSize)
+    {
+      simd::gemv(C,phi,psi);
+      return;
+    }
+    for(int j=0; j<OrbitalSetSize; ++j)
+    {
+      const ValueType* restrict cj=C[j];
+      T res=T();
+      for(int k=0; k<ranges.size(); k+=2)
+        for(int b=ranges[k]; b<ranges[k+1]; ++b)
+          res+=cj[b]*phi[b];
+      psi[j]=res;
+    }
+  }
+
+  ///basis functions of a block of particles, one row per particle and component
+  ValueMatrix_t BasisBlock;
+  ///1 for the basis functions active for any particle of the block
+  vector<char> BlockMask;
+  ///ranges of BlockMask, in the layout of ActiveRanges
+  vector<int> BlockRanges;
+  ///orbitals of a block of particles, one row per particle and component
+  ValueMatrix_t OrbBlock;
+
+  /** copy the basis functions of the i-th particle to the rows [nc*i,nc*i+nc) of a block
+   * @param nc number of components per basis function
+   * @param src the nc components of the basis functions, contiguous
+   * @param block first row of the block
+   */
+  template<typename T>
+  inline void gather(int i, int nc, const T* restrict src, ValueType* restrict block)
+  {
+    for(int c=0; c<nc; ++c)
+    {
+      ValueType* restrict dest=block+(nc*i+c)*BasisSetSize;
+      for(int b=0; b<BasisSetSize; ++b)
+        dest[b]=src[b*nc+c];
+    }
+  }
+
+  /** copy the rows [nc*i,nc*i+nc) of OrbBlock to the orbitals of the i-th particle
+   * @param nc number of components per orbital
+   * @param dest the nc components of the orbitals, contiguous
+   */
+  inline void scatter(int i, int nc, ValueType* restrict dest)
+  {
+    for(int c=0; c<nc; ++c)
+    {
+      const ValueType* restrict src=OrbBlock[nc*i+c];
+      for(int j=0; j<OrbitalSetSize; ++j)
+        dest[j*nc+c]=src[j];
+    }
+  }
+
+  ///add the active ranges of the last particle to BlockMask
+  inline void add_block_ranges()
+  {
+    const vector<int>& ranges(myBasisSet->ActiveRanges);
+    for(int k=0; k<ranges.size(); k+=2)
+      std::fill(BlockMask.begin()+ranges[k],BlockMask.begin()+ranges[k+1],1);
+  }
+
+  ///convert BlockMask to BlockRanges, [0,BasisSetSize) without screening
+  inline void close_block_ranges()
+  {
+    BlockRanges.clear();
+    for(int b=0; b<BasisSetSize; ++b)
+    {
+      if(!BlockMask[b])
+        continue;
+      if(b==0 || !BlockMask[b-1])
+        BlockRanges.push_back(b);
+      if(b+1==BasisSetSize || !BlockMask[b+1])
+        BlockRanges.push_back(b+1);
+    }
+  }
+
+  /** orbs(r,j)=sum_b block(r,b) C(j,b) for nrows rows
+   * @param block nrows x BasisSetSize
+   * @param orbs nrows x OrbitalSetSize with the leading dimension ldo
+   *
+   * The sum runs over BlockRanges only: the basis functions outside are zero.
+   */
+  inline void product(int nrows, const ValueType* restrict block, ValueType* restrict orbs, int ldo)
+  {
+    if(BlockRanges.empty())
+    {
+      for(int r=0; r<nrows; ++r)
+        std::fill(orbs+r*ldo,orbs+r*ldo+OrbitalSetSize,ValueType());
+      return;
+    }
+    ValueType beta(0.0);
+    for(int k=0; k<BlockRanges.size(); k+=2)
+    {
+      const int b0=BlockRanges[k];
+      BLAS::gemm('T','N',OrbitalSetSize,nrows,BlockRanges[k+1]-b0,ValueType(1.0),C.data()+b0,C.cols(),
+                 block+b0,BasisSetSize,beta,orbs,ldo);
+      beta=ValueType(1.0);
+    }
+  }
+
+  ///product on OrbBlock
+  inline void product(int nrows, const ValueType* restrict block)
+  {
+    OrbBlock.resize(nrows,OrbitalSetSize);
+    product(nrows,block,OrbBlock.data(),OrbitalSetSize);
   }
 
 };
@@ -94,6 +94,13 @@ struct LocalizedBasisSet: public BasisSetBase<typename COT::value_type>
    */
   const DistanceTableData* myTable;
 
+  /** basis functions of the centers within the cutoff of the last particle
+   *
+   * Flat list of the ranges [ActiveRanges[2k],ActiveRanges[2k+1]); the
+   * basis functions outside the ranges are zero.
+   */
+  vector<int> ActiveRanges;
+
   /** constructor
    * @param ions ionic system
    * @param els electronic system
@@ -148,6 +155,22 @@ struct LocalizedBasisSet: public BasisSetBase<typename COT::value_type>
     this->resize(NumTargets);
   }
 
+  /** set the cutoff radii of the atomic orbitals
+   * @param eps threshold of the basis functions, no screening if eps<=0
+   */
+  void setCutoff(RealType eps)
+  {
+    for(int i=0; i<LOBasisSet.size(); i++)
+      LOBasisSet[i]->setCutoff(eps);
+    if(eps>0.0)
+    {
+      app_log() << "  Screening the basis functions below " << eps << endl;
+      for(int i=0; i<LOBasisSet.size(); i++)
+        app_log() << "    cutoff radius of species " << i << " = " << LOBasisSet[i]->Rmax << endl;
+    }
+    ActiveRanges.reserve(2*NumCenters);
+  }
+
   void resetParameters(const opt_variables_type& active)
   {
     //reset each unique basis functions
@@ -167,8 +190,18 @@ struct LocalizedBasisSet: public BasisSetBase<typename COT::value_type>
   inline void
   evaluateWithHessian(const ParticleSet& P, int iat)
   {
+    ActiveRanges.clear();
     for(int c=0; c<NumCenters; c++)
-      LOBasis[c]->evaluateForWalkerMove(c,iat,BasisOffset[c],Phi,dPhi,grad_grad_Phi);
+    {
+      if(isActive(c,myTable->r(myTable->M[c]+iat)))
+        LOBasis[c]->evaluateForWalkerMove(c,iat,BasisOffset[c],Phi,dPhi,grad_grad_Phi);
+      else
+      {
+        zero(c,Phi);
+        zero(c,dPhi);
+        zero(c,grad_grad_Phi);
+      }
+    }
     Counter++; // increment a conter
   }
 
@@ -176,8 +209,19 @@ struct LocalizedBasisSet: public BasisSetBase<typename COT::value_type>
   evaluateWithThirdDeriv(const ParticleSet& P, int iat)
   {
     // should only work for s,p
+    ActiveRanges.clear();
     for(int c=0; c<NumCenters; c++)
-      LOBasis[c]->evaluateForWalkerMove(c,iat,BasisOffset[c],Phi,dPhi,grad_grad_Phi,grad_grad_grad_Phi);
+    {
+      if(isActive(c,myTable->r(myTable->M[c]+iat)))
+        LOBasis[c]->evaluateForWalkerMove(c,iat,BasisOffset[c],Phi,dPhi,grad_grad_Phi,grad_grad_grad_Phi);
+      else
+      {
+        zero(c,Phi);
+        zero(c,dPhi);
+        zero(c,grad_grad_Phi);
+        zero(c,grad_grad_grad_Phi);
+      }
+    }
     Counter++; // increment a conter
   }
 
@@ -185,8 +229,14 @@ struct LocalizedBasisSet: public BasisSetBase<typename COT::value_type>
   evaluateThirdDerivOnly(const ParticleSet& P, int iat)
   {
     // should only work for s,p
+    ActiveRanges.clear();
     for(int c=0; c<NumCenters; c++)
-      LOBasis[c]->evaluateThirdDerivOnly(c,iat,BasisOffset[c],grad_grad_grad_Phi);
+    {
+      if(isActive(c,myTable->r(myTable->M[c]+iat)))
+        LOBasis[c]->evaluateThirdDerivOnly(c,iat,BasisOffset[c],grad_grad_grad_Phi);
+      else
+        zero(c,grad_grad_grad_Phi);
+    }
     Counter++; // increment a conter
   }
 
@@ -201,16 +251,32 @@ struct LocalizedBasisSet: public BasisSetBase<typename COT::value_type>
   inline void
   evaluateForWalkerMove(const ParticleSet& P, int iat)
   {
+    ActiveRanges.clear();
     for(int c=0; c<NumCenters; c++)
-      LOBasis[c]->evaluateForWalkerMove(c,iat,BasisOffset[c],Phi,dPhi,d2Phi);
+    {
+      if(isActive(c,myTable->r(myTable->M[c]+iat)))
+        LOBasis[c]->evaluateForWalkerMove(c,iat,BasisOffset[c],Phi,dPhi,d2Phi);
+      else
+      {
+        zero(c,Phi);
+        zero(c,dPhi);
+        zero(c,d2Phi);
+      }
+    }
     Counter++;
   }
 
   inline void
   evaluateForPtclMove(const ParticleSet& P, int iat)
   {
+    ActiveRanges.clear();
     for(int c=0; c<NumCenters; c++)
-      LOBasis[c]->evaluateForPtclMove(c,iat,BasisOffset[c],Phi);
+    {
+      if(isActive(c,myTable->Temp[c].r1))
+        LOBasis[c]->evaluateForPtclMove(c,iat,BasisOffset[c],Phi);
+      else
+        zero(c,Phi);
+    }
     Counter++;
     ActivePtcl=iat;
   }
@@ -218,8 +284,18 @@ struct LocalizedBasisSet: public BasisSetBase<typename COT::value_type>
   inline void
   evaluateAllForPtclMove(const ParticleSet& P, int iat)
   {
+    ActiveRanges.clear();
     for(int c=0; c<NumCenters; c++)
-      LOBasis[c]->evaluateAllForPtclMove(c,iat,BasisOffset[c],Phi,dPhi,d2Phi);
+    {
+      if(isActive(c,myTable->Temp[c].r1))
+        LOBasis[c]->evaluateAllForPtclMove(c,iat,BasisOffset[c],Phi,dPhi,d2Phi);
+      else
+      {
+        zero(c,Phi);
+        zero(c,dPhi);
+        zero(c,d2Phi);
+      }
+    }
     Counter++;
     ActivePtcl=iat;
   }
@@ -227,12 +303,47 @@ struct LocalizedBasisSet: public BasisSetBase<typename COT::value_type>
   inline void
   evaluateForPtclMoveWithHessian(const ParticleSet& P, int iat)
   {
+    ActiveRanges.clear();
     for(int c=0; c<NumCenters; c++)
-      LOBasis[c]->evaluateAllForPtclMove(c,iat,BasisOffset[c],Phi,dPhi,grad_grad_Phi);
+    {
+      if(isActive(c,myTable->Temp[c].r1))
+        LOBasis[c]->evaluateAllForPtclMove(c,iat,BasisOffset[c],Phi,dPhi,grad_grad_Phi);
+      else
+      {
+        zero(c,Phi);
+        zero(c,dPhi);
+        zero(c,grad_grad_Phi);
+      }
+    }
     Counter++;
     ActivePtcl=iat;
   }
 
+  /** return true if the center c at the distance r contributes, and add its range to ActiveRanges
+   *
+   * Adjacent ranges are merged: without screening, ActiveRanges is [0,BasisSetSize).
+   */
+  inline bool isActive(int c, RealType r)
+  {
+    if(r>=LOBasis[c]->Rmax)
+      return false;
+    if(ActiveRanges.size() && ActiveRanges.back()==BasisOffset[c])
+      ActiveRanges.back()=BasisOffset[c+1];
+    else
+    {
+      ActiveRanges.push_back(BasisOffset[c]);
+      ActiveRanges.push_back(BasisOffset[c+1]);
+    }
+    return true;
+  }
+
+  ///zero the basis functions of the center c
+  template<typename VT>
+  inline void zero(int c, VT& v)
+  {
+    std::fill(v.begin()+BasisOffset[c],v.begin()+BasisOffset[c+1],typename VT::Type_t());
+  }
+
   /** add a new set of Centered Atomic Orbitals
    * @param icenter the index of the center
    * @param aos a set of Centered Atomic Orbitals
@@ -60,6 +60,12 @@ public:
       return true;
     ReportEngine PRE(ClassName,"put(xmlNodePtr)");
     PRE.echo(cur);
+    //basis functions below screening are not evaluated, off by default
+    //enabled by a positive screening attribute, see SphericalBasisSet::setCutoff
+    RealType screening=0.0;
+    OhmmsAttributeSet bAttrib;
+    bAttrib.add(screening,"screening");
+    bAttrib.put(cur);
     //create the BasisSetType
     thisBasisSet = new ThisBasisSetType(sourcePtcl,targetPtcl);
     //create the basis set
@@ -100,6 +106,7 @@ public:
     }
     //resize the basis set
     thisBasisSet->setBasisSetSize(-1);
+    thisBasisSet->setCutoff(screening);
     myBasisSet=thisBasisSet;
     return true;
   }
@@ -292,6 +292,33 @@ struct OrbitalBase: public QMCTraits
     return ValueType();
   }
 
+  /** evaluate the gradients of the iat-th particle of a crowd of walkers
+   * @param orbs clones of this orbital, one for each walker of the crowd
+   * @param P particle sets of the walkers
+   * @param iat particle index
+   * @param grads gradients to which the gradients of the walkers are added
+   */
+  virtual void evalGrad(const vector<OrbitalBase*>& orbs, const vector<ParticleSet*>& P, int iat,
+                        vector<GradType>& grads)
+  {
+    for(int iw=0; iw<orbs.size(); ++iw)
+      grads[iw]+=orbs[iw]->evalGrad(*P[iw],iat);
+  }
+
+  /** evaluate the ratios and the gradients of a crowd of walkers
+   * @param orbs clones of this orbital, one for each walker of the crowd
+   * @param P particle sets of the walkers
+   * @param iat particle index
+   * @param ratios ratios of the walkers
+   * @param grads gradients to which the gradients of the walkers are added
+   */
+  virtual void ratioGrad(const vector<OrbitalBase*>& orbs, const vector<ParticleSet*>& P, int iat,
+                         vector<ValueType>& ratios, vector<GradType>& grads)
+  {
+    for(int iw=0; iw<orbs.size(); ++iw)
+      ratios[iw]=orbs[iw]->ratioGrad(*P[iw],iat,grads[iw]);
+  }
+
   virtual ValueType alternateRatioGrad(ParticleSet& P, int iat, GradType& grad_iat)
   {
     return 1.0;
@@ -323,6 +350,24 @@ struct OrbitalBase: public QMCTraits
    */
   virtual void restore(int iat) = 0;
 
+  /** accept or reject the moves of the iat-th particle of a crowd of walkers
+   * @param orbs clones of this orbital, one for each walker of the crowd
+   * @param P particle sets of the walkers
+   * @param iat particle index
+   * @param accepted if accepted[iw], acceptMove, otherwise restore
+   */
+  virtual void acceptMove(const vector<OrbitalBase*>& orbs, const vector<ParticleSet*>& P, int iat,
+                          const vector<bool>& accepted)
+  {
+    for(int iw=0; iw<orbs.size(); ++iw)
+    {
+      if(accepted[iw])
+        orbs[iw]->acceptMove(*P[iw],iat);
+      else
+        orbs[iw]->restore(iat);
+    }
+  }
+
   /** evalaute the ratio of the new to old orbital value
    *@param P the active ParticleSet
    *@param iat the index of a particle
@@ -384,6 +429,13 @@ struct OrbitalBase: public QMCTraits
   /** copy the internal data saved for particle-by-particle move.*/
   virtual void copyFromBuffer(ParticleSet& P, BufferType& buf)=0;
 
+  /** use the walker buffer as the storage of the internal data
+   * @param resident if true, copyFromBuffer binds the internal data to the buffer
+   *
+   * Implements the default function that does nothing: the data are copied.
+   */
+  virtual void setBufferResident(bool resident) {}
+
   /** copy the internal data saved for optimization.*/
   virtual void copyFromDerivativeBuffer(ParticleSet& P, PooledData<RealType>& buf) {};
 
@@ -445,6 +497,18 @@ struct OrbitalBase: public QMCTraits
    */
   virtual void get_ratios(ParticleSet& P, vector<ValueType>& ratios);
 
+  /** evaluate the ratios of the moves of iat by displs in one call
+   * @param P particle set, R[iat] is unchanged on exit
+   * @param iat the moved particle
+   * @param displs displacements of iat
+   * @param ratios ratio of each displacement
+   * @return false, if the ratios are left to ratio called for each move
+   */
+  virtual bool evaluateRatios(ParticleSet& P, int iat, const vector<PosType>& displs, vector<ValueType>& ratios)
+  {
+    return false;
+  }
+
   ///** copy data members from old
   // * @param old existing OrbitalBase from which all the data members are copied.
   // *
@@ -31,6 +31,25 @@ inline void transpose(const T* restrict in, T* restrict out, int m)
       out[ii++]=in[jj];
 }
 
+void SPOSetBase::evaluate(const vector<SPOSetBase*>& spos, const vector<ParticleSet*>& P, int iat,
+                          const vector<ValueVector_t*>& psi, const vector<GradVector_t*>& dpsi, const vector<ValueVector_t*>& d2psi)
+{
+  for(int iw=0; iw<spos.size(); ++iw)
+    spos[iw]->evaluate(*P[iw],iat,*psi[iw],*dpsi[iw],*d2psi[iw]);
+}
+
+void SPOSetBase::evaluateValues(ParticleSet& P, int iat, const vector<PosType>& displs, ValueMatrix_t& psiM)
+{
+  ValueVector_t psi(OrbitalSetSize);
+  for(int j=0; j<displs.size(); ++j)
+  {
+    P.makeMoveOnSphere(iat,displs[j]);
+    evaluate(P,iat,psi);
+    P.rejectMove(iat);
+    std::copy(psi.begin(),psi.end(),psiM[j]);
+  }
+}
+
 void SPOSetBase::evaluate(const ParticleSet& P, int first, int last,
                           ValueMatrix_t& logdet, GradMatrix_t& dlogdet, ValueMatrix_t& d2logdet)
 {
@@ -174,6 +174,17 @@ public:
   evaluate(const ParticleSet& P, int iat,
            ValueVector_t& psi, GradVector_t& dpsi, ValueVector_t& d2psi)=0;
 
+  /** evaluate the values at the positions of iat moved by displs
+   * @param P current ParticleSet, R[iat] is unchanged on exit
+   * @param iat active particle
+   * @param displs displacements of iat, e.g. the quadrature knots of a pseudopotential
+   * @param psiM psiM(j,k) value of the k-th SPO at the j-th position, resized by the caller
+   *
+   * The default moves iat to each position and calls evaluate.
+   */
+  virtual void
+  evaluateValues(ParticleSet& P, int iat, const vector<PosType>& displs, ValueMatrix_t& psiM);
+
   /** evaluate the values, gradients and hessians of this single-particle orbital set
    * @param P current ParticleSet
    * @param iat active particle
@@ -183,6 +194,20 @@ public:
   evaluate(const ParticleSet& P, int iat,
            ValueVector_t& psi, GradVector_t& dpsi, HessVector_t& grad_grad_psi)=0;
 
+  /** evaluate the values, gradients and laplacians of a crowd of the clones of this set
+   * @param spos clones of this set, one for each walker of the crowd
+   * @param P particle sets of the walkers
+   * @param iat active particle
+   * @param psi values of the SPOs of the walkers
+   * @param dpsi gradients of the SPOs of the walkers
+   * @param d2psi laplacians of the SPOs of the walkers
+   *
+   * The default calls evaluate of each clone.
+   */
+  virtual void
+  evaluate(const vector<SPOSetBase*>& spos, const vector<ParticleSet*>& P, int iat,
+           const vector<ValueVector_t*>& psi, const vector<GradVector_t*>& dpsi, const vector<ValueVector_t*>& d2psi);
+
   /** evaluate the values, gradients and laplacians of this single-particle orbital for [first,last)particles
    * @param P current ParticleSet
    * @param first starting index of the particles
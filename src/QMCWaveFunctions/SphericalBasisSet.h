@@ -25,6 +25,7 @@
 #include "Numerics/SphericalTensor.h"
 #include "Numerics/CartesianTensor.h"
 #include "QMCWaveFunctions/OrbitalSetTraits.h"
+#include <limits>
 
 namespace qmcplusplus
 {
@@ -82,9 +83,16 @@ struct SphericalBasisSet
   vector<ROT*> Rnl;
   ///container for the quantum-numbers
   vector<QuantumNumberType> RnlID;
+  ///cutoff radius of each radial orbital, empty if the radial orbitals are not screened
+  vector<RealType> RnlCut;
+  ///cutoff radius of the center: all the basis functions vanish beyond Rmax
+  RealType Rmax;
 
   ///the constructor
-  explicit SphericalBasisSet(int lmax, bool addsignforM=false, bool useXYZ=false):Ylm(lmax,addsignforM),XYZ(lmax),useCartesian(useXYZ) {}
+  explicit SphericalBasisSet(int lmax, bool addsignforM=false, bool useXYZ=false):Ylm(lmax,addsignforM),XYZ(lmax),useCartesian(useXYZ)
+  {
+    Rmax=std::numeric_limits<RealType>::max();
+  }
 
   ~SphericalBasisSet() { }
 
@@ -153,6 +161,89 @@ struct SphericalBasisSet
     CurrentOffset=offset;
   }
 
+  /** set the cutoff radii of the radial orbitals
+   * @param eps threshold of the basis functions and their derivatives
+   *
+   * RnlCut[nl] is the radius beyond which \f$(|R|+|R'|+|R''|)(1+r)^l < eps\f$,
+   * found on a uniform mesh of 2000 points. The mesh ends at the largest radius
+   * of the radial grids, or at 100 bohr for the analytic radial orbitals which
+   * have no grid. Radial orbitals that are not negligible at the end of the
+   * mesh, and all of them if eps<=0, are not screened.
+   */
+  void setCutoff(RealType eps)
+  {
+    const RealType rbig=std::numeric_limits<RealType>::max();
+    RnlCut.assign(Rnl.size(),rbig);
+    Rmax=rbig;
+    if(eps<=0.0)
+      return;
+    RealType rend=0.0;
+    for(int ig=0; ig<Grids.size(); ++ig)
+      rend=std::max(rend,gridRange(Grids[ig]));
+    if(rend<=0.0)
+      rend=100.0;
+    const int npts=2000;
+    const RealType delta=rend/npts;
+    Rmax=0.0;
+    for(int nl=0; nl<Rnl.size(); ++nl)
+    {
+      int l=(RnlID.size()==Rnl.size())?RnlID[nl][q_l]:Ylm.Lmax;
+      int ilast=0;
+      for(int i=1; i<=npts; ++i)
+      {
+        RealType r=delta*i;
+        Rnl[nl]->evaluateAll(r,1.0/r);
+        RealType bound=(std::abs(Rnl[nl]->Y)+std::abs(Rnl[nl]->dY)+std::abs(Rnl[nl]->d2Y))*std::pow(1.0+r,l);
+        if(bound>eps)
+          ilast=i;
+      }
+      if(ilast<npts)
+        RnlCut[nl]=delta*(ilast+1);
+      Rmax=std::max(Rmax,RnlCut[nl]);
+    }
+  }
+
+  ///largest radius of a radial grid
+  template<typename G>
+  static inline RealType gridRange(const G* agrid)
+  {
+    return agrid->rmax();
+  }
+
+  ///analytic radial orbitals have no grid
+  static inline RealType gridRange(const DummyGrid* agrid)
+  {
+    return 0.0;
+  }
+
+  ///evaluate the values of the radial orbitals, zero beyond the cutoff
+  inline void evaluateRadialValue(RealType r, RealType rinv)
+  {
+    for(int nl=0; nl<Rnl.size(); ++nl)
+    {
+      if(RnlCut.empty() || r<RnlCut[nl])
+        Rnl[nl]->evaluate(r,rinv);
+      else
+        Rnl[nl]->Y=0.0;
+    }
+  }
+
+  ///evaluate the radial orbitals and their derivatives, zero beyond the cutoff
+  inline void evaluateRadial(RealType r, RealType rinv)
+  {
+    for(int nl=0; nl<Rnl.size(); ++nl)
+    {
+      if(RnlCut.empty() || r<RnlCut[nl])
+        Rnl[nl]->evaluateAll(r,rinv);
+      else
+      {
+        Rnl[nl]->Y=0.0;
+        Rnl[nl]->dY=0.0;
+        Rnl[nl]->d2Y=0.0;
+      }
+    }
+  }
+
   inline void
   evaluateForWalkerMove(int c, int iat, int offset, ValueVector_t& psi, GradVector_t& dpsi, ValueVector_t& d2psi)
   {
@@ -171,12 +262,7 @@ struct SphericalBasisSet
     std::vector<RealType>& valueYlm = useCartesian?XYZ.XYZ:Ylm.Ylm;
     std::vector<PosType>& gradYlm = useCartesian?XYZ.gradXYZ:Ylm.gradYlm;
     std::vector<RealType>& laplYlm = useCartesian?XYZ.laplXYZ:Ylm.laplYlm;
-    typename vector<ROT*>::iterator rit(Rnl.begin()), rit_end(Rnl.end());
-    while(rit != rit_end)
-    {
-      (*rit)->evaluateAll(r,rinv);
-      ++rit;
-    }
+    evaluateRadial(r,rinv);
     vector<int>::iterator nlit(NL.begin()),nlit_end(NL.end()),lmit(LM.begin());
     while(nlit != nlit_end)
       //for(int ib=0; ib<NL.size(); ib++, offset++) {
@@ -215,12 +301,7 @@ struct SphericalBasisSet
     std::vector<RealType>& valueYlm = useCartesian?XYZ.XYZ:Ylm.Ylm;
     std::vector<PosType>& gradYlm = useCartesian?XYZ.gradXYZ:Ylm.gradYlm;
     std::vector<Tensor<RealType,3> >& hessYlm = useCartesian?XYZ.hessXYZ:Ylm.hessYlm;
-    typename vector<ROT*>::iterator rit(Rnl.begin()), rit_end(Rnl.end());
-    while(rit != rit_end)
-    {
-      (*rit)->evaluateAll(r,rinv);
-      ++rit;
-    }
+    evaluateRadial(r,rinv);
     vector<int>::iterator nlit(NL.begin()),nlit_end(NL.end()),lmit(LM.begin());
     while(nlit != nlit_end)
       //for(int ib=0; ib<NL.size(); ib++, offset++) {
@@ -721,12 +802,7 @@ struct SphericalBasisSet
       Ylm.evaluate(dr);
     }
     std::vector<RealType>& valueYlm = useCartesian?XYZ.XYZ:Ylm.Ylm;
-    typename vector<ROT*>::iterator rit(Rnl.begin()), rit_end(Rnl.end());
-    while(rit != rit_end)
-    {
-      (*rit)->evaluate(r,rinv);
-      ++rit;
-    }
+    evaluateRadialValue(r,rinv);
     vector<int>::iterator nlit(NL.begin()),nlit_end(NL.end()),lmit(LM.begin());
     while(nlit != nlit_end)
       //for(int ib=0; ib<NL.size(); ib++, offset++) {
@@ -754,12 +830,7 @@ struct SphericalBasisSet
     std::vector<RealType>& valueYlm = useCartesian?XYZ.XYZ:Ylm.Ylm;
     std::vector<PosType>& gradYlm = useCartesian?XYZ.gradXYZ:Ylm.gradYlm;
     std::vector<RealType>& laplYlm = useCartesian?XYZ.laplXYZ:Ylm.laplYlm;
-    typename vector<ROT*>::iterator rit(Rnl.begin()), rit_end(Rnl.end());
-    while(rit != rit_end)
-    {
-      (*rit)->evaluateAll(r,rinv);
-      ++rit;
-    }
+    evaluateRadial(r,rinv);
     vector<int>::iterator nlit(NL.begin()),nlit_end(NL.end()),lmit(LM.begin());
     while(nlit != nlit_end)
       //for(int ib=0; ib<NL.size(); ib++, offset++) {
@@ -793,12 +864,7 @@ struct SphericalBasisSet
       Ylm.evaluate(dr);
     }
     std::vector<RealType>& valueYlm = useCartesian?XYZ.XYZ:Ylm.Ylm;
-    typename vector<ROT*>::iterator rit(Rnl.begin()), rit_end(Rnl.end());
-    while(rit != rit_end)
-    {
-      (*rit)->evaluate(r,rinv);
-      ++rit;
-    }
+    evaluateRadialValue(r,rinv);
     vector<int>::iterator nlit(NL.begin()),nlit_end(NL.end()),lmit(LM.begin());
     while(nlit != nlit_end)
       //for(int ib=0; ib<NL.size(); ib++, offset++) {
@@ -823,12 +889,7 @@ struct SphericalBasisSet
     std::vector<RealType>& valueYlm = useCartesian?XYZ.XYZ:Ylm.Ylm;
     std::vector<PosType>& gradYlm = useCartesian?XYZ.gradXYZ:Ylm.gradYlm;
     std::vector<RealType>& laplYlm = useCartesian?XYZ.laplXYZ:Ylm.laplYlm;
-    typename vector<ROT*>::iterator rit(Rnl.begin()), rit_end(Rnl.end());
-    while(rit != rit_end)
-    {
-      (*rit)->evaluateAll(r,rinv);
-      ++rit;
-    }
+    evaluateRadial(r,rinv);
     vector<int>::iterator nlit(NL.begin()),nlit_end(NL.end()),lmit(LM.begin());
     while(nlit != nlit_end)
       //for(int ib=0; ib<NL.size(); ib++, offset++) {
@@ -866,12 +927,7 @@ struct SphericalBasisSet
     std::vector<RealType>& valueYlm = useCartesian?XYZ.XYZ:Ylm.Ylm;
     std::vector<PosType>& gradYlm = useCartesian?XYZ.gradXYZ:Ylm.gradYlm;
     std::vector<Tensor<RealType,3> >& hessYlm = useCartesian?XYZ.hessXYZ:Ylm.hessYlm;
-    typename vector<ROT*>::iterator rit(Rnl.begin()), rit_end(Rnl.end());
-    while(rit != rit_end)
-    {
-      (*rit)->evaluateAll(r,rinv);
-      ++rit;
-    }
+    evaluateRadial(r,rinv);
     vector<int>::iterator nlit(NL.begin()),nlit_end(NL.end()),lmit(LM.begin());
     while(nlit != nlit_end)
       //for(int ib=0; ib<NL.size(); ib++, offset++) {
@@ -10,6 +10,8 @@
  */
 #ifndef QMCPLUSPLUS_EINSPLINE_BASE_ADOPTOR_READER_H
 #define QMCPLUSPLUS_EINSPLINE_BASE_ADOPTOR_READER_H
+#include <spline/einspline_shm.hpp>
+#include <spline/einspline_cache.hpp>
 namespace qmcplusplus
 {
 
@@ -186,7 +188,7 @@ struct SplineAdoptorReader: public BsplineReaderBase
   {
     ReportEngine PRE("SplineC2XAdoptorReader","create_spline_set(spin,SPE*)");
     Timer c_prep, c_unpack,c_fft, c_phase, c_spline, c_newphase, c_h5, c_init;
-    double t_prep=0.0, t_unpack=0.0, t_fft=0.0, t_phase=0.0, t_spline=0.0, t_newphase=0.0, t_h5=0.0, t_init=0.0;
+    double t_prep=0.0, t_unpack=0.0, t_fft=0.0, t_phase=0.0, t_spline=0.0, t_newphase=0.0, t_h5=0.0, t_init=0.0, t_gather=0.0;
     BsplineSet<adoptor_type>* bspline=new BsplineSet<adoptor_type>;
     app_log() << "  AdoptorName = " << bspline->AdoptorName << endl;
     if(bspline->is_complex)
@@ -207,9 +209,26 @@ struct SplineAdoptorReader: public BsplineReaderBase
     string splinefile
     =make_spline_filename(mybuilder->H5FileName,mybuilder->TileMatrix
                           ,spin,TwistNum,mybuilder->MeshSize);
+    string cachefile=make_spline_cachename(splinefile);
     bool root=(myComm->rank() == 0);
     int foundspline=0;
     Timer now;
+    //every task maps the native cache: no read and bcast
+    if(map_spline_cache(myComm,cachefile,bspline->MultiSpline,bspline->AdoptorName,mybuilder->H5FileName))
+    {
+      app_log() << "Use existing bspline cache in " << cachefile << endl;
+      app_log() << "    READBANDS::MMAP   = " << now.elapsed() << endl;
+      return bspline;
+    }
+    //with a node-shared table, only the first task of each node fills it over fillComm
+    SharedSplineTable* shm=mybuilder->SharedTable;
+    Communicate* fillComm=myComm;
+    if(shm)
+    {
+      shm->attach(bspline->MultiSpline);
+      fillComm=shm->FillComm;
+    }
+    bool filler=(shm == 0 || shm->isFiller());
     if(root)
     {
       hdf_archive h5f;
@@ -234,7 +253,8 @@ struct SplineAdoptorReader: public BsplineReaderBase
     if(foundspline)
     {
       app_log() << "Use existing bspline tables in " << splinefile << endl;
-      chunked_bcast(myComm, bspline->MultiSpline);
+      if(filler)
+        chunked_bcast(fillComm, bspline->MultiSpline);
       t_init+=now.elapsed();
     }
     else
@@ -249,39 +269,109 @@ struct SplineAdoptorReader: public BsplineReaderBase
        * - extended orbitals either in G or in R
        * - localized orbitals
        */
-      Array<DataType,3> splineData_r(nx,ny,nz),splineData_i(ny,ny,nz);
       if(havePsig)//perform FFT using FFTW
       {
         c_init.restart();
-        Array<complex<double>,3> FFTbox;
-        FFTbox.resize(nx, ny, nz);
-        fftw_plan FFTplan = fftw_plan_dft_3d(nx, ny, nz,
-                                             reinterpret_cast<fftw_complex*>(FFTbox.data()),
-                                             reinterpret_cast<fftw_complex*>(FFTbox.data()),
-                                             +1, FFTW_ESTIMATE);
-        Vector<complex<double> > cG(mybuilder->MaxNumGvecs);
-        //this will be parallelized with OpenMP
-        for(int iorb=0; iorb<N; ++iorb)
+        //the rank ip transforms the orbitals [OrbGroups[ip],OrbGroups[ip+1]) with the OpenMP threads
+        int np=std::min(N,fillComm->size());
+        vector<int> OrbGroups(np+1,0);
+        FairDivideLow(N,np,OrbGroups);
+        int ip=filler?fillComm->rank():np;
+        int iorb_first=(ip<np)?OrbGroups[ip]:N;
+        int iorb_last=(ip<np)?OrbGroups[ip+1]:N;
+        //a complex table stores the real and imaginary parts of an orbital in two splines
+        int nsplines=bspline->is_complex?2:1;
+        vector<int> SplineGroups(np+1);
+        for(int k=0; k<=np; ++k)
+          SplineGroups[k]=nsplines*OrbGroups[k];
+        int ngvecs=mybuilder->Gvecs[0].size();
+        hdf_archive h5f(myComm,false);
+        if(iorb_first<iorb_last)
+          h5f.open(mybuilder->H5FileName,H5F_ACC_RDONLY);
+        bool foundit=true;
+        int nbadg=0;
+        t_prep+=c_init.elapsed();
+        #pragma omp parallel reduction(+:nbadg)
         {
-          int ti=SortBands[iorb].TwistIndex;
-          get_psi_g(ti,spin,SortBands[iorb].BandIndex,cG);
-          c_unpack.restart();
-          unpack4fftw(cG,mybuilder->Gvecs[0],mybuilder->MeshSize,FFTbox);
-          t_unpack+= c_unpack.elapsed();
-          c_fft.restart();
-          fftw_execute (FFTplan);
-          t_fft+= c_fft.elapsed();
-          c_phase.restart();
+          Timer clock;
+          double my_h5=0.0, my_unpack=0.0, my_fft=0.0, my_phase=0.0, my_spline=0.0;
+          Array<complex<double>,3> FFTbox(nx,ny,nz);
+          Array<DataType,3> splineData_r(nx,ny,nz),splineData_i;
           if(bspline->is_complex)
-            fix_phase_rotate_c2c(FFTbox,splineData_r, splineData_i,mybuilder->TwistAngles[ti]);
-          else
-            fix_phase_rotate_c2r(FFTbox,splineData_r, mybuilder->TwistAngles[ti]);
-          t_phase+= c_phase.elapsed();
-          c_spline.restart();
-          bspline->set_spline(splineData_r.data(),splineData_i.data(),ti,iorb,0);
-          t_spline+= c_spline.elapsed();
+            splineData_i.resize(nx,ny,nz);
+          Vector<complex<double> > cG(ngvecs);
+          fftw_plan FFTplan;
+          #pragma omp critical
+          {
+            FFTplan = fftw_plan_dft_3d(nx, ny, nz,
+                                       reinterpret_cast<fftw_complex*>(FFTbox.data()),
+                                       reinterpret_cast<fftw_complex*>(FFTbox.data()),
+                                       +1, FFTW_ESTIMATE);
+          }
+          //each thread transforms a contiguous block of the orbitals
+          #pragma omp for schedule(static)
+          for(int iorb=iorb_first; iorb<iorb_last; ++iorb)
+          {
+            int ti=SortBands[iorb].TwistIndex;
+            clock.restart();
+            //hdf5 is not thread safe
+            #pragma omp critical
+            {
+              foundit &= h5f.read(cG,psi_g_path(ti,spin,SortBands[iorb].BandIndex));
+            }
+            my_h5+= clock.elapsed();
+            if(cG.size() != ngvecs)
+            {
+              nbadg++;
+              continue;
+            }
+            clock.restart();
+            unpack4fftw(cG,mybuilder->Gvecs[0],mybuilder->MeshSize,FFTbox);
+            my_unpack+= clock.elapsed();
+            clock.restart();
+            fftw_execute (FFTplan);
+            my_fft+= clock.elapsed();
+            clock.restart();
+            if(bspline->is_complex)
+              fix_phase_rotate_c2c(FFTbox,splineData_r, splineData_i,mybuilder->TwistAngles[ti]);
+            else
+              fix_phase_rotate_c2r(FFTbox,splineData_r, mybuilder->TwistAngles[ti]);
+            my_phase+= clock.elapsed();
+            clock.restart();
+            bspline->set_spline(splineData_r.data(),splineData_i.data(),ti,iorb,0);
+            my_spline+= clock.elapsed();
+          }
+          #pragma omp critical
+          {
+            fftw_destroy_plan(FFTplan);
+          }
+          //the threads run concurrently, the master reports its own times
+          #pragma omp master
+          {
+            t_h5+=my_h5;
+            t_unpack+=my_unpack;
+            t_fft+=my_fft;
+            t_phase+=my_phase;
+            t_spline+=my_spline;
+          }
+        }
+        //failed reads and psi_g of a wrong size
+        vector<int> nfailed(2);
+        nfailed[0]=!foundit;
+        nfailed[1]=nbadg;
+        myComm->allreduce(nfailed);
+        if(nfailed[0])
+        {
+          APP_ABORT("SplineAdoptorReader Failed to read band(s)");
+        }
+        if(nfailed[1])
+        {
+          APP_ABORT("Failed : ncg != Gvecs[0].size()");
         }
-        fftw_destroy_plan(FFTplan);
+        c_spline.restart();
+        if(filler)
+          gather_splines(fillComm, bspline->MultiSpline, SplineGroups);
+        t_gather=c_spline.elapsed();
         t_init+=c_init.elapsed();
       }
       //else
@@ -313,12 +403,20 @@ struct SplineAdoptorReader: public BsplineReaderBase
         bspline->write_splines(h5f);
       }
     }
+    if(qmc_common.save_wfs && root)
+    {
+      if(!write_spline_cache(cachefile,bspline->MultiSpline,bspline->AdoptorName,mybuilder->H5FileName))
+        app_warning() << "  Failed to write bspline cache " << cachefile << endl;
+    }
+    if(shm)
+      shm->fence();
     app_log() << "    READBANDS::PREP   = " << t_prep << endl;
     app_log() << "    READBANDS::H5     = " << t_h5 << endl;
     app_log() << "    READBANDS::UNPACK = " << t_unpack << endl;
     app_log() << "    READBANDS::FFT    = " << t_fft << endl;
     app_log() << "    READBANDS::PHASE  = " << t_phase << endl;
     app_log() << "    READBANDS::SPLINE = " << t_spline << endl;
+    app_log() << "    READBANDS::GATHER = " << t_gather << endl;
     app_log() << "    READBANDS::SUM    = " << t_init << endl;
     return bspline;
   }
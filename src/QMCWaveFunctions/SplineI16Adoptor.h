@@ -0,0 +1,59 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim and Ken Esler           //
+//////////////////////////////////////////////////////////////////
+/** @file SplineI16Adoptor.h
+ *
+ * Real orbitals on a 16-bit spline table, evaluated in ST precision
+ */
+#ifndef QMCPLUSPLUS_EINSPLINE_I16ADOPTOR_H
+#define QMCPLUSPLUS_EINSPLINE_I16ADOPTOR_H
+
+#include <spline/einspline_i16.hpp>
+
+namespace qmcplusplus
+{
+
+/** adoptor class to match a real spline with 16-bit coefficients with TT real SPOs
+ * @tparam ST precision of the evaluation
+ * @tparam TT precision of SPOs
+ * @tparam D dimension
+ *
+ * The coefficients are scaled by blocks, see multi_UBspline_3d_i16. Only the
+ * table differs from SplineR2RAdoptor<ST,TT,D>, which stores and evaluates it.
+ * The scale factors are written next to the coefficients.
+ */
+template<typename ST, typename TT, unsigned D>
+struct SplineI16Adoptor: public SplineR2RAdoptor<ST,TT,D,multi_UBspline_3d_i16>
+{
+  typedef SplineR2RAdoptor<ST,TT,D,multi_UBspline_3d_i16> BaseType;
+  typedef typename BaseType::SplineType SplineType;
+
+  using BaseType::MultiSpline;
+
+  SplineI16Adoptor()
+  {
+    this->AdoptorName="SplineI16Adoptor";
+    this->KeyWord="I16";
+  }
+
+  bool read_splines(hdf_archive& h5f)
+  {
+    einspline_engine<SplineType> bigtable(MultiSpline);
+    vector<float> scales(MultiSpline->scale_size());
+    bool success=h5f.read(bigtable,"spline_0") && h5f.read(scales,"scale_0")
+                 && scales.size() == MultiSpline->scale_size();
+    if(success)
+      std::copy(scales.begin(),scales.end(),MultiSpline->scales());
+    return success;
+  }
+
+  bool write_splines(hdf_archive& h5f)
+  {
+    einspline_engine<SplineType> bigtable(MultiSpline);
+    vector<float> scales(MultiSpline->scales(),MultiSpline->scales()+MultiSpline->scale_size());
+    return h5f.write(bigtable,"spline_0") && h5f.write(scales,"scale_0");
+  }
+};
+
+}
+#endif
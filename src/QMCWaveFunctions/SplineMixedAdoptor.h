@@ -164,6 +164,14 @@ struct SplineMixedAdoptor: public SplineR2RAdoptor<ST,TT,D>
     this->assign_v(r,bc_sign,psi);
   }
 
+  ///the crowd kernel does not handle the small box: evaluate one by one
+  template<typename VV, typename GV>
+  inline bool evaluate_vgl_crowd(const vector<PointType>& r
+                                 , const vector<VV*>& psi, const vector<GV*>& dpsi, const vector<VV*>& d2psi)
+  {
+    return false;
+  }
+
   template<typename VV, typename GV>
   inline void evaluate_vgl(const PointType& r, VV& psi, GV& dpsi, VV& d2psi)
   {
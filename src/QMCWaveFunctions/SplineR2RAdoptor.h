@@ -4,6 +4,8 @@
 #ifndef QMCPLUSPLUS_EINSPLINE_R2RADOPTOR_H
 #define QMCPLUSPLUS_EINSPLINE_R2RADOPTOR_H
 
+#include <spline/einspline_crowd.hpp>
+
 namespace qmcplusplus
 {
 
@@ -11,11 +13,12 @@ namespace qmcplusplus
  * @tparam ST precision of spline
  * @tparam TT precision of SPOs
  * @tparam D dimension
+ * @tparam MST multi-spline table, the ST multi-spline by default
  */
-template<typename ST, typename TT, unsigned D>
+template<typename ST, typename TT, unsigned D, typename MST=typename einspline_traits<ST,D>::SplineType>
 struct SplineR2RAdoptor: public SplineAdoptorBase<ST,D>
 {
-  typedef typename einspline_traits<ST,D>::SplineType SplineType;
+  typedef MST SplineType;
   typedef typename einspline_traits<ST,D>::BCType     BCType;
   typedef typename SplineAdoptorBase<ST,D>::PointType PointType;
   typedef typename SplineAdoptorBase<ST,D>::SingleSplineType SingleSplineType;
@@ -38,6 +41,17 @@ struct SplineR2RAdoptor: public SplineAdoptorBase<ST,D>
   ///offset of the original grid, always 0
   int BaseOffset[3];
 
+  ///positions in the unit cell of a crowd
+  vector<PointType> crowdU;
+  ///signs of the positions of a crowd
+  vector<int> crowdSign;
+  ///results of a crowd, see eval_multi_UBspline_3d_vgh_crowd
+  vector<ST> crowdOut;
+  ///weights of the stencils of a crowd
+  vector<ST> crowdWeights;
+  ///offsets of the stencils of a crowd
+  vector<intptr_t> crowdOffset;
+
   SplineR2RAdoptor(): MultiSpline(0)
   {
     this->is_complex=false;
@@ -183,6 +197,61 @@ struct SplineR2RAdoptor: public SplineAdoptorBase<ST,D>
     assign_vgl(r,bc_sign,psi,dpsi,d2psi);
   }
 
+  /** evaluate the values, gradients and laplacians of a crowd of positions
+   * @param table spline table
+   * @param scale block scale factors of the table, 0 if not scaled
+   * @param r positions of the crowd
+   * @param psi values of the walkers
+   * @param dpsi gradients of the walkers
+   * @param d2psi laplacians of the walkers
+   */
+  template<typename SPT, typename VV, typename GV>
+  inline void crowd_vgl(const SPT* table, const float* scale, const vector<PointType>& r
+                        , const vector<VV*>& psi, const vector<GV*>& dpsi, const vector<VV*>& d2psi)
+  {
+    const int nw=r.size();
+    const int ns=myV.size();
+    crowdU.resize(nw);
+    crowdSign.resize(nw);
+    crowdOut.resize(nw*CROWD_ROWS*ns);
+    crowdWeights.resize(nw*CROWD_WEIGHTS);
+    crowdOffset.resize(nw);
+    for(int iw=0; iw<nw; ++iw)
+      crowdSign[iw]=convertPos(r[iw],crowdU[iw]);
+    eval_multi_UBspline_3d_vgh_crowd(table,scale,nw,&crowdU[0],&crowdOut[0],ns,&crowdWeights[0],&crowdOffset[0]);
+    const Tensor<ST,D> gConv(PrimLattice.G);
+    //the hessians are symmetric: trace(H,GGt) from the upper triangle
+    const ST g00=GGt(0,0), g11=GGt(1,1), g22=GGt(2,2);
+    const ST g01=GGt(0,1)+GGt(1,0), g02=GGt(0,2)+GGt(2,0), g12=GGt(1,2)+GGt(2,1);
+    for(int iw=0; iw<nw; ++iw)
+    {
+      const ST* restrict o=&crowdOut[iw*CROWD_ROWS*ns];
+      const ST s=(crowdSign[iw]&1)? -1.0:1.0;
+      VV& v(*psi[iw]);
+      GV& g(*dpsi[iw]);
+      VV& l(*d2psi[iw]);
+      for(int psiIndex=first_spo,j=0; psiIndex<last_spo; ++psiIndex,++j)
+      {
+        TinyVector<ST,D> gu(o[CROWD_GX*ns+j],o[CROWD_GY*ns+j],o[CROWD_GZ*ns+j]);
+        v[psiIndex]=s*o[CROWD_V*ns+j];
+        g[psiIndex]=s*dot(gConv,gu);
+        l[psiIndex]=s*(g00*o[CROWD_HXX*ns+j]+g11*o[CROWD_HYY*ns+j]+g22*o[CROWD_HZZ*ns+j]
+                       +g01*o[CROWD_HXY*ns+j]+g02*o[CROWD_HXZ*ns+j]+g12*o[CROWD_HYZ*ns+j]);
+      }
+    }
+  }
+
+  /** evaluate the values, gradients and laplacians of a crowd with one kernel call
+   * @return true
+   */
+  template<typename VV, typename GV>
+  inline bool evaluate_vgl_crowd(const vector<PointType>& r
+                                 , const vector<VV*>& psi, const vector<GV*>& dpsi, const vector<VV*>& d2psi)
+  {
+    crowd_vgl(MultiSpline,spline_scales(MultiSpline),r,psi,dpsi,d2psi);
+    return true;
+  }
+
   template<typename VV, typename GV, typename GGV>
   void assign_vgh(const PointType& r, int bc_sign, VV& psi, GV& dpsi, GGV& grad_grad_psi)
   {
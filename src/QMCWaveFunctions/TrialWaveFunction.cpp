@@ -348,6 +348,44 @@ TrialWaveFunction::RealType TrialWaveFunction::ratio(ParticleSet& P,int iat)
 #endif
 }
 
+void TrialWaveFunction::NLratios(ParticleSet& P, int iat,
+                                 const vector<PosType>& displs, vector<RealType>& ratios)
+{
+  const int nknot=displs.size();
+  vector<ValueType> knot_ratios(nknot,ValueType(1.0)), z_ratios;
+  //the components with a multi-position path, e.g. the determinants, take all the moves at once
+  vector<OrbitalBase*> per_move;
+  for (int i=0; i<Z.size(); ++i)
+  {
+    if(Z[i]->evaluateRatios(P,iat,displs,z_ratios))
+    {
+      for (int j=0; j<nknot; ++j)
+        knot_ratios[j] *= z_ratios[j];
+    }
+    else
+      per_move.push_back(Z[i]);
+  }
+  if(per_move.size())
+  {
+    for (int j=0; j<nknot; ++j)
+    {
+      P.makeMoveOnSphere(iat,displs[j]);
+      for (int i=0; i<per_move.size(); ++i)
+        knot_ratios[j] *= per_move[i]->ratio(P,iat);
+      P.rejectMove(iat);
+    }
+  }
+  ratios.resize(nknot);
+  for (int j=0; j<nknot; ++j)
+#if defined(QMC_COMPLEX)
+    ratios[j]=real(knot_ratios[j]);
+#else
+    ratios[j]=knot_ratios[j];
+#endif
+  //none of the moves is accepted
+  PhaseDiff=0.0;
+}
+
 TrialWaveFunction::RealType TrialWaveFunction::ratioVector(ParticleSet& P, int iat, std::vector<RealType>& ratios)
 {
   //TAU_PROFILE("TrialWaveFunction::ratio","(ParticleSet& P,int iat)", TAU_USER);
@@ -563,6 +601,73 @@ void   TrialWaveFunction::acceptMove(ParticleSet& P,int iat)
     LogValue+= Z[i]->LogValue;
 }
 
+void TrialWaveFunction::evalGrad(const vector<TrialWaveFunction*>& psi, const vector<ParticleSet*>& P
+                                 , int iat, vector<GradType>& grads)
+{
+  int nw=psi.size();
+  vector<OrbitalBase*> orbs(nw);
+  std::fill(grads.begin(),grads.end(),GradType());
+  for (int i=0; i<psi[0]->Z.size(); ++i)
+  {
+    for(int iw=0; iw<nw; ++iw)
+      orbs[iw]=psi[iw]->Z[i];
+    orbs[0]->evalGrad(orbs,P,iat,grads);
+  }
+}
+
+void TrialWaveFunction::ratioGrad(const vector<TrialWaveFunction*>& psi, const vector<ParticleSet*>& P
+                                  , int iat, vector<RealType>& ratios, vector<GradType>& grads)
+{
+  int nw=psi.size();
+  vector<OrbitalBase*> orbs(nw);
+  vector<ValueType> r(nw,1.0), r_i(nw);
+  std::fill(grads.begin(),grads.end(),GradType());
+  for (int i=0; i<psi[0]->Z.size(); ++i)
+  {
+    for(int iw=0; iw<nw; ++iw)
+      orbs[iw]=psi[iw]->Z[i];
+    orbs[0]->ratioGrad(orbs,P,iat,r_i,grads);
+    for(int iw=0; iw<nw; ++iw)
+      r[iw]*=r_i[iw];
+  }
+  for(int iw=0; iw<nw; ++iw)
+  {
+#if defined(QMC_COMPLEX)
+    RealType logr=evaluateLogAndPhase(r[iw],psi[iw]->PhaseValue);
+    ratios[iw]=std::exp(logr);
+#else
+    if (r[iw]<0)
+      psi[iw]->PhaseDiff=M_PI;
+    ratios[iw]=r[iw];
+#endif
+  }
+}
+
+void TrialWaveFunction::acceptMove(const vector<TrialWaveFunction*>& psi, const vector<ParticleSet*>& P
+                                   , int iat, const vector<bool>& accepted)
+{
+  int nw=psi.size();
+  vector<OrbitalBase*> orbs(nw);
+  for (int i=0; i<psi[0]->Z.size(); ++i)
+  {
+    for(int iw=0; iw<nw; ++iw)
+      orbs[iw]=psi[iw]->Z[i];
+    orbs[0]->acceptMove(orbs,P,iat,accepted);
+  }
+  for(int iw=0; iw<nw; ++iw)
+  {
+    TrialWaveFunction& twf=*psi[iw];
+    if(accepted[iw])
+    {
+      twf.PhaseValue += twf.PhaseDiff;
+      twf.LogValue=0;
+      for (int i=0; i<twf.Z.size(); i++)
+        twf.LogValue+= twf.Z[i]->LogValue;
+    }
+    twf.PhaseDiff=0.0;
+  }
+}
+
 //void TrialWaveFunction::resizeByWalkers(int nwalkers){
 //  for(int i=0; i<Z.size(); i++) Z[i]->resizeByWalkers(nwalkers);
 //}
@@ -695,6 +800,19 @@ void TrialWaveFunction::copyFromBuffer(ParticleSet& P, PooledData<RealType>& buf
   buf.get(&(P.L[0]), &(P.L[0])+NumPtcls);
 }
 
+/** bind the internal data to the walker buffer
+ * @param resident if true, copyFromBuffer binds the large data to the buffer
+ *
+ * With resident components, copyFromBuffer costs O(1) and the moves update
+ * the walker buffer in place. The components which do not support it keep
+ * copying the data.
+ */
+void TrialWaveFunction::setBufferResident(bool resident)
+{
+  for (int i=0; i<Z.size(); i++)
+    Z[i]->setBufferResident(resident);
+}
+
 /** Dump data that are required to evaluate ratios to the buffer
 * @param P active ParticleSet
 * @param buf anonymous buffer to which the data will be dumped.
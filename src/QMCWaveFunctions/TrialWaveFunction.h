@@ -234,6 +234,13 @@ public:
   /** functions to handle particle-by-particle update */
   RealType ratio(ParticleSet& P, int iat);
   RealType ratioVector(ParticleSet& P, int iat, std::vector<RealType>& ratios);
+  /** evaluate the ratios of the moves of iat by displs in one call
+   * @param P particle set, R[iat] is unchanged on exit
+   * @param iat the moved particle
+   * @param displs displacements of iat
+   * @param ratios real parts of the ratios, one per displacement
+   */
+  void NLratios(ParticleSet& P, int iat, const vector<PosType>& displs, vector<RealType>& ratios);
   RealType alternateRatio(ParticleSet& P);
 
   void update(ParticleSet& P, int iat);
@@ -262,11 +269,30 @@ public:
   void rejectMove(int iat);
   void acceptMove(ParticleSet& P, int iat);
 
+  /** @{ lock-step moves of the iat-th particle of a crowd of walkers
+   * @param psi clones of a trial wave function, one for each walker
+   * @param P particle sets of the walkers
+   * @param iat particle index
+   *
+   * Equivalent to the calls of each walker. The components of the crowd are
+   * called together so that they can evaluate the walkers at once.
+   */
+  static void evalGrad(const vector<TrialWaveFunction*>& psi, const vector<ParticleSet*>& P, int iat,
+                       vector<GradType>& grads);
+  static void ratioGrad(const vector<TrialWaveFunction*>& psi, const vector<ParticleSet*>& P, int iat,
+                        vector<RealType>& ratios, vector<GradType>& grads);
+  ///accept the moves of the walkers with accepted[iw] and reject the others
+  static void acceptMove(const vector<TrialWaveFunction*>& psi, const vector<ParticleSet*>& P, int iat,
+                         const vector<bool>& accepted);
+  /** @} */
+
   RealType registerData(ParticleSet& P, BufferType& buf);
   RealType registerDataForDerivatives(ParticleSet& P, BufferType& buf, int storageType=0);
   void memoryUsage_DataForDerivatives(ParticleSet& P,long& orbs_only,long& orbs, long& invs, long& dets);
   RealType updateBuffer(ParticleSet& P, BufferType& buf, bool fromscratch=false);
   void copyFromBuffer(ParticleSet& P, BufferType& buf);
+  ///bind the internal data of the components to the walker buffer or not
+  void setBufferResident(bool resident);
   RealType evaluateLog(ParticleSet& P, BufferType& buf);
 
   void dumpToBuffer(ParticleSet& P, BufferType& buf);
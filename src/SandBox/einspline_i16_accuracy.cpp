@@ -0,0 +1,216 @@
+/** @file einspline_i16_accuracy.cpp
+ * @brief Accuracy of the 16-bit spline tables against the float tables
+ *
+ * Reference system: the closed-shell free-electron gas in a unit cube, with the
+ * real orbitals cos(k.r) and sin(k.r) on a nx^3 grid. For each table, reports the
+ * rms errors of the values, gradients and laplacians with respect to the analytic
+ * orbitals, and the Monte Carlo estimate of the kinetic energy per electron
+ *   T = V/N < sum_n -1/2 phi_n lap(phi_n) >
+ * with its variance, which is compared with the exact value sum_n |k_n|^2/2/N.
+ * The 16-bit tables are also compared with the float table at the same samples:
+ * dT/N is the correlated difference of the kinetic energies with its error bar
+ * and dvar the difference of the variances. -n uses the natural boundary
+ * conditions on ng+1 points to check the non-periodic tables.
+ */
+#include <Configuration.h>
+#include <Utilities/RandomGenerator.h>
+#include <Utilities/OhmmsInfo.h>
+#include <Utilities/Timer.h>
+#include <Message/Communicate.h>
+#include <OhmmsPETE/OhmmsVector.h>
+#include <OhmmsPETE/OhmmsArray.h>
+#include <OhmmsPETE/TinyVector.h>
+#include <OhmmsPETE/Tensor.h>
+#include <simd/simd.hpp>
+#include <spline/einspline_i16.hpp>
+#include <getopt.h>
+using namespace qmcplusplus;
+
+///running mean and variance
+struct stat_type
+{
+  double sum, sum2;
+  int n;
+  stat_type(): sum(0.0), sum2(0.0), n(0) {}
+  inline void operator()(double x)
+  {
+    sum+=x;
+    sum2+=x*x;
+    ++n;
+  }
+  inline double mean() const
+  {
+    return sum/n;
+  }
+  inline double variance() const
+  {
+    return sum2/n-mean()*mean();
+  }
+  inline double rms() const
+  {
+    return std::sqrt(sum2/n);
+  }
+  inline double error() const
+  {
+    return std::sqrt(variance()/(n-1));
+  }
+};
+
+///errors and kinetic energy of a table
+struct table_report
+{
+  stat_type dv, dg, dl, ekin;
+  ///difference of the kinetic energy from the reference table, sample by sample
+  stat_type dekin;
+  ///kinetic energy of the last sample
+  double t_last;
+  table_report(): t_last(0.0) {}
+  template<typename T>
+  void add(const std::vector<TinyVector<double,3> >& kpts, const TinyVector<double,3>& r,
+           const Vector<T>& v, const Vector<TinyVector<T,3> >& g, const Vector<Tensor<T,3> >& h, double norm)
+  {
+    double t=0.0;
+    for(int n=0; n<v.size(); ++n)
+    {
+      const TinyVector<double,3>& k(kpts[n/2]);
+      double kr=dot(k,r);
+      double c=norm*std::cos(kr), s=norm*std::sin(kr);
+      double v0=(n%2)?s:c;
+      TinyVector<double,3> g0=((n%2)?c:-s)*k;
+      double l0=-dot(k,k)*v0;
+      double l=h[n](0,0)+h[n](1,1)+h[n](2,2);
+      dv(v[n]-v0);
+      for(int d=0; d<3; ++d)
+        dg(g[n][d]-g0[d]);
+      dl(l-l0);
+      t+=-0.5*v[n]*l;
+    }
+    ekin(t);
+    t_last=t;
+  }
+  ///accumulate the difference from the reference table at the same sample
+  inline void compare(const table_report& ref)
+  {
+    dekin(t_last-ref.t_last);
+  }
+  void print(const char* name, double nel, double mbytes, const table_report& ref)
+  {
+    app_log() << setw(8) << name << setw(10) << mbytes
+              << setw(14) << dv.rms() << setw(14) << dg.rms() << setw(14) << dl.rms()
+              << setw(14) << ekin.mean()/nel << setw(14) << ekin.variance()/nel/nel;
+    if(dekin.n)
+      app_log() << setw(14) << dekin.mean()/nel << " +/- " << setw(10) << dekin.error()/nel
+                << setw(14) << (ekin.variance()-ref.ekin.variance())/nel/nel;
+    app_log() << endl;
+  }
+};
+
+int main(int argc, char** argv)
+{
+  OHMMS::Controller->initialize(argc,argv);
+  Communicate* mycomm=OHMMS::Controller;
+  OhmmsInfo Welcome("einspline_i16_accuracy",mycomm->rank());
+  Random.init(0,1,11);
+  int ng=32;
+  int nshells=3;
+  int nsamples=10000;
+  bool periodic=true;
+  int opt;
+  while((opt = getopt(argc, argv, "hg:k:s:n")) != -1)
+  {
+    switch(opt)
+    {
+    case 'h':
+      printf("-g grid -k max |n| of k=2pi*n -s samples -n natural boundary conditions\n");
+      return 1;
+    case 'n':
+      periodic=false;
+      break;
+    case 'g':
+      ng=atoi(optarg);
+      break;
+    case 'k':
+      nshells=atoi(optarg);
+      break;
+    case 's':
+      nsamples=atoi(optarg);
+      break;
+    }
+  }
+  //k=2pi*n in the half space, k=0 excluded: a cos and a sin orbital for each
+  std::vector<TinyVector<double,3> > kpts;
+  double ekin_exact=0.0;
+  for(int i=-nshells; i<=nshells; ++i)
+    for(int j=-nshells; j<=nshells; ++j)
+      for(int k=-nshells; k<=nshells; ++k)
+      {
+        if(i*i+j*j+k*k>nshells*nshells)
+          continue;
+        if(i>0 || (i==0 && (j>0 || (j==0 && k>0))))
+        {
+          kpts.push_back(TinyVector<double,3>(2*M_PI*i,2*M_PI*j,2*M_PI*k));
+          ekin_exact+=dot(kpts.back(),kpts.back());
+        }
+      }
+  int norb=2*kpts.size();
+  double norm=std::sqrt(2.0);
+  //the non-periodic grids include both ends of the cube
+  int np=periodic? ng: ng+1;
+  Ugrid grid[3];
+  BCtype_s bc_s[3];
+  for(int d=0; d<3; ++d)
+  {
+    grid[d].start=0.0;
+    grid[d].end=1.0;
+    grid[d].num=np;
+    bc_s[d].lCode=bc_s[d].rCode=periodic? PERIODIC: NATURAL;
+    bc_s[d].lVal=bc_s[d].rVal=0.0;
+  }
+  multi_UBspline_3d_s* spline_s=create_multi_UBspline_3d_s(grid[0],grid[1],grid[2],bc_s[0],bc_s[1],bc_s[2],norb);
+  multi_UBspline_3d_i16* spline_q=einspline::create((multi_UBspline_3d_i16*)0,grid,bc_s,norb);
+  Array<float,3> data(np,np,np);
+  for(int n=0; n<norb; ++n)
+  {
+    const TinyVector<double,3>& k(kpts[n/2]);
+    for(int i=0; i<np; ++i)
+      for(int j=0; j<np; ++j)
+        for(int l=0; l<np; ++l)
+        {
+          double kr=dot(k,TinyVector<double,3>(double(i)/ng,double(j)/ng,double(l)/ng));
+          data(i,j,l)=norm*((n%2)?std::sin(kr):std::cos(kr));
+        }
+    set_multi_UBspline_3d_s(spline_s,n,data.data());
+    einspline::set(spline_q,n,data.data());
+  }
+  Vector<float> v_s(norb);
+  Vector<TinyVector<float,3> > g_s(norb);
+  Vector<Tensor<float,3> > h_s(norb);
+  Vector<double> v_d(norb);
+  Vector<TinyVector<double,3> > g_d(norb);
+  Vector<Tensor<double,3> > h_d(norb);
+  table_report rep_s, rep_qs, rep_qd;
+  for(int i=0; i<nsamples; ++i)
+  {
+    TinyVector<double,3> r(Random(),Random(),Random());
+    eval_multi_UBspline_3d_s_vgh(spline_s,r[0],r[1],r[2],v_s.data(),g_s[0].data(),h_s[0].data());
+    rep_s.add(kpts,r,v_s,g_s,h_s,norm);
+    TinyVector<float,3> r_s(r[0],r[1],r[2]);
+    einspline::evaluate_vgh(spline_q,r_s,v_s,g_s,h_s);
+    rep_qs.add(kpts,r,v_s,g_s,h_s,norm);
+    rep_qs.compare(rep_s);
+    einspline::evaluate_vgh(spline_q,r,v_d,g_d,h_d);
+    rep_qd.add(kpts,r,v_d,g_d,h_d,norm);
+    rep_qd.compare(rep_s);
+  }
+  app_log() << "#einspline_i16 accuracy grid = " << np << "^3 "
+            << (periodic? "periodic": "natural") << " orbitals = " << norb
+            << " samples = " << nsamples << endl;
+  app_log() << "#exact kinetic energy per electron = " << ekin_exact/norb << endl;
+  app_log() << "#   table        MB        rms(v)        rms(g)        rms(l)       T/N        var(T/N)"
+            << "    dT/N (vs float)          dvar(T/N)" << endl;
+  rep_s.print("float",norb,spline_s->coefs_size*sizeof(float)/1048576.0,rep_s);
+  rep_qs.print("i16/s",norb,spline_q->coefs_size*sizeof(short)/1048576.0,rep_s);
+  rep_qd.print("i16/d",norb,spline_q->coefs_size*sizeof(short)/1048576.0,rep_s);
+  OHMMS::Controller->finalize();
+  return 0;
+}
@@ -0,0 +1,94 @@
+// -*- C++ -*-
+/**@file structfact_bench.cpp
+ * @brief Benchmark StructFact: full rebuild of rhok and the particle-by-particle update
+ *
+ * The k-cutoffs are kc=lr_dim/rws for lr_dim=10,15,20,30, with rws the Wigner-Seitz radius
+ * of a cubic cell of the electron gas at rs.
+ */
+#include <Configuration.h>
+#include <Particle/ParticleSet.h>
+#include <LongRange/StructFact.h>
+#include <Utilities/RandomGenerator.h>
+#include <Utilities/OhmmsInfo.h>
+#include <Utilities/Timer.h>
+#include <Message/Communicate.h>
+#include <getopt.h>
+using namespace qmcplusplus;
+
+int main(int argc, char** argv)
+{
+  OHMMS::Controller->initialize(argc,argv);
+  Communicate* mycomm=OHMMS::Controller;
+  OhmmsInfo Welcome("structfact_bench",mycomm->rank());
+  qmcplusplus::Random.init(0,1,11);
+  typedef ParticleSet::ParticleLayout_t LatticeType;
+  typedef ParticleSet::TensorType       TensorType;
+  typedef ParticleSet::SingleParticlePos_t PosType;
+  int nel=1000;
+  double rs=1.0;
+  int niters=10;
+  int opt;
+  while((opt = getopt(argc, argv, "hn:r:i:")) != -1)
+  {
+    switch(opt)
+    {
+    case 'h':
+      printf("-n electrons -r rs -i iterations\n");
+      return 1;
+    case 'n':
+      nel=atoi(optarg);
+      break;
+    case 'r':
+      rs=atof(optarg);
+      break;
+    case 'i':
+      niters=atoi(optarg);
+      break;
+    }
+  }
+  ParticleSet elecs;
+  double alat=std::pow(4.0*M_PI*nel/3.0,1.0/3.0)*rs;
+  TensorType lat(alat,0.0,0.0,0.0,alat,0.0,0.0,0.0,alat);
+  elecs.Lattice.BoxBConds=1;
+  elecs.Lattice.set(lat);
+  elecs.getSpeciesSet().addSpecies("u");
+  elecs.getSpeciesSet().addSpecies("d");
+  vector<int> agroup(2,nel/2);
+  agroup[1]=nel-agroup[0];
+  elecs.create(agroup);
+  for(int iat=0; iat<nel; ++iat)
+    elecs.R[iat]=elecs.Lattice.toCart(PosType(Random(),Random(),Random()));
+  app_log() << "#structfact benchmark electrons = " << nel << " rs = " << rs
+            << " iterations = " << niters << endl;
+  app_log() << "#  lr_dim      kc      numk   rebuild(s)   pbyp(s)   per-move(us)" << endl;
+  const int ncut=4;
+  double lr_dim[ncut]= {10.0,15.0,20.0,30.0};
+  Timer clock;
+  for(int ic=0; ic<ncut; ++ic)
+  {
+    double kc=lr_dim[ic]/elecs.Lattice.WignerSeitzRadius;
+    StructFact sk(elecs,kc);
+    clock.restart();
+    for(int it=0; it<niters; ++it)
+      sk.UpdateAllPart();
+    double t_all=clock.elapsed()/niters;
+    clock.restart();
+    for(int it=0; it<niters; ++it)
+    {
+      for(int iat=0; iat<nel; ++iat)
+      {
+        PosType newpos=elecs.R[iat]+0.1*PosType(Random()-0.5,Random()-0.5,Random()-0.5);
+        sk.makeMove(iat,newpos);
+        if(Random()<0.5)
+          sk.acceptMove(iat);
+        else
+          sk.rejectMove(iat);
+      }
+    }
+    double t_pbyp=clock.elapsed()/niters;
+    app_log() << setw(8) << lr_dim[ic] << setw(10) << kc << setw(10) << sk.KLists.numk
+              << setw(13) << t_all << setw(11) << t_pbyp << setw(13) << t_pbyp/nel*1.e6 << endl;
+  }
+  OHMMS::Controller->finalize();
+  return 0;
+}
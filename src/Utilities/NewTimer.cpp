@@ -19,17 +19,88 @@
 #include "Utilities/NewTimer.h"
 #include "Message/Communicate.h"
 #include "Message/CommOperators.h"
+#include "OhmmsData/HDFStringAttrib.h"
 #include <map>
 #include <limits>
 #include <cstdio>
+#include <hdf5.h>
 namespace qmcplusplus
 {
 TimerManagerClass TimerManager;
 
+int NewTimer::add_node(const NewTimer* caller, int caller_node)
+{
+  int found=MAX_NODES-1;
+  #pragma omp critical (timer_node)
+  {
+    //another thread may have added it
+    int n=num_nodes;
+    for(int i=0; i<n; ++i)
+      if(nodes[i].parent == caller && nodes[i].parent_node == caller_node)
+        found=i;
+    if(found == MAX_NODES-1 && n<MAX_NODES)
+    {
+      Node& node(nodes[n]);
+      node.parent=caller;
+      node.parent_node=caller_node;
+      node.times.resize(thread_state.size());
+      for(int ip=0; ip<node.times.size(); ++ip)
+      {
+        node.times[ip].num_calls=0;
+        node.times[ip].total_time=0.0;
+        node.times[ip].child_time=0.0;
+      }
+      //publish the node before it is counted
+      #pragma omp flush
+      num_nodes=n+1;
+      found=n;
+    }
+  }
+  return found;
+}
+
+TimerManagerClass::TimerManagerClass(): block_gid(-1), block_count(0), block_active(false)
+{
+  for(int ip=0; ip<MAX_THREADS; ++ip)
+    ActiveTimers[ip].depth=0;
+}
+
 void TimerManagerClass::reset()
 {
   for (int i=0; i<TimerList.size(); i++)
     TimerList[i]->reset();
+  std::fill(BlockTimes.begin(),BlockTimes.end(),0.0);
+}
+
+void TimerManagerClass::collect(std::map<std::string,int>& pathList
+                                , std::vector<double>& timeList, std::vector<long>& callList
+                                , std::vector<double>& maxList)
+{
+  for(int i=0; i<TimerList.size(); ++i)
+  {
+    NewTimer &timer = *TimerList[i];
+    for(int n=0; n<timer.get_num_nodes(); ++n)
+    {
+      std::string p(timer.get_path(n));
+      std::map<std::string,int>::iterator it(pathList.find(p));
+      int ind;
+      if(it == pathList.end())
+      {
+        ind=pathList.size();
+        pathList[p]=ind;
+        timeList.push_back(0.0);
+        timeList.push_back(0.0);
+        callList.push_back(0);
+        maxList.push_back(0.0);
+      }
+      else
+        ind=(*it).second;
+      timeList[2*ind]+=timer.get_total(n);
+      timeList[2*ind+1]+=timer.get_exclusive(n);
+      callList[ind]+=timer.get_num_calls(n);
+      maxList[ind]=std::max(maxList[ind],timer.get_total(n));
+    }
+  }
 }
 
 void
@@ -37,11 +108,8 @@ TimerManagerClass::print(Communicate* comm)
 {
 #if !defined(DISABLE_TIMER)
   std::map<std::string,int> nameList;
-  std::vector<double> timeList;
-  std::vector<long>   callList;
-  //std::vector<int>    callers;
-  //timeList.reserve(TimerList.size());
-  //callList.reserve(TimerList.size());
+  std::vector<double> nameTime;
+  std::vector<long>   nameCall;
   for(int i=0; i<TimerList.size(); ++i)
   {
     NewTimer &timer = *TimerList[i];
@@ -50,36 +118,263 @@ TimerManagerClass::print(Communicate* comm)
     {
       int ind=nameList.size();
       nameList[timer.get_name()]=ind;
-      timeList.push_back(timer.get_total());
-      callList.push_back(timer.get_num_calls());
+      nameTime.push_back(timer.get_total());
+      nameCall.push_back(timer.get_num_calls());
     }
     else
     {
       int ind=(*it).second;
-      timeList[ind]+=timer.get_total();
-      callList[ind]+=timer.get_num_calls();
+      nameTime[ind]+=timer.get_total();
+      nameCall[ind]+=timer.get_num_calls();
     }
   }
+  //call tree: inclusive/exclusive time and the largest time of a timer object
+  std::map<std::string,int> pathList;
+  std::vector<double> pathTime, pathMax;
+  std::vector<long> pathCall;
+  collect(pathList,pathTime,pathCall,pathMax);
+  //the names and paths of the root define the layout of the reduced buffers
+  std::vector<std::string> names, paths;
+  if(comm->rank() == 0)
+  {
+    std::map<std::string,int>::iterator it(nameList.begin());
+    for(; it != nameList.end(); ++it)
+      names.push_back((*it).first);
+    for(it=pathList.begin(); it != pathList.end(); ++it)
+      paths.push_back((*it).first);
+  }
+  bcast_paths(comm,names);
+  bcast_paths(comm,paths);
+  std::vector<double> timeList(names.size(),0.0);
+  std::vector<long>   callList(names.size(),0);
+  for(int k=0; k<names.size(); ++k)
+  {
+    std::map<std::string,int>::iterator it(nameList.find(names[k]));
+    if(it == nameList.end())
+      continue;
+    timeList[k]=nameTime[(*it).second];
+    callList[k]=nameCall[(*it).second];
+  }
+  std::vector<double> treeTime(2*paths.size(),0.0), treeMax(paths.size(),0.0);
+  std::vector<long> treeCall(paths.size(),0);
+  for(int k=0; k<paths.size(); ++k)
+  {
+    std::map<std::string,int>::iterator it(pathList.find(paths[k]));
+    if(it == pathList.end())
+      continue;
+    int i=(*it).second;
+    treeTime[2*k]=pathTime[2*i];
+    treeTime[2*k+1]=pathTime[2*i+1];
+    treeCall[k]=pathCall[i];
+    treeMax[k]=pathMax[i];
+  }
   comm->allreduce(timeList);
   comm->allreduce(callList);
+  comm->allreduce(treeTime);
+  comm->allreduce(treeCall);
+  comm->allreduce(treeMax);
+  //the cost of a start/stop pair times the calls, relative to the time of the top-level timers
+  double pairCost=measure_overhead();
+  double topTime=0.0;
+  long totalCalls=0;
+  for(int i=0; i<paths.size(); ++i)
+  {
+    totalCalls += treeCall[i];
+    if(paths[i].find('/') == std::string::npos)
+      topTime += treeTime[2*i];
+  }
   if(comm->rank() == 0)
   {
     #pragma omp master
     {
-      std::map<std::string,int>::iterator it(nameList.begin()), it_end(nameList.end());
-      while(it != it_end)
+      for(int i=0; i<names.size(); ++i)
       {
-        int i=(*it).second;
         //if(callList[i]) //skip zeros
         fprintf (stderr, "%-40s  %9.4f  %13ld  %16.9f  %12.6f TIMER\n"
-        , (*it).first.c_str()
+        , names[i].c_str()
         , timeList[i], callList[i]
         , timeList[i]/(static_cast<double>(callList[i])+numeric_limits<double>::epsilon())
         , timeList[i]/static_cast<double>(omp_get_max_threads()*comm->size()));
-        ++it;
       }
+      //the paths are sorted so that the children follow their parent
+      //max/timer: the largest inclusive time of a timer under this caller, averaged over the nodes
+      fprintf (stderr, "%-40s  %9s  %9s  %13s  %12s TIMER_TREE\n"
+               , "#path", "inclusive", "exclusive", "calls", "max/timer");
+      double nnodes=static_cast<double>(comm->size());
+      for(int i=0; i<paths.size(); ++i)
+      {
+        const std::string& p(paths[i]);
+        int depth=std::count(p.begin(),p.end(),'/');
+        std::string label(2*depth,' ');
+        label.append(p.substr(p.rfind('/')+1));
+        fprintf (stderr, "%-40s  %9.4f  %9.4f  %13ld  %12.6f TIMER_TREE\n"
+                 , label.c_str(), treeTime[2*i], treeTime[2*i+1], treeCall[i]
+                 , treeMax[i]/nnodes);
+      }
+      double overhead=pairCost*static_cast<double>(totalCalls);
+      fprintf (stderr, "%-40s  %9.4f  %13ld  %16.9f  %11.4f%% TIMER_OVERHEAD\n"
+               , "#overhead", overhead, totalCalls, pairCost
+               , 100.0*overhead/(topTime+numeric_limits<double>::epsilon()));
     }
   }
 #endif
 }
+
+double TimerManagerClass::measure_overhead()
+{
+  //a probe started within a running timer would be its child
+  if(thread_stack().depth>0)
+    return 0.0;
+  const int n=100000;
+  NewTimer probe("TimerOverhead");
+  double t0=cpu_clock();
+  for(int i=0; i<n; ++i)
+  {
+    probe.start();
+    probe.stop();
+  }
+  return (cpu_clock()-t0)/static_cast<double>(n);
+}
+
+void TimerManagerClass::bcast_paths(Communicate* comm, std::vector<std::string>& paths)
+{
+  //newline-separated paths of the root
+  std::string buffer;
+  if(comm->rank() == 0)
+    for(int k=0; k<paths.size(); ++k)
+      buffer.append(paths[k]+"\n");
+  int n=buffer.size();
+  comm->bcast(n);
+  if(n == 0)
+  {
+    paths.clear();
+    return;
+  }
+  std::vector<char> chars(buffer.begin(),buffer.end());
+  chars.resize(n);
+  comm->bcast(&chars[0],n);
+  if(comm->rank() == 0)
+    return;
+  paths.clear();
+  std::string::size_type first=0;
+  for(int i=0; i<n; ++i)
+  {
+    if(chars[i] != '\n')
+      continue;
+    paths.push_back(std::string(chars.begin()+first,chars.begin()+i));
+    first=i+1;
+  }
+}
+
+void TimerManagerClass::block_increments(Communicate* comm, std::vector<double>& delta)
+{
+  std::map<std::string,int> pathList;
+  std::vector<double> timeList, maxList;
+  std::vector<long> callList;
+  collect(pathList,timeList,callList,maxList);
+  //the paths new to the root
+  std::vector<std::string> newpaths;
+  if(comm->rank() == 0)
+  {
+    std::map<std::string,int>::iterator it(pathList.begin());
+    for(; it != pathList.end(); ++it)
+      if(BlockIndex.find((*it).first) == BlockIndex.end())
+        newpaths.push_back((*it).first);
+  }
+  bcast_paths(comm,newpaths);
+  for(int k=0; k<newpaths.size(); ++k)
+  {
+    BlockIndex[newpaths[k]]=BlockPaths.size();
+    BlockPaths.push_back(newpaths[k]);
+    BlockTimes.push_back(0.0);
+    BlockTimes.push_back(0.0);
+  }
+  delta.assign(BlockTimes.size(),0.0);
+  for(int k=0; k<BlockPaths.size(); ++k)
+  {
+    std::map<std::string,int>::iterator it(pathList.find(BlockPaths[k]));
+    if(it == pathList.end())
+      continue;
+    int i=(*it).second;
+    delta[2*k]=timeList[2*i]-BlockTimes[2*k];
+    delta[2*k+1]=timeList[2*i+1]-BlockTimes[2*k+1];
+    BlockTimes[2*k]=timeList[2*i];
+    BlockTimes[2*k+1]=timeList[2*i+1];
+  }
+}
+
+void TimerManagerClass::open_block_output(long gid, Communicate* comm)
+{
+  close_block_output();
+  block_active=true;
+  block_count=0;
+  //set the reference times of the paths known at this point
+  std::vector<double> delta;
+  block_increments(comm,delta);
+  if(gid<0)
+    return;
+  block_gid = H5Gcreate(static_cast<hid_t>(gid),"timers",0);
+  //value(block, timer, {inclusive,exclusive}): the timers grow with the new paths
+  hsize_t npaths=BlockPaths.empty()? 1:BlockPaths.size();
+  hsize_t dims[3]= {0,0,2};
+  hsize_t maxdims[3]= {H5S_UNLIMITED,H5S_UNLIMITED,2};
+  hsize_t chunk[3]= {1,npaths,2};
+  hid_t p = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(p,3,chunk);
+  hid_t space = H5Screate_simple(3,dims,maxdims);
+  hid_t dset = H5Dcreate(static_cast<hid_t>(block_gid),"value",H5T_NATIVE_DOUBLE,space,p);
+  H5Dclose(dset);
+  H5Sclose(space);
+  H5Pclose(p);
+}
+
+void TimerManagerClass::write_block(Communicate* comm)
+{
+  if(!block_active)
+    return;
+  std::vector<double> delta;
+  block_increments(comm,delta);
+  if(delta.empty())
+    return;
+  comm->reduce(delta);
+  if(block_gid<0)
+    return;
+  //average over the nodes
+  double nnodes=1.0/static_cast<double>(comm->size());
+  for(int k=0; k<delta.size(); ++k)
+    delta[k]*=nnodes;
+  //the earlier blocks are zero for the paths added later
+  hsize_t dims[3]= {block_count+1,BlockPaths.size(),2};
+  hsize_t offset[3]= {block_count,0,0};
+  hsize_t count[3]= {1,BlockPaths.size(),2};
+  hid_t dset = H5Dopen(static_cast<hid_t>(block_gid),"value");
+  H5Dextend(dset,dims);
+  hid_t fspace = H5Dget_space(dset);
+  H5Sselect_hyperslab(fspace,H5S_SELECT_SET,offset,NULL,count,NULL);
+  hid_t mspace = H5Screate_simple(3,count,NULL);
+  H5Dwrite(dset,H5T_NATIVE_DOUBLE,mspace,fspace,H5P_DEFAULT,&delta[0]);
+  H5Sclose(mspace);
+  H5Sclose(fspace);
+  H5Dclose(dset);
+  block_count++;
+}
+
+void TimerManagerClass::close_block_output()
+{
+  if(block_gid>-1)
+  {
+    //names are stored as a single newline-separated string in the order of value
+    std::string names;
+    for(int k=0; k<BlockPaths.size(); ++k)
+      names.append(BlockPaths[k]+"\n");
+    HDFAttribIO<std::string> a(names);
+    a.write(static_cast<hid_t>(block_gid),"names");
+    H5Gclose(static_cast<hid_t>(block_gid));
+  }
+  block_gid=-1;
+  block_active=false;
+  BlockPaths.clear();
+  BlockIndex.clear();
+  BlockTimes.clear();
+}
 }
@@ -22,6 +22,7 @@
 #include <Utilities/Clock.h>
 #include <vector>
 #include <string>
+#include <map>
 #include <algorithm>
 
 class Communicate;
@@ -29,39 +30,143 @@ class Communicate;
 namespace qmcplusplus
 {
 
-/* Timer using omp_get_wtime  */
+/* Timer using omp_get_wtime
+ *
+ * Timers are nested per thread: a timer started while another timer is
+ * running on the same thread is attributed to it. The running timers are
+ * kept on a stack of each thread by TimerManager, so that a timer can be
+ * started by several threads. The elapsed time of a child is subtracted
+ * from the caller to get the exclusive time.
+ *
+ * A timer keeps a node, i.e. separate accumulators, for each caller node,
+ * so that a timer called from several places is reported under each of
+ * them. The callers beyond MAX_NODES share the last node.
+ *
+ * The times and the calls are accumulated per thread and summed when they
+ * are read, so that the threads do not write to the same data.
+ */
 class NewTimer
 {
+public:
+  enum {MAX_NODES=16};
+  /** times of a thread, padded to keep the threads on separate cache lines
+   */
+  struct ThreadTimes
+  {
+    double total_time;
+    ///time spent by the timers started while this timer is running
+    double child_time;
+    long num_calls;
+    char pad[64-2*sizeof(double)-sizeof(long)];
+  };
+  /** running state of a thread
+   */
+  struct ThreadState
+  {
+    double start_time;
+    ///node of the running call
+    int node;
+    char pad[64-sizeof(double)-sizeof(int)];
+  };
+  /** accumulators of the calls from a caller node
+   */
+  struct Node
+  {
+    ///caller, 0 for a top-level call
+    const NewTimer* parent;
+    ///node of the caller
+    int parent_node;
+    ///times of each thread
+    std::vector<ThreadTimes> times;
+  };
 protected:
-  double start_time;
-  double total_time;
-  long num_calls;
+  ///state of each thread, the threads beyond omp_get_max_threads() at the construction share the last
+  std::vector<ThreadState> thread_state;
+  ///number of the nodes in use
+  volatile int num_nodes;
+  Node nodes[MAX_NODES];
   std::string name;
+  /** return the node of the calls from the node of caller, add it if new
+   * @param caller running timer on this thread, 0 for a top-level call
+   */
+  int find_node(const NewTimer* caller);
+  ///add a node, serialized over the threads
+  int add_node(const NewTimer* caller, int caller_node);
+  inline int thread_index() const
+  {
+    int ip=omp_get_thread_num();
+    return (ip<thread_state.size())?ip:thread_state.size()-1;
+  }
 public:
 #if defined(DISABLE_TIMER)
   inline void start() {}
   inline void stop() {}
 #else
-  inline void start()
+  inline void start();
+  inline void stop();
+#endif
+
+  ///add the time of a child stopped on this thread
+  inline void add_child_time(double dt)
   {
-    start_time = cpu_clock();
+    int ip=thread_index();
+    nodes[thread_state[ip].node].times[ip].child_time += dt;
   }
 
-  inline void stop()
+  ///return the node of the running call on this thread
+  inline int active_node() const
   {
-    total_time += cpu_clock() - start_time;
-    num_calls++;
+    return thread_state[thread_index()].node;
   }
-#endif
 
-  inline double    get_total() const
+  inline int get_num_nodes() const
   {
-    return total_time;
+    return num_nodes;
   }
 
-  inline long  get_num_calls() const
+  ///return the inclusive time of node i
+  inline double get_total(int i) const
   {
-    return num_calls;
+    double t=0.0;
+    const std::vector<ThreadTimes>& times(nodes[i].times);
+    for(int ip=0; ip<times.size(); ++ip)
+      t += times[ip].total_time;
+    return t;
+  }
+
+  ///return the time of node i not spent in the child timers
+  inline double get_exclusive(int i) const
+  {
+    double t=0.0;
+    const std::vector<ThreadTimes>& times(nodes[i].times);
+    for(int ip=0; ip<times.size(); ++ip)
+      t += times[ip].total_time-times[ip].child_time;
+    return t;
+  }
+
+  inline long get_num_calls(int i) const
+  {
+    long n=0;
+    const std::vector<ThreadTimes>& times(nodes[i].times);
+    for(int ip=0; ip<times.size(); ++ip)
+      n += times[ip].num_calls;
+    return n;
+  }
+
+  inline double get_total() const
+  {
+    double t=0.0;
+    for(int i=0; i<num_nodes; ++i)
+      t += get_total(i);
+    return t;
+  }
+
+  inline long get_num_calls() const
+  {
+    long n=0;
+    for(int i=0; i<num_nodes; ++i)
+      n += get_num_calls(i);
+    return n;
   }
 
   inline std::string get_name() const
@@ -69,15 +174,37 @@ public:
     return name;
   }
 
+  ///return the name of node i prefixed by the names of its callers
+  inline std::string get_path(int i) const
+  {
+    const Node& n(nodes[i]);
+    return n.parent? n.parent->get_path(n.parent_node)+"/"+name: name;
+  }
+
+  ///clear the times, the nodes are kept
   inline void reset()
   {
-    num_calls = 0;
-    total_time=0.0;
+    for(int i=0; i<num_nodes; ++i)
+    {
+      std::vector<ThreadTimes>& times(nodes[i].times);
+      for(int ip=0; ip<times.size(); ++ip)
+      {
+        times[ip].num_calls=0;
+        times[ip].total_time=0.0;
+        times[ip].child_time=0.0;
+      }
+    }
   }
 
   NewTimer(const std::string& myname) :
-    total_time(0.0), num_calls(0), name(myname)
-  { }
+    thread_state(std::max(omp_get_max_threads(),1)), num_nodes(0), name(myname)
+  {
+    for(int ip=0; ip<thread_state.size(); ++ip)
+    {
+      thread_state[ip].start_time=0.0;
+      thread_state[ip].node=0;
+    }
+  }
 
   void set_name(const std::string& myname)
   {
@@ -96,9 +223,71 @@ struct TimerComparator
 
 class TimerManagerClass
 {
+public:
+  ///maximum number of threads whose timer stacks are tracked
+  enum {MAX_THREADS=512, MAX_DEPTH=32};
+
+  /** running timers of a thread, the innermost on top
+   *
+   * The timers nested deeper than MAX_DEPTH are counted but not stored.
+   * Padded to keep the stacks of the threads on separate cache lines.
+   */
+  struct TimerStack
+  {
+    NewTimer* timers[MAX_DEPTH];
+    int depth;
+    char pad[64-sizeof(int)];
+  };
+
 protected:
   std::vector<NewTimer*> TimerList;
+  ///timer stack of each thread
+  TimerStack ActiveTimers[MAX_THREADS];
+  ///hdf5 group of the per-block output, kept as long to not include hdf5.h
+  long block_gid;
+  ///number of records in the per-block output
+  unsigned long long block_count;
+  ///true between open_block_output and close_block_output
+  bool block_active;
+  ///paths of the timers in the per-block output, defined by the root
+  std::vector<std::string> BlockPaths;
+  ///path to the index in BlockPaths
+  std::map<std::string,int> BlockIndex;
+  ///accumulated inclusive and exclusive times at the last block
+  std::vector<double> BlockTimes;
+
+  /** collect the timers by path
+   * @param pathList path to index map
+   * @param timeList inclusive and exclusive time of each path
+   * @param callList number of calls of each path
+   * @param maxList maximum inclusive time of a single timer under the path
+   */
+  void collect(std::map<std::string,int>& pathList, std::vector<double>& timeList,
+               std::vector<long>& callList, std::vector<double>& maxList);
+  /** compute the timer increments since the last call
+   * @param comm communicator whose root defines the paths
+   * @param delta inclusive and exclusive increments of BlockPaths
+   *
+   * The paths found on the root are appended to BlockPaths and broadcast
+   * so that all the nodes reduce the buffers of the same layout. The paths
+   * only found on the other nodes are not recorded.
+   */
+  void block_increments(Communicate* comm, std::vector<double>& delta);
+  /** broadcast the paths of the root
+   * @param comm communicator
+   * @param paths the paths of the root on input, the same on all the nodes on output
+   */
+  static void bcast_paths(Communicate* comm, std::vector<std::string>& paths);
+  /** return the cost of a start/stop pair on this thread
+   *
+   * Returns 0 if a timer is running on this thread.
+   */
+  double measure_overhead();
+
 public:
+
+  TimerManagerClass();
+
   inline void addTimer (NewTimer* t)
   {
     #pragma omp critical
@@ -107,11 +296,102 @@ public:
     }
   }
 
+  /** return the stack of the running timers on this thread
+   *
+   * Nested parallel regions beyond MAX_THREADS share the last stack.
+   */
+  inline TimerStack& thread_stack()
+  {
+    int ip=omp_get_thread_num();
+    return ActiveTimers[(ip<MAX_THREADS)?ip:MAX_THREADS-1];
+  }
+
+  /** remove a timer from the stack of this thread
+   * @param t timer stopped on this thread
+   * @param dt elapsed time of t, added to the child time of the timer below t
+   *
+   * A timer stopped out of order is removed from the middle of the stack, the
+   * timers above it remain running and become the children of the timer below.
+   * A timer not on the stack, e.g. stopped twice, leaves the stack unchanged.
+   */
+  inline void pop(NewTimer* t, double dt)
+  {
+    TimerStack& s=thread_stack();
+    int top=std::min<int>(s.depth,MAX_DEPTH);
+    int k=top-1;
+    while(k>=0 && s.timers[k] != t)
+      --k;
+    if(k<0)
+    {
+      //the timers nested deeper than MAX_DEPTH are not stored
+      if(s.depth>MAX_DEPTH)
+        s.depth--;
+      return;
+    }
+    for(int i=k+1; i<top; ++i)
+      s.timers[i-1]=s.timers[i];
+    s.depth--;
+    if(k>0)
+      s.timers[k-1]->add_child_time(dt);
+  }
+
   void reset();
   void print (Communicate* comm);
+
+  /** create the datasets for the per-block timer output
+   * @param gid hdf5 group, e.g. the stat.h5 file; negative on the nodes which do not write
+   * @param comm communicator to sum over the nodes
+   *
+   * Must be called by all the nodes of comm.
+   */
+  void open_block_output(long gid, Communicate* comm);
+  /** record the timer increments since the last block
+   * @param comm communicator to sum over the nodes
+   */
+  void write_block(Communicate* comm);
+  ///write the paths and close the per-block timer output
+  void close_block_output();
 };
 
 extern TimerManagerClass TimerManager;
+
+#if !defined(DISABLE_TIMER)
+inline int NewTimer::find_node(const NewTimer* caller)
+{
+  int caller_node=caller? caller->active_node(): 0;
+  int n=num_nodes;
+  for(int i=0; i<n; ++i)
+    if(nodes[i].parent == caller && nodes[i].parent_node == caller_node)
+      return i;
+  return (n<MAX_NODES)? add_node(caller,caller_node): MAX_NODES-1;
+}
+
+inline void NewTimer::start()
+{
+  TimerManagerClass::TimerStack& s=TimerManager.thread_stack();
+  //the timers nested deeper than MAX_DEPTH are attributed to the deepest stored timer
+  const NewTimer* caller=0;
+  if(s.depth>0)
+    caller=s.timers[std::min<int>(s.depth,TimerManagerClass::MAX_DEPTH)-1];
+  ThreadState& t=thread_state[thread_index()];
+  t.node=find_node(caller);
+  if(s.depth<TimerManagerClass::MAX_DEPTH)
+    s.timers[s.depth]=this;
+  s.depth++;
+  t.start_time = cpu_clock();
+}
+
+inline void NewTimer::stop()
+{
+  int ip=thread_index();
+  ThreadState& t=thread_state[ip];
+  double dt=cpu_clock() - t.start_time;
+  ThreadTimes& times=nodes[t.node].times[ip];
+  times.total_time += dt;
+  times.num_calls++;
+  TimerManager.pop(this,dt);
+}
+#endif
 }
 
 #endif
@@ -0,0 +1,264 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim
+//////////////////////////////////////////////////////////////////
+// -*- C++ -*-
+/** @file PhiloxRandom.h
+ * @brief Counter-based random number generator Philox4x32-10
+ *
+ * J. K. Salmon, M. A. Moraes, R. O. Dror and D. E. Shaw, "Parallel random
+ * numbers: as easy as 1, 2, 3", SC11.
+ */
+#ifndef QMCPLUSPLUS_PHILOXRANDOM_H
+#define QMCPLUSPLUS_PHILOXRANDOM_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <iostream>
+
+/** Philox4x32-10 with the interface of BoostRandom
+ * @tparam T real type of the random numbers [0,1)
+ *
+ * A block of four 32-bit numbers is a bijection of a 128-bit counter under a
+ * 64-bit key. Without a stream, the generator of a thread is keyed by its seed
+ * and offset, and counts the blocks.
+ *
+ * setStream(step,id,n) starts the stream keyed by the run-wide StreamSeed and
+ * the stream count n of the walker, with the counter {0,step,id}. The numbers
+ * drawn for the walker id in a step are then independent of the thread and
+ * the walkers drawn before. The walker IDs must be unique and non-zero: the
+ * counters of the streams cannot coincide with those of the threads.
+ */
+template<typename T>
+class PhiloxRandom
+{
+public:
+  /// real result type
+  typedef T result_type;
+  /// unsigned integer type
+  typedef uint32_t uint_type;
+
+  std::string ClassName;
+  std::string EngineName;
+
+  ///default constructor
+  explicit PhiloxRandom(uint_type iseed=911, const std::string& aname="philox4x32")
+    : ClassName("philox"), EngineName(aname)
+    , myContext(0), nContexts(1), baseOffset(0)
+  {
+    StreamSeed=iseed;
+    Step=0;
+    seed(iseed);
+  }
+
+  /** initialize the generator
+   * @param i thread index
+   * @param nstr number of threads
+   * @param iseed_in input seed
+   * @param offset offset of the seed
+   */
+  void init(int i, int nstr, int iseed_in, uint_type offset=1)
+  {
+    uint_type baseSeed=iseed_in;
+    myContext=i;
+    nContexts=nstr;
+    if(iseed_in<=0)
+      baseSeed=make_seed(i,nstr);
+    baseOffset=offset;
+    seed(baseSeed);
+    Key[1]=offset;
+  }
+
+  ///get baseOffset
+  inline int offset() const
+  {
+    return baseOffset;
+  }
+  ///assign baseOffset
+  inline int& offset()
+  {
+    return baseOffset;
+  }
+
+  ///assign seed
+  inline void seed(uint_type aseed)
+  {
+    Key[0]=aseed;
+    Key[1]=0;
+    Counter[0]=Counter[1]=Counter[2]=Counter[3]=0;
+    Used=4;
+  }
+
+  ///set the run-wide seed of the streams, identical on all the tasks
+  inline void setStreamSeed(uint_type aseed)
+  {
+    StreamSeed=aseed;
+  }
+
+  ///advance the step of the streams
+  inline void nextStep()
+  {
+    ++Step;
+  }
+
+  ///current step of the streams
+  inline uint_type currentStep() const
+  {
+    return Step;
+  }
+
+  /** start the stream of a walker
+   * @param step step
+   * @param id walker ID
+   * @param n number of the streams started by the walker before
+   */
+  inline void setStream(uint_type step, long id, long n)
+  {
+    uint64_t uid=static_cast<uint64_t>(id);
+    Key[0]=StreamSeed;
+    Key[1]=static_cast<uint_type>(n);
+    Counter[0]=0;
+    Counter[1]=step;
+    Counter[2]=static_cast<uint_type>(uid);
+    Counter[3]=static_cast<uint_type>(uid>>32);
+    Used=4;
+  }
+
+  /** return a random number [0,1)
+   */
+  inline result_type rand()
+  {
+    return uniform();
+  }
+
+  /** return a random number [0,1)
+   */
+  inline result_type operator()()
+  {
+    return uniform();
+  }
+
+  /** return a random integer
+   */
+  inline uint_type irand()
+  {
+    if(Used==4)
+      refill();
+    return Block[Used++];
+  }
+
+  inline int state_size() const
+  {
+    return 13;
+  }
+
+  inline void read(std::istream& rin)
+  {
+    std::vector<uint_type> s(state_size());
+    for(int i=0; i<s.size(); ++i)
+      rin >> s[i];
+    load(s);
+  }
+
+  inline void write(std::ostream& rout) const
+  {
+    std::vector<uint_type> s;
+    save(s);
+    for(int i=0; i<s.size(); ++i)
+      rout << s[i] << " ";
+  }
+
+  inline void save(std::vector<uint_type>& curstate) const
+  {
+    curstate.resize(state_size());
+    uint_type* p=&curstate[0];
+    *p++=Key[0];
+    *p++=Key[1];
+    for(int i=0; i<4; ++i)
+      *p++=Counter[i];
+    for(int i=0; i<4; ++i)
+      *p++=Block[i];
+    *p++=Used;
+    *p++=StreamSeed;
+    *p++=Step;
+  }
+
+  inline void load(const std::vector<uint_type>& newstate)
+  {
+    const uint_type* p=&newstate[0];
+    Key[0]=*p++;
+    Key[1]=*p++;
+    for(int i=0; i<4; ++i)
+      Counter[i]=*p++;
+    for(int i=0; i<4; ++i)
+      Block[i]=*p++;
+    Used=*p++;
+    StreamSeed=*p++;
+    Step=*p++;
+  }
+
+private:
+  ///context number
+  int myContext;
+  ///number of contexts
+  int nContexts;
+  ///offset of the random seed
+  int baseOffset;
+  ///key
+  uint_type Key[2];
+  ///counter of the next block
+  uint_type Counter[4];
+  ///current block
+  uint_type Block[4];
+  ///numbers of the current block used
+  uint_type Used;
+  ///seed of the streams
+  uint_type StreamSeed;
+  ///step of the streams
+  uint_type Step;
+
+  /** return a number [0,1) with the precision of T
+   *
+   * The 24 high bits of a word for float, 53 bits of two words for double.
+   */
+  inline result_type uniform()
+  {
+    if(sizeof(result_type)==sizeof(float))
+      return static_cast<result_type>(irand()>>8)*static_cast<result_type>(5.9604644775390625e-08);
+    uint_type a=irand()>>5;
+    uint_type b=irand()>>6;
+    return (static_cast<result_type>(a)*67108864.0+static_cast<result_type>(b))
+           *static_cast<result_type>(1.1102230246251565404236316680908203125e-16);
+  }
+
+  ///Block = Philox4x32-10(Counter,Key) and increment Counter
+  inline void refill()
+  {
+    uint_type c[4]= {Counter[0],Counter[1],Counter[2],Counter[3]};
+    uint_type k0=Key[0], k1=Key[1];
+    for(int r=0; r<10; ++r)
+    {
+      uint64_t p0=static_cast<uint64_t>(0xD2511F53u)*c[0];
+      uint64_t p1=static_cast<uint64_t>(0xCD9E8D57u)*c[2];
+      uint_type t0=static_cast<uint_type>(p1>>32)^c[1]^k0;
+      uint_type t2=static_cast<uint_type>(p0>>32)^c[3]^k1;
+      c[0]=t0;
+      c[1]=static_cast<uint_type>(p1);
+      c[2]=t2;
+      c[3]=static_cast<uint_type>(p0);
+      k0+=0x9E3779B9u;
+      k1+=0xBB67AE85u;
+    }
+    Block[0]=c[0];
+    Block[1]=c[1];
+    Block[2]=c[2];
+    Block[3]=c[3];
+    Used=0;
+    //blocks within a stream only use Counter[0]
+    if(++Counter[0]==0)
+      if(++Counter[1]==0)
+        if(++Counter[2]==0)
+          ++Counter[3];
+  }
+};
+#endif
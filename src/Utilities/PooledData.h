@@ -234,6 +234,22 @@ struct PooledData
   {
     return &(myData[0]);
   }
+  inline const T* data() const
+  {
+    return &(myData[0]);
+  }
+
+  /** return the address of n T1 elements at the Anchor and advance the Anchor
+   *
+   * The memory is valid until the pool is resized.
+   */
+  template<class T1>
+  inline T1* lendReference(size_type n)
+  {
+    T1* ref=reinterpret_cast<T1*>(&(*Anchor));
+    Anchor += n*sizeof(T1)/sizeof(T);
+    return ref;
+  }
 
   inline void print(std::ostream& os)
   {
@@ -306,6 +322,14 @@ struct PooledData
   {
     return myData.end();
   }
+  inline typename std::vector<T>::const_iterator begin() const
+  {
+    return myData.begin();
+  }
+  inline typename std::vector<T>::const_iterator end() const
+  {
+    return myData.end();
+  }
 
   /*@{ matching functions to std::vector functions */
   ///clear the data and set Current=0
@@ -458,6 +482,22 @@ struct PooledData
   {
     return &(myData[0]);
   }
+  inline const T* data() const
+  {
+    return &(myData[0]);
+  }
+
+  /** return the address of n T1 elements at Current and advance Current
+   *
+   * The memory is valid until the pool is resized.
+   */
+  template<class T1>
+  inline T1* lendReference(size_type n)
+  {
+    T1* ref=reinterpret_cast<T1*>(&(myData[Current]));
+    Current += n*sizeof(T1)/sizeof(T);
+    return ref;
+  }
 
   inline void print(std::ostream& os)
   {
@@ -17,6 +17,7 @@
  * @brief Declare a global Random Number Generator
  *
  * Selected among
+ * - Philox4x32-10 with QMC_RNG_PHILOX, whose streams are keyed by the walkers
  * - boost::random
  * - sprng
  * - math::random
@@ -40,7 +41,15 @@ inline uint32_t make_seed(int i, int n)
   return static_cast<uint32_t>(std::time(0))%10474949+(i+1)*n+i;
 }
 
-#ifdef HAVE_LIBBOOST
+#if defined(QMC_RNG_PHILOX)
+
+#include "Utilities/PhiloxRandom.h"
+namespace qmcplusplus
+{
+typedef PhiloxRandom<OHMMS_PRECISION> RandomGenerator_t;
+extern RandomGenerator_t Random;
+}
+#elif defined(HAVE_LIBBOOST)
 
 #include "Utilities/BoostRandom.h"
 namespace qmcplusplus
@@ -18,6 +18,9 @@ QMCState::QMCState()
   save_wfs=false;
   async_swap=false;
   qmc_counter=0;
+  ci_shards=1;
+  ci_shard_rank=0;
+  ci_comm=0;
 #if defined(QMC_CUDA)
   compute_device=1;
 #else
@@ -49,15 +52,22 @@ void QMCState::initialize(int argc, char **argv)
           async_swap=(c.find("no")>=c.size());
         }
         else
-          if(c.find("help")< c.size())
+          if(c.find("ci_shards") < c.size())
           {
-            stopit=true;
+            string::size_type eq=c.find('=');
+            if(eq<c.size())
+              ci_shards=std::max(atoi(c.substr(eq+1).c_str()),1);
           }
           else
-            if(c.find("version")<c.size())
+            if(c.find("help")< c.size())
             {
               stopit=true;
             }
+            else
+              if(c.find("version")<c.size())
+              {
+                stopit=true;
+              }
     ++i;
   }
   if(stopit)
@@ -65,7 +75,7 @@ void QMCState::initialize(int argc, char **argv)
     cerr<<endl << "QMCPACK version "<< QMCPLUSPLUS_VERSION_MAJOR <<"." << QMCPLUSPLUS_VERSION_MINOR << "." << QMCPLUSPLUS_VERSION_PATCH
         //<< " subversion " << QMCPLUSPLUS_BRANCH
         << " build on " << getDateAndTime("%Y%m%d_%H%M") << endl;
-    cerr << "Usage: qmcapp input [--dryrun --save_wfs[=no] --async_swap[=no] --gpu]" << endl << endl;
+    cerr << "Usage: qmcapp input [--dryrun --save_wfs[=no] --async_swap[=no] --ci_shards=n --gpu]" << endl << endl;
     abort();
   }
 }
@@ -81,6 +91,8 @@ void QMCState::print_options(ostream& os)
     os << "  async_swap=1 : using async isend/irecv for walker swaps " << endl;
   else
     os << "  async_swap=0 : using blocking send/recv for walker swaps " << endl;
+  if(ci_shards>1)
+    os << "  ci_shards=" << ci_shards << " : the CI expansion is split over groups of " << ci_shards << " ranks" << endl;
 }
 
 QMCState qmc_common;
@@ -14,6 +14,8 @@
 
 #include <Configuration.h>
 
+class Communicate;
+
 namespace qmcplusplus
 {
 ///enumeration for main computing devices
@@ -37,6 +39,12 @@ struct QMCState
   int compute_device;
   ///init for <qmc/> section
   int qmc_counter;
+  ///number of ranks which share the CI expansion of a walker
+  int ci_shards;
+  ///index of this rank within its CI shard group
+  int ci_shard_rank;
+  ///communicator of the CI shard group, 0 if the expansion is not sharded
+  Communicate* ci_comm;
   ///store the name of the main eshd file name
   string master_eshd_name;
 
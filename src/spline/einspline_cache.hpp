@@ -0,0 +1,277 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim and Ken Esler           //
+//////////////////////////////////////////////////////////////////
+/** @file einspline_cache.hpp
+ * @brief native cache file of the einspline coefficients
+ *
+ * The file holds a header, padded to SPLINE_CACHE_ALIGN bytes, and the coefs block
+ * of a multi_UBspline_3d_* as it is laid out in memory. Every task maps the block
+ * read-only instead of reading and broadcasting the table: the pages are loaded
+ * on first use and are shared by the tasks of a node through the page cache.
+ * The header is validated against the spline to be filled and the source h5 file,
+ * and the file size against the coefs block. The first task of the communicator
+ * also checks the hash of the coefs block, so a truncated or stale block is
+ * rejected; the other tasks do not touch the coefficients.
+ *
+ * The mapped coefs are not allocated by malloc and must never be freed:
+ * unmap_spline_cache unmaps them and sets coefs to 0 before destroy_Bspline.
+ */
+#ifndef QMCPLUSPLUS_EINSPLINE_CACHE_H
+#define QMCPLUSPLUS_EINSPLINE_CACHE_H
+
+#include <Message/Communicate.h>
+#include <Message/CommOperators.h>
+#include <OhmmsData/FileUtility.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <utility>
+
+///offset of the coefficients in a cache file, a multiple of the page sizes in use
+#define SPLINE_CACHE_ALIGN 65536
+
+namespace qmcplusplus
+{
+/** header of a spline cache file
+ *
+ * Constructed from a spline, the header is compared byte-by-byte with the one in the file.
+ */
+struct spline_cache_header
+{
+  char magic[8];
+  int version;
+  int sizeof_value;
+  int num_splines;
+  int num_grid[3];
+  double grid_start[3];
+  double grid_end[3];
+  long strides[3];
+  unsigned long long coefs_size;
+  char adoptor[64];
+  ///hash of the path, size and modification time of the source h5 file
+  unsigned long long source[3];
+  ///hash of the coefs block, see payload_hash
+  unsigned long long payload;
+  ///FNV-1a hash of the header with checksum=0
+  unsigned long long checksum;
+
+  spline_cache_header()
+  {
+    memset(this,0,sizeof(spline_cache_header));
+  }
+
+  template<typename ENGT>
+  spline_cache_header(ENGT* spline, const string& aname, const string& srcname)
+  {
+    memset(this,0,sizeof(spline_cache_header));
+    strncpy(magic,"QMCBSPL",8);
+    version=3;
+    sizeof_value=sizeof(*(spline->coefs));
+    num_splines=spline->num_splines;
+    num_grid[0]=spline->x_grid.num;
+    num_grid[1]=spline->y_grid.num;
+    num_grid[2]=spline->z_grid.num;
+    grid_start[0]=spline->x_grid.start;
+    grid_start[1]=spline->y_grid.start;
+    grid_start[2]=spline->z_grid.start;
+    grid_end[0]=spline->x_grid.end;
+    grid_end[1]=spline->y_grid.end;
+    grid_end[2]=spline->z_grid.end;
+    strides[0]=spline->x_stride;
+    strides[1]=spline->y_stride;
+    strides[2]=spline->z_stride;
+    coefs_size=spline->coefs_size;
+    strncpy(adoptor,aname.c_str(),63);
+    //a rewritten or replaced h5 file invalidates the cache
+    source[0]=fnv1a(srcname.c_str(),srcname.size());
+    struct stat st;
+    if(stat(srcname.c_str(),&st) == 0)
+    {
+      source[1]=static_cast<unsigned long long>(st.st_size);
+      source[2]=static_cast<unsigned long long>(st.st_mtime);
+    }
+    checksum=hash();
+  }
+
+  ///FNV-1a hash of n bytes
+  static inline unsigned long long fnv1a(const void* data, size_t n)
+  {
+    const unsigned char* p=static_cast<const unsigned char*>(data);
+    unsigned long long r=14695981039346656037ULL;
+    for(size_t i=0; i<n; ++i)
+      r=(r^p[i])*1099511628211ULL;
+    return r;
+  }
+
+  /** FNV-1a hash of n bytes taken as 64-bit words
+   *
+   * The coefs blocks are multiples of 8 bytes; a trailing partial word is
+   * hashed byte by byte.
+   */
+  static inline unsigned long long payload_hash(const void* data, size_t n)
+  {
+    const unsigned long long* w=static_cast<const unsigned long long*>(data);
+    size_t nw=n/sizeof(unsigned long long);
+    unsigned long long r=14695981039346656037ULL;
+    for(size_t i=0; i<nw; ++i)
+      r=(r^w[i])*1099511628211ULL;
+    const unsigned char* p=reinterpret_cast<const unsigned char*>(w+nw);
+    for(size_t i=nw*sizeof(unsigned long long); i<n; ++i)
+      r=(r^(*p++))*1099511628211ULL;
+    return r;
+  }
+
+  inline unsigned long long hash() const
+  {
+    spline_cache_header h(*this);
+    h.checksum=0;
+    return fnv1a(&h,sizeof(spline_cache_header));
+  }
+
+  ///size of the coefficient block in bytes
+  inline size_t bytes() const
+  {
+    return static_cast<size_t>(coefs_size)*static_cast<size_t>(sizeof_value);
+  }
+};
+
+///return the name of the cache file for a spline file
+inline string make_spline_cachename(const string& splinefile)
+{
+  string aname(splinefile);
+  if(getExtension(aname) == "h5")
+    aname.erase(aname.end()-3,aname.end());
+  return aname+".bspl";
+}
+
+/** write the coefficients of spline to a cache file
+ * @param fname cache file name
+ * @param spline einspline object
+ * @param aname name of the adoptor which owns spline
+ * @param srcname h5 file from which spline is computed
+ * @return true, if the file is complete
+ *
+ * Called by a single task. The file is renamed to fname when it is complete.
+ */
+template<typename ENGT>
+inline bool write_spline_cache(const string& fname, ENGT* spline, const string& aname, const string& srcname)
+{
+  spline_cache_header h(spline,aname,srcname);
+  h.payload=spline_cache_header::payload_hash(spline->coefs,h.bytes());
+  h.checksum=h.hash();
+  string tmpname=fname+".tmp";
+  FILE* fout=fopen(tmpname.c_str(),"wb");
+  if(fout==0)
+    return false;
+  std::vector<char> pad(SPLINE_CACHE_ALIGN,'\0');
+  memcpy(&pad[0],&h,sizeof(spline_cache_header));
+  bool success=(fwrite(&pad[0],1,SPLINE_CACHE_ALIGN,fout) == SPLINE_CACHE_ALIGN);
+  const char* p=reinterpret_cast<const char*>(spline->coefs);
+  size_t chunk_size=1<<30;
+  for(size_t offset=0; success && offset<h.bytes(); offset+=chunk_size)
+  {
+    size_t n=std::min(chunk_size,h.bytes()-offset);
+    success=(fwrite(p+offset,1,n,fout) == n);
+  }
+  success &= (fclose(fout) == 0);
+  if(success)
+    success=(rename(tmpname.c_str(),fname.c_str()) == 0);
+  else
+    remove(tmpname.c_str());
+  return success;
+}
+
+///mapped coefs blocks and their sizes in bytes
+inline std::vector<std::pair<void*,size_t> >& spline_cache_maps()
+{
+  static std::vector<std::pair<void*,size_t> > maps;
+  return maps;
+}
+
+///replace the malloc'd coefs by a mapped block of n bytes
+template<typename T>
+inline void replace_coefs(T* restrict& coefs, void* p, size_t n)
+{
+  free(coefs);
+  coefs=static_cast<T*>(p);
+  spline_cache_maps().push_back(std::make_pair(p,n));
+}
+
+/** unmap the coefs of spline mapped by map_spline_cache and set them to 0
+ *
+ * Does nothing if the coefs are not mapped from a cache file.
+ */
+template<typename ENGT>
+inline void unmap_spline_cache(ENGT* spline)
+{
+  std::vector<std::pair<void*,size_t> >& maps=spline_cache_maps();
+  for(int i=0; i<maps.size(); ++i)
+    if(maps[i].first == static_cast<void*>(spline->coefs))
+    {
+      munmap(maps[i].first,maps[i].second);
+      maps.erase(maps.begin()+i);
+      spline->coefs=0;
+      return;
+    }
+}
+
+/** map the coefficients of spline from a cache file
+ * @param comm tasks which map the file
+ * @param fname cache file name
+ * @param spline einspline object created with the grid and the number of splines
+ * @param aname name of the adoptor which owns spline
+ * @param srcname h5 file from which spline is computed
+ * @return true, if every task has mapped the cache
+ *
+ * Collective over comm. The header and the file size are checked by every task,
+ * the hash of the coefs block by the first task. The coefs are replaced by a
+ * read-only mapping only when the file matches spline on all the tasks.
+ */
+template<typename ENGT>
+inline bool map_spline_cache(Communicate* comm, const string& fname, ENGT* spline, const string& aname
+                             , const string& srcname)
+{
+  spline_cache_header h(spline,aname,srcname), hfile;
+  int fd=open(fname.c_str(),O_RDONLY);
+  int nfailed=(fd<0);
+  if(!nfailed)
+  {
+    struct stat st;
+    nfailed = (pread(fd,&hfile,sizeof(spline_cache_header),0) != sizeof(spline_cache_header))
+              || (hfile.checksum != hfile.hash());
+    //the hash of the coefs is only known from the file
+    h.payload=hfile.payload;
+    h.checksum=h.hash();
+    nfailed = nfailed
+              || memcmp(&h,&hfile,sizeof(spline_cache_header))
+              || fstat(fd,&st)
+              || (static_cast<size_t>(st.st_size) != SPLINE_CACHE_ALIGN+h.bytes());
+  }
+  comm->allreduce(nfailed);
+  void* p=MAP_FAILED;
+  if(!nfailed)
+  {
+    p=mmap(0,h.bytes(),PROT_READ,MAP_SHARED,fd,SPLINE_CACHE_ALIGN);
+    nfailed=(p==MAP_FAILED);
+    if(!nfailed && comm->rank() == 0)
+      nfailed=(spline_cache_header::payload_hash(p,h.bytes()) != h.payload);
+    comm->allreduce(nfailed);
+  }
+  if(fd>=0)
+    close(fd);
+  if(nfailed)
+  {
+    if(p!=MAP_FAILED)
+      munmap(p,h.bytes());
+    return false;
+  }
+  replace_coefs(spline->coefs,p,h.bytes());
+  return true;
+}
+}
+#endif
@@ -0,0 +1,168 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim and Ken Esler           //
+//////////////////////////////////////////////////////////////////
+/** @file einspline_crowd.hpp
+ * @brief evaluate a real multi_UBspline_3d at the positions of a crowd of walkers
+ *
+ * The kernel takes the positions of all the walkers of a crowd in one call.
+ * The results are stored by component (value, gradient and the upper triangle
+ * of the hessian) in rows over the splines, so that every loop over the splines
+ * is a contiguous SIMD loop.
+ */
+#ifndef QMCPLUSPLUS_EINSPLINE_CROWD_H
+#define QMCPLUSPLUS_EINSPLINE_CROWD_H
+
+#include <spline/einspline_i16.hpp>
+
+namespace qmcplusplus
+{
+///rows of the results of a position in eval_multi_UBspline_3d_vgh_crowd
+enum {CROWD_V=0, CROWD_GX, CROWD_GY, CROWD_GZ,
+      CROWD_HXX, CROWD_HXY, CROWD_HXZ, CROWD_HYY, CROWD_HYZ, CROWD_HZZ, CROWD_ROWS
+     };
+
+///number of the weights of a position: value, first and second derivatives in x, y and z
+enum {CROWD_WEIGHTS=36};
+
+///scale of the coefficients of a table of float or double
+struct crowd_unit_scale
+{
+  inline crowd_unit_scale(const float* scale, intptr_t plane) {}
+  inline float operator[](int n) const
+  {
+    return 1.0f;
+  }
+};
+
+///scale of the coefficients of an x-plane of a block-scaled table, see multi_UBspline_3d_i16
+struct crowd_block_scale
+{
+  const float* s;
+  inline crowd_block_scale(const float* scale, intptr_t plane): s(scale+plane) {}
+  inline float operator[](int n) const
+  {
+    return s[n];
+  }
+};
+
+/** accumulate the (x,y) columns of the stencils of nw positions
+ * @tparam SCT crowd_unit_scale or crowd_block_scale
+ *
+ * See eval_multi_UBspline_3d_vgh_crowd for the arguments.
+ */
+template<typename SCT, typename SplineT, typename T>
+inline void accumulate_crowd_columns(const SplineT* restrict spline, const float* restrict scale,
+                                     int nw, T* restrict out, int ldv,
+                                     const T* restrict w, const intptr_t* restrict offset)
+{
+  typedef typename bspline_engine_traits<SplineT>::value_type coef_type;
+  const int num_splines=spline->num_splines;
+  const intptr_t xs=spline->x_stride, ys=spline->y_stride, zs=spline->z_stride;
+  for(int i=0; i<4; ++i)
+    for(int j=0; j<4; ++j)
+      for(int iw=0; iw<nw; ++iw)
+      {
+        const T* restrict wi=w+CROWD_WEIGHTS*iw;
+        const T a=wi[i], da=wi[4+i], d2a=wi[8+i];
+        const T b=wi[12+j], db=wi[16+j], d2b=wi[20+j];
+        const T c0=wi[24], c1=wi[25], c2=wi[26], c3=wi[27];
+        const T dc0=wi[28], dc1=wi[29], dc2=wi[30], dc3=wi[31];
+        const T d2c0=wi[32], d2c1=wi[33], d2c2=wi[34], d2c3=wi[35];
+        const T ab=a*b, dab=da*b, adb=a*db, d2ab=d2a*b, dadb=da*db, ad2b=a*d2b;
+        //the offset of the x-plane ix+i, iy*ys+iz*zs is less than xs
+        const SCT sc(scale,(offset[iw]/xs+i)*zs);
+        const coef_type* restrict q0=spline->coefs+(offset[iw]+i*xs+j*ys);
+        const coef_type* restrict q1=q0+zs;
+        const coef_type* restrict q2=q1+zs;
+        const coef_type* restrict q3=q2+zs;
+        T* restrict o=out+static_cast<size_t>(iw)*CROWD_ROWS*ldv;
+        T* restrict v=o+CROWD_V*ldv;
+        T* restrict gx=o+CROWD_GX*ldv;
+        T* restrict gy=o+CROWD_GY*ldv;
+        T* restrict gz=o+CROWD_GZ*ldv;
+        T* restrict hxx=o+CROWD_HXX*ldv;
+        T* restrict hxy=o+CROWD_HXY*ldv;
+        T* restrict hxz=o+CROWD_HXZ*ldv;
+        T* restrict hyy=o+CROWD_HYY*ldv;
+        T* restrict hyz=o+CROWD_HYZ*ldv;
+        T* restrict hzz=o+CROWD_HZZ*ldv;
+        for(int n=0; n<num_splines; ++n)
+        {
+          const T f=sc[n];
+          const T p0=f*static_cast<T>(q0[n]);
+          const T p1=f*static_cast<T>(q1[n]);
+          const T p2=f*static_cast<T>(q2[n]);
+          const T p3=f*static_cast<T>(q3[n]);
+          const T s0=c0*p0+c1*p1+c2*p2+c3*p3;
+          const T s1=dc0*p0+dc1*p1+dc2*p2+dc3*p3;
+          const T s2=d2c0*p0+d2c1*p1+d2c2*p2+d2c3*p3;
+          v[n]+=ab*s0;
+          gx[n]+=dab*s0;
+          gy[n]+=adb*s0;
+          gz[n]+=ab*s1;
+          hxx[n]+=d2ab*s0;
+          hxy[n]+=dadb*s0;
+          hxz[n]+=dab*s1;
+          hyy[n]+=ad2b*s0;
+          hyz[n]+=adb*s1;
+          hzz[n]+=ab*s2;
+        }
+      }
+}
+
+/** evaluate the values, gradients and hessians of a real multi-spline at nw positions
+ * @param spline multi_UBspline_3d_d, multi_UBspline_3d_s or multi_UBspline_3d_i16
+ * @param scale block scale factors, see multi_UBspline_3d_i16, 0 if the coefficients are not scaled
+ * @param nw number of positions
+ * @param r positions in the units of the grids
+ * @param out results, out[(iw*CROWD_ROWS+c)*ldv+n] is the component c of the spline n at r[iw]
+ * @param ldv leading dimension of a row, at least num_splines
+ * @param w workspace for CROWD_WEIGHTS*nw weights
+ * @param offset workspace for nw offsets of the coefficients
+ *
+ * The stencil weights of all the positions are computed first and scaled by
+ * the inverse grid spacings. The 16 (x,y) columns of the stencils are then
+ * accumulated column by column, and each column for all the positions in turn.
+ * A column contracts its four z rows of coefficients and updates the ten rows
+ * of the results in one pass over the splines. The coefficient streams of
+ * different walkers are independent, so their loads overlap.
+ */
+template<typename SplineT, typename PT, typename T>
+inline void eval_multi_UBspline_3d_vgh_crowd(const SplineT* restrict spline, const float* restrict scale,
+    int nw, const PT* restrict r, T* restrict out, int ldv,
+    T* restrict w, intptr_t* restrict offset)
+{
+  const intptr_t xs=spline->x_stride, ys=spline->y_stride, zs=spline->z_stride;
+  const T dxInv=spline->x_grid.delta_inv;
+  const T dyInv=spline->y_grid.delta_inv;
+  const T dzInv=spline->z_grid.delta_inv;
+  for(int iw=0; iw<nw; ++iw)
+  {
+    T tx, ty, tz;
+    T* restrict wi=w+CROWD_WEIGHTS*iw;
+    int ix=bspline_locate(spline->x_grid,spline->xBC,static_cast<T>(r[iw][0]),tx);
+    int iy=bspline_locate(spline->y_grid,spline->yBC,static_cast<T>(r[iw][1]),ty);
+    int iz=bspline_locate(spline->z_grid,spline->zBC,static_cast<T>(r[iw][2]),tz);
+    bspline_weights(tx,wi,wi+4,wi+8);
+    bspline_weights(ty,wi+12,wi+16,wi+20);
+    bspline_weights(tz,wi+24,wi+28,wi+32);
+    for(int k=0; k<4; ++k)
+    {
+      wi[4+k]*=dxInv;
+      wi[8+k]*=dxInv*dxInv;
+      wi[16+k]*=dyInv;
+      wi[20+k]*=dyInv*dyInv;
+      wi[28+k]*=dzInv;
+      wi[32+k]*=dzInv*dzInv;
+    }
+    offset[iw]=ix*xs+iy*ys+iz*zs;
+  }
+  std::fill(out,out+static_cast<size_t>(nw)*CROWD_ROWS*ldv,T());
+  if(scale)
+    accumulate_crowd_columns<crowd_block_scale>(spline,scale,nw,out,ldv,w,offset);
+  else
+    accumulate_crowd_columns<crowd_unit_scale>(spline,scale,nw,out,ldv,w,offset);
+}
+
+}
+#endif
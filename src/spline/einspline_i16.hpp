@@ -0,0 +1,357 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim and Ken Esler           //
+//////////////////////////////////////////////////////////////////
+/** @file einspline_i16.hpp
+ * @brief multi_UBspline_3d with 16-bit integer coefficients
+ *
+ * The coefficients are stored as short integers, which takes half the memory
+ * of float. They are scaled by blocks: a block is an x-plane of a spline and its
+ * scale is the largest coefficient of the plane, so that a spline whose amplitude
+ * varies over the cell keeps its resolution where it is small. The coefficients
+ * are widened to the evaluation type (float or double) and multiplied by the
+ * scale of their plane in the kernels.
+ *
+ * The scale factors are stored in the same block after the coefficients so that
+ * coefs/coefs_size describe the complete table for chunked_bcast,
+ * SharedSplineTable and the spline cache.
+ */
+#ifndef QMCPLUSPLUS_EINSPLINE_I16_H
+#define QMCPLUSPLUS_EINSPLINE_I16_H
+
+#include <spline/einspline_engine.hpp>
+#include <spline/einspline_util.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace qmcplusplus
+{
+/** multi_UBspline_3d with short coefficients, laid out as multi_UBspline_3d_s
+ */
+struct multi_UBspline_3d_i16
+{
+  short* restrict coefs;
+  intptr_t x_stride, y_stride, z_stride;
+  Ugrid x_grid, y_grid, z_grid;
+  BCtype_s xBC, yBC, zBC;
+  int num_splines;
+  ///size of the block in short including the scale factors
+  size_t coefs_size;
+  ///offset of the float scale factors in coefs
+  size_t scale_offset;
+
+  ///number of the scale factors, a row of z_stride for each x-plane
+  inline size_t scale_size() const
+  {
+    return (scale_offset/x_stride)*z_stride;
+  }
+
+  ///scale factors, scales()[ix*z_stride+n] of the x-plane ix of the spline n
+  inline const float* scales() const
+  {
+    return reinterpret_cast<const float*>(coefs+scale_offset);
+  }
+
+  inline float* scales()
+  {
+    return reinterpret_cast<float*>(coefs+scale_offset);
+  }
+};
+
+template<>
+struct bspline_engine_traits<multi_UBspline_3d_i16>
+{
+  enum {DIM=3};
+  typedef multi_UBspline_3d_i16 SplineType;
+  typedef UBspline_3d_s         SingleSplineType;
+  typedef BCtype_s              BCType;
+  typedef float real_type;
+  typedef short value_type;
+};
+
+/** create multi_UBspline_3d_i16 with the grids of multi_UBspline_3d_s */
+inline multi_UBspline_3d_i16*
+create_multi_UBspline_3d_i16(Ugrid x_grid, Ugrid y_grid, Ugrid z_grid,
+                             BCtype_s xBC, BCtype_s yBC, BCtype_s zBC, int num_splines)
+{
+  multi_UBspline_3d_i16* spline=new multi_UBspline_3d_i16;
+  spline->xBC=xBC;
+  spline->yBC=yBC;
+  spline->zBC=zBC;
+  spline->num_splines=num_splines;
+  Ugrid* grids[3]= {&x_grid,&y_grid,&z_grid};
+  BCtype_s* bcs[3]= {&xBC,&yBC,&zBC};
+  int N[3];
+  for(int i=0; i<3; ++i)
+  {
+    N[i]=(bcs[i]->lCode == PERIODIC || bcs[i]->lCode == ANTIPERIODIC)? grids[i]->num+3:grids[i]->num+2;
+    grids[i]->delta=(grids[i]->end-grids[i]->start)/static_cast<double>(N[i]-3);
+    grids[i]->delta_inv=1.0/grids[i]->delta;
+  }
+  spline->x_grid=x_grid;
+  spline->y_grid=y_grid;
+  spline->z_grid=z_grid;
+  //pad to 32 bytes
+  int ns=((num_splines+15)/16)*16;
+  spline->z_stride=ns;
+  spline->y_stride=N[2]*ns;
+  spline->x_stride=static_cast<intptr_t>(N[1])*N[2]*ns;
+  spline->scale_offset=static_cast<size_t>(N[0])*spline->x_stride;
+  //a float scale factor takes two shorts
+  spline->coefs_size=spline->scale_offset+2*static_cast<size_t>(N[0])*ns;
+  posix_memalign((void**)&spline->coefs,64,sizeof(short)*spline->coefs_size);
+  std::fill(spline->coefs,spline->coefs+spline->coefs_size,short(0));
+  return spline;
+}
+
+/** quantize the coefficients of a single spline to the i-th spline
+ * @param spline multi_UBspline_3d_i16
+ * @param i the spline index
+ * @param in single spline with the same grid
+ */
+template<typename SST>
+inline void set_multi_UBspline_3d_i16(multi_UBspline_3d_i16* spline, int i, const SST* in)
+{
+  const int nx=(spline->scale_offset)/spline->x_stride;
+  const int ny=spline->x_stride/spline->y_stride;
+  const int nz=spline->y_stride/spline->z_stride;
+  for(int ix=0; ix<nx; ++ix)
+  {
+    double cmax=0.0;
+    for(int iy=0; iy<ny; ++iy)
+      for(int iz=0; iz<nz; ++iz)
+        cmax=std::max(cmax,std::abs(static_cast<double>(in->coefs[ix*in->x_stride+iy*in->y_stride+iz])));
+    //quantized with the float scale used by the kernels
+    float scale=static_cast<float>(cmax/32767.0);
+    double scale_inv=(scale>0.0f)?1.0/scale:0.0;
+    for(int iy=0; iy<ny; ++iy)
+    {
+      short* restrict q=spline->coefs+ix*spline->x_stride+iy*spline->y_stride+i;
+      for(int iz=0; iz<nz; ++iz)
+      {
+        double c=std::floor(in->coefs[ix*in->x_stride+iy*in->y_stride+iz]*scale_inv+0.5);
+        q[iz*spline->z_stride]=static_cast<short>(std::min(32767.0,std::max(-32767.0,c)));
+      }
+    }
+    spline->scales()[ix*spline->z_stride+i]=scale;
+  }
+}
+
+/** gather the splines and their scale factors over comm
+ *
+ * The scale factors follow the coefficients as a row of floats for each x-plane.
+ */
+inline void gather_splines(Communicate* comm, multi_UBspline_3d_i16* buffer, const std::vector<int>& offsets)
+{
+  gather_columns(comm,buffer->coefs,buffer->scale_offset/buffer->z_stride,buffer->z_stride,offsets);
+  gather_columns(comm,buffer->scales(),buffer->scale_size()/buffer->z_stride,buffer->z_stride,offsets);
+}
+
+/** compute the index and the fractional position on a uniform grid
+ * @param g grid
+ * @param bc boundary condition of the grid
+ * @param x position
+ * @param t fractional position in the interval, outside [0,1) if x is off the grid
+ * @return the index of the interval
+ *
+ * A periodic grid has g.num intervals and the others g.num-1, see create_multi_UBspline_3d_i16.
+ */
+template<typename BCT, typename T>
+inline int bspline_locate(const Ugrid& g, const BCT& bc, T x, T& t)
+{
+  const int last=(bc.lCode == PERIODIC || bc.lCode == ANTIPERIODIC)? g.num-1: g.num-2;
+  T u=(x-g.start)*g.delta_inv;
+  int i=std::min(std::max(0,static_cast<int>(std::floor(u))),last);
+  t=u-static_cast<T>(i);
+  return i;
+}
+
+/** cubic B-spline weights, the first and second derivatives at t */
+template<typename T>
+inline void bspline_weights(T t, T* restrict a, T* restrict da, T* restrict d2a)
+{
+  const T c6=1.0/6.0;
+  T t2=t*t;
+  T t3=t2*t;
+  a[0]=c6*(-t3+3*t2-3*t+1);
+  a[1]=c6*(3*t3-6*t2+4);
+  a[2]=c6*(-3*t3+3*t2+3*t+1);
+  a[3]=c6*t3;
+  if(da)
+  {
+    da[0]=-0.5*t2+t-0.5;
+    da[1]=1.5*t2-2*t;
+    da[2]=-1.5*t2+t+0.5;
+    da[3]=0.5*t2;
+    d2a[0]=1-t;
+    d2a[1]=3*t-2;
+    d2a[2]=1-3*t;
+    d2a[3]=t;
+  }
+}
+
+/** evaluate the values */
+template<typename T>
+inline void eval_multi_UBspline_3d_i16(const multi_UBspline_3d_i16* restrict spline,
+                                       T x, T y, T z, T* restrict vals)
+{
+  T tx, ty, tz, a[4], b[4], c[4];
+  int ix=bspline_locate(spline->x_grid,spline->xBC,x,tx);
+  int iy=bspline_locate(spline->y_grid,spline->yBC,y,ty);
+  int iz=bspline_locate(spline->z_grid,spline->zBC,z,tz);
+  bspline_weights(tx,a,(T*)0,(T*)0);
+  bspline_weights(ty,b,(T*)0,(T*)0);
+  bspline_weights(tz,c,(T*)0,(T*)0);
+  const int num_splines=spline->num_splines;
+  const intptr_t xs=spline->x_stride, ys=spline->y_stride, zs=spline->z_stride;
+  std::fill(vals,vals+num_splines,T());
+  for(int i=0; i<4; i++)
+  {
+    const float* restrict scale=spline->scales()+(ix+i)*zs;
+    for(int j=0; j<4; j++)
+      for(int k=0; k<4; k++)
+      {
+        const T abc=a[i]*b[j]*c[k];
+        const short* restrict q=spline->coefs+((ix+i)*xs+(iy+j)*ys+(iz+k)*zs);
+        for(int n=0; n<num_splines; n++)
+          vals[n]+=abc*scale[n]*static_cast<T>(q[n]);
+      }
+  }
+}
+
+/** evaluate the values, gradients and hessians */
+template<typename T>
+inline void eval_multi_UBspline_3d_i16_vgh(const multi_UBspline_3d_i16* restrict spline,
+    T x, T y, T z, T* restrict vals, T* restrict grads, T* restrict hess)
+{
+  T tx, ty, tz, a[4], b[4], c[4], da[4], db[4], dc[4], d2a[4], d2b[4], d2c[4];
+  int ix=bspline_locate(spline->x_grid,spline->xBC,x,tx);
+  int iy=bspline_locate(spline->y_grid,spline->yBC,y,ty);
+  int iz=bspline_locate(spline->z_grid,spline->zBC,z,tz);
+  bspline_weights(tx,a,da,d2a);
+  bspline_weights(ty,b,db,d2b);
+  bspline_weights(tz,c,dc,d2c);
+  const int num_splines=spline->num_splines;
+  const intptr_t xs=spline->x_stride, ys=spline->y_stride, zs=spline->z_stride;
+  std::fill(vals,vals+num_splines,T());
+  std::fill(grads,grads+3*num_splines,T());
+  std::fill(hess,hess+9*num_splines,T());
+  for(int i=0; i<4; i++)
+  {
+    const float* restrict scale=spline->scales()+(ix+i)*zs;
+    for(int j=0; j<4; j++)
+      for(int k=0; k<4; k++)
+      {
+        const T abc=a[i]*b[j]*c[k];
+        const T dabc[3]= {da[i]*b[j]*c[k], a[i]*db[j]*c[k], a[i]*b[j]*dc[k]};
+        const T d2abc[6]= {d2a[i]*b[j]*c[k], da[i]*db[j]*c[k], da[i]*b[j]*dc[k],
+                           a[i]*d2b[j]*c[k], a[i]*db[j]*dc[k], a[i]*b[j]*d2c[k]
+                          };
+        const short* restrict q=spline->coefs+((ix+i)*xs+(iy+j)*ys+(iz+k)*zs);
+        for(int n=0; n<num_splines; n++)
+        {
+          const T coef=scale[n]*static_cast<T>(q[n]);
+          vals[n]      +=abc*coef;
+          grads[3*n+0] +=dabc[0]*coef;
+          grads[3*n+1] +=dabc[1]*coef;
+          grads[3*n+2] +=dabc[2]*coef;
+          hess [9*n+0] +=d2abc[0]*coef;
+          hess [9*n+1] +=d2abc[1]*coef;
+          hess [9*n+2] +=d2abc[2]*coef;
+          hess [9*n+4] +=d2abc[3]*coef;
+          hess [9*n+5] +=d2abc[4]*coef;
+          hess [9*n+8] +=d2abc[5]*coef;
+        }
+      }
+  }
+  const T dxInv=spline->x_grid.delta_inv;
+  const T dyInv=spline->y_grid.delta_inv;
+  const T dzInv=spline->z_grid.delta_inv;
+  for(int n=0; n<num_splines; n++)
+  {
+    grads[3*n+0]*=dxInv;
+    grads[3*n+1]*=dyInv;
+    grads[3*n+2]*=dzInv;
+    hess[9*n+0]*=dxInv*dxInv;
+    hess[9*n+4]*=dyInv*dyInv;
+    hess[9*n+8]*=dzInv*dzInv;
+    hess[9*n+1]*=dxInv*dyInv;
+    hess[9*n+2]*=dxInv*dzInv;
+    hess[9*n+5]*=dyInv*dzInv;
+    hess[9*n+3]=hess[9*n+1];
+    hess[9*n+6]=hess[9*n+2];
+    hess[9*n+7]=hess[9*n+5];
+  }
+}
+
+/** return the block scale factors of a table, 0 for the tables of float or double */
+template<typename SPT>
+inline const float* spline_scales(const SPT* spline)
+{
+  return 0;
+}
+
+inline const float* spline_scales(const multi_UBspline_3d_i16* spline)
+{
+  return spline->scales();
+}
+
+namespace einspline
+{
+/** create spline for short */
+template<typename GT, typename BCT>
+multi_UBspline_3d_i16* create(multi_UBspline_3d_i16* s, GT& grid , BCT& bc, int num_splines)
+{
+  BCtype_s xyz_bc[3];
+  for(int i=0; i<3; ++i)
+  {
+    xyz_bc[i].lCode=bc[i].lCode;
+    xyz_bc[i].rCode=bc[i].rCode;
+    xyz_bc[i].lVal=xyz_bc[i].rVal=0.0;
+  }
+  return create_multi_UBspline_3d_i16(grid[0],grid[1],grid[2],xyz_bc[0],xyz_bc[1],xyz_bc[2],num_splines);
+}
+
+/** set the i-th spline from float data: solved in float and quantized */
+inline void set(multi_UBspline_3d_i16* spline, int i, float* restrict indata)
+{
+  UBspline_3d_s* single=create_UBspline_3d_s(spline->x_grid,spline->y_grid,spline->z_grid,
+                        spline->xBC,spline->yBC,spline->zBC,indata);
+  set_multi_UBspline_3d_i16(spline,i,single);
+  destroy_Bspline(single);
+}
+
+/** set the i-th spline from double data: solved in double and quantized */
+inline void set(multi_UBspline_3d_i16* spline, int i, double* restrict indata)
+{
+  BCtype_d xyz_bc[3];
+  BCtype_s* bcs[3]= {&spline->xBC,&spline->yBC,&spline->zBC};
+  for(int j=0; j<3; ++j)
+  {
+    xyz_bc[j].lCode=bcs[j]->lCode;
+    xyz_bc[j].rCode=bcs[j]->rCode;
+    xyz_bc[j].lVal=xyz_bc[j].rVal=0.0;
+  }
+  UBspline_3d_d* single=create_UBspline_3d_d(spline->x_grid,spline->y_grid,spline->z_grid,
+                        xyz_bc[0],xyz_bc[1],xyz_bc[2],indata);
+  set_multi_UBspline_3d_i16(spline,i,single);
+  destroy_Bspline(single);
+}
+
+/** evaluate values only using multi_UBspline_3d_i16
+*/
+template<typename PT, typename VT>
+inline void  evaluate(multi_UBspline_3d_i16 *restrict spline, const PT& r, VT &psi)
+{
+  eval_multi_UBspline_3d_i16(spline, r[0], r[1], r[2], psi.data());
+}
+
+/** evaluate values, gradients and hessians using multi_UBspline_3d_i16
+*/
+template<typename PT, typename VT, typename GT, typename HT>
+inline void  evaluate_vgh(multi_UBspline_3d_i16 *restrict spline, const PT& r, VT &psi, GT &grad, HT& hess)
+{
+  eval_multi_UBspline_3d_i16_vgh(spline, r[0], r[1], r[2], psi.data(), grad[0].data(),hess[0].data());
+}
+}
+}
+#endif
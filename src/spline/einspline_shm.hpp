@@ -0,0 +1,197 @@
+//////////////////////////////////////////////////////////////////
+// (c) Copyright 2014-  by Jeongnim Kim and Ken Esler           //
+//////////////////////////////////////////////////////////////////
+/** @file einspline_shm.hpp
+ * @brief einspline coefficients shared by the tasks of a node
+ *
+ * The coefficients of large supercells take tens of GB. With SharedSplineTable,
+ * a single copy per node is allocated in a POSIX shared-memory segment: the
+ * first task on a node maps it read-write and fills it, the others map it read-only.
+ */
+#ifndef QMCPLUSPLUS_EINSPLINE_SHARED_TABLE_H
+#define QMCPLUSPLUS_EINSPLINE_SHARED_TABLE_H
+
+#include <Configuration.h>
+#include <Message/Communicate.h>
+#include <Message/CommOperators.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <utility>
+
+namespace qmcplusplus
+{
+/** split comm into the tasks running on the same host
+ * @param comm communicator to be split
+ * @return a new communicator whose rank 0 is the lowest rank of comm on this host
+ */
+inline Communicate* create_node_comm(Communicate* comm)
+{
+  const int MAX_LEN=128;
+  int rank=comm->rank();
+  std::vector<char> myname(MAX_LEN,'\0');
+  gethostname(&myname[0],MAX_LEN-1);
+  std::vector<char> host_list(MAX_LEN*comm->size(),'\0');
+  std::copy(myname.begin(),myname.end(),host_list.begin()+rank*MAX_LEN);
+  comm->allgather(myname,host_list,MAX_LEN);
+  //color by the lowest rank on the same host
+  std::string myhostname(&myname[0]);
+  int color=rank;
+  for(int i=0; i<rank; ++i)
+    if(myhostname == std::string(&host_list[i*MAX_LEN]))
+    {
+      color=i;
+      break;
+    }
+  return new Communicate(*comm,color,rank);
+}
+
+/** manage einspline coefficients in node-shared memory
+ *
+ * Usage by a reader
+ * - attach(spline) after the spline is created: coefs point to the shared segment
+ * - only the tasks with isFiller() write to the coefs, communicating over FillComm
+ * - fence() before any task reads the coefs
+ * - detach(spline) before the spline is destroyed
+ *
+ * The segments are unlinked as soon as all the tasks have mapped them and, like
+ * the einspline objects, live until the process ends or they are detached.
+ * The coefs of an attached spline are not allocated by malloc and must never be
+ * freed: detach unmaps the segment and sets coefs to 0, so that destroy_Bspline
+ * is safe afterwards.
+ */
+struct SharedSplineTable
+{
+  ///tasks on the same node
+  Communicate* NodeComm;
+  ///the first tasks of the nodes, one group, and the others, another group
+  Communicate* FillComm;
+
+  SharedSplineTable(Communicate* comm)
+  {
+    NodeComm=create_node_comm(comm);
+    FillComm=new Communicate(*comm,(NodeComm->rank()==0)?0:1,comm->rank());
+    app_log() << "  Node-shared einspline tables: " << NodeComm->size() << " tasks per node" << endl;
+  }
+
+  ~SharedSplineTable()
+  {
+    delete FillComm;
+    delete NodeComm;
+  }
+
+  ///return true if this task writes the shared coefficients of its node
+  inline bool isFiller() const
+  {
+    return NodeComm->rank()==0;
+  }
+
+  ///synchronize the node after the coefficients are filled
+  inline void fence()
+  {
+    NodeComm->barrier();
+  }
+
+  /** return a node-shared segment of nbytes
+   *
+   * Collective over NodeComm. The segment is writable only by the filler.
+   */
+  void* allocate(size_t nbytes)
+  {
+    static int nsegs=0;
+    int pid=getpid();
+    NodeComm->bcast(pid);
+    char name[64];
+    sprintf(name,"/qmcspline.%d.%d",pid,nsegs++);
+    void* p=MAP_FAILED;
+    int nfailed=0;
+    if(isFiller())
+    {
+      int fd=shm_open(name,O_CREAT|O_EXCL|O_RDWR,S_IRUSR|S_IWUSR);
+      if(fd>=0)
+      {
+        if(ftruncate(fd,nbytes)==0)
+          p=mmap(0,nbytes,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+        close(fd);
+      }
+      nfailed=(p==MAP_FAILED);
+    }
+    NodeComm->allreduce(nfailed);
+    if(nfailed)
+    {
+      APP_ABORT("SharedSplineTable::allocate failed to create the shared-memory segment");
+    }
+    if(!isFiller())
+    {
+      int fd=shm_open(name,O_RDONLY,0);
+      if(fd>=0)
+      {
+        p=mmap(0,nbytes,PROT_READ,MAP_SHARED,fd,0);
+        close(fd);
+      }
+      nfailed=(p==MAP_FAILED);
+    }
+    NodeComm->allreduce(nfailed);
+    if(isFiller())
+      shm_unlink(name);
+    if(nfailed)
+    {
+      APP_ABORT("SharedSplineTable::allocate failed to map the shared-memory segment");
+    }
+    return p;
+  }
+
+  ///mapped segments and their sizes in bytes, of all the tables
+  static std::vector<std::pair<void*,size_t> >& segments()
+  {
+    static std::vector<std::pair<void*,size_t> > segs;
+    return segs;
+  }
+
+  ///replace the private coefs of n elements by a node-shared segment
+  template<typename T>
+  inline void attach(T* restrict& coefs, size_t n)
+  {
+    void* p=allocate(n*sizeof(T));
+    //the private coefs are allocated by einspline with malloc
+    free(coefs);
+    coefs=static_cast<T*>(p);
+    segments().push_back(std::make_pair(p,n*sizeof(T)));
+  }
+
+  template<typename ENGT>
+  inline void attach(ENGT* spline)
+  {
+    attach(spline->coefs,spline->coefs_size);
+  }
+
+  /** unmap the node-shared coefs and set coefs to 0
+   *
+   * Does nothing if coefs is not an attached segment.
+   */
+  template<typename T>
+  static inline void detach_coefs(T* restrict& coefs)
+  {
+    std::vector<std::pair<void*,size_t> >& segs=segments();
+    for(int i=0; i<segs.size(); ++i)
+      if(segs[i].first == static_cast<void*>(coefs))
+      {
+        munmap(segs[i].first,segs[i].second);
+        segs.erase(segs.begin()+i);
+        coefs=0;
+        return;
+      }
+  }
+
+  template<typename ENGT>
+  static inline void detach(ENGT* spline)
+  {
+    detach_coefs(spline->coefs);
+  }
+};
+}
+#endif
@@ -9,6 +9,7 @@
 #define QMCPLUSPLUS_EINSPLINE_UTILITIES_H
 
 #include <Message/CommOperators.h>
+#include <mpi/mpi_datatype.h>
 #include <OhmmsData/FileUtility.h>
 #include <io/hdf_archive.h>
 #include <einspline/multi_bspline_copy.h>
@@ -42,6 +43,71 @@ namespace qmcplusplus
     chunked_bcast(comm,buffer->coefs, buffer->coefs_size);
   }
 
+  /** gather the columns of a table over comm
+   * @param comm communicator
+   * @param buffer table of npoints rows of stride columns
+   * @param npoints number of the rows, e.g. the grid points
+   * @param stride number of the columns, the column index is the fastest
+   * @param offsets the rank ip owns the columns [offsets[ip],offsets[ip+1])
+   *
+   * The ranks beyond offsets.size()-1 own no column. The owned columns of a
+   * chunk of the rows are packed, allgathered and unpacked, so the temporary
+   * buffers hold at most 1GB.
+   */
+  template<typename T>
+  inline void gather_columns(Communicate* comm, T* buffer, size_t npoints, size_t stride
+                             , const std::vector<int>& offsets)
+  {
+    if(comm->size()==1) return;
+#if defined(HAVE_MPI)
+    int np=offsets.size()-1;
+    int ncols=offsets[np]-offsets[0];
+    if(ncols==0) return;
+    int me=comm->rank();
+    int myfirst=(me<np)? offsets[me]:0;
+    int mycols=(me<np)? offsets[me+1]-offsets[me]:0;
+    size_t chunk_rows=std::max(size_t(1),size_t(1<<30)/(ncols*sizeof(T)));
+    chunk_rows=std::min(chunk_rows,npoints);
+    std::vector<T> sendbuf(std::max(size_t(1),chunk_rows*mycols)), recvbuf(chunk_rows*ncols);
+    std::vector<int> counts(comm->size(),0), displs(comm->size(),0);
+    for(size_t first=0; first<npoints; first+=chunk_rows)
+    {
+      size_t n=std::min(chunk_rows,npoints-first);
+      //the counts and displacements are in bytes
+      for(int ip=0, d=0; ip<np; ++ip)
+      {
+        counts[ip]=static_cast<int>(n*(offsets[ip+1]-offsets[ip])*sizeof(T));
+        displs[ip]=d;
+        d+=counts[ip];
+      }
+      for(size_t i=0; i<n; ++i)
+      {
+        const T* restrict src=buffer+(first+i)*stride+myfirst;
+        std::copy(src,src+mycols,&sendbuf[i*mycols]);
+      }
+      MPI_Allgatherv(&sendbuf[0],static_cast<int>(n*mycols*sizeof(T)),MPI_BYTE
+                     ,&recvbuf[0],&counts[0],&displs[0],MPI_BYTE,comm->getMPI());
+      for(int ip=0; ip<np; ++ip)
+      {
+        int nc=offsets[ip+1]-offsets[ip];
+        const T* restrict src=&recvbuf[0]+displs[ip]/sizeof(T);
+        for(size_t i=0; i<n; ++i, src+=nc)
+          std::copy(src,src+nc,buffer+(first+i)*stride+offsets[ip]);
+      }
+    }
+#endif
+  }
+
+  /** gather the splines of a multi-spline table over comm
+   * @param comm communicator
+   * @param buffer multi_UBspline whose spline index is the fastest
+   * @param offsets the rank ip owns the splines [offsets[ip],offsets[ip+1])
+   */
+  template<typename ENGT>
+  inline void gather_splines(Communicate* comm, ENGT* buffer, const std::vector<int>& offsets)
+  {
+    gather_columns(comm,buffer->coefs,buffer->coefs_size/buffer->z_stride,buffer->z_stride,offsets);
+  }
 
   /** specialization of h5data_proxy for einspline_engine
    */